@@ -0,0 +1,199 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <network-monitor/transport-network.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Contraction hierarchy over the stations of a TransportNetwork.
+ *
+ *  Stations are contracted one by one in order of importance. Contracting a station
+ *  adds shortcut arcs between its remaining neighbours wherever the station lies on the
+ *  only shortest path between them. A fastest-path query then only needs a
+ *  bidirectional search that moves upwards in the order, which settles a tiny fraction
+ *  of the stations a plain Dijkstra search settles.
+ *
+ *  A hierarchy is immutable once built and can be queried from several threads.
+ */
+class ContractionHierarchy
+{
+public:
+    using Index = std::uint32_t;
+
+    /*! \brief Weighted, directed station graph a hierarchy is built from.
+     *
+     *  Parallel edges of different routes are merged, keeping the fastest.
+     */
+    struct Graph
+    {
+        struct Arc
+        {
+            Index from{0};
+            Index to{0};
+            unsigned int travelTime{0};
+            RouteHandle route{};
+        };
+
+        std::uint64_t revision{0};
+        std::size_t stationCount{0};
+        std::vector<Arc> arcs{};
+    };
+
+    /*! \brief Copy the station graph out of a network.
+     */
+    static Graph ExtractGraph(const TransportNetwork& network);
+
+    /*! \brief Build a hierarchy, choosing the contraction order.
+     */
+    static ContractionHierarchy Build(const Graph& graph);
+
+    /*! \brief Build a hierarchy contracting the stations in a given order.
+     *
+     *  Reusing the order of a previous hierarchy of the same network skips the order
+     *  computation, which is most of the preprocessing time. This is how a hierarchy is
+     *  rebuilt after travel times change.
+     */
+    static ContractionHierarchy Build(const Graph& graph, const std::vector<Index>& order);
+
+    /*! \brief Revision of the network the hierarchy was built from.
+     */
+    std::uint64_t GetRevision() const;
+
+    /*! \brief Stations in contraction order.
+     */
+    const std::vector<Index>& GetOrder() const;
+
+    /*! \brief Number of shortcut arcs added by the contraction.
+     */
+    std::size_t GetShortcutCount() const;
+
+    /*! \brief Find the fastest path between two stations.
+     *
+     *  The result is written to path, in the same form as
+     *  TransportNetwork::GetFastestPath(). Search buffers are kept per thread.
+     *
+     *  \returns false if no path was found, in which case path is left empty.
+     */
+    bool GetFastestPath(StationHandle stationA, StationHandle stationB, Path& path) const;
+
+    /*! \brief Find the fastest path between two stations.
+     */
+    Path GetFastestPath(StationHandle stationA, StationHandle stationB) const;
+
+private:
+    static constexpr Index kNone{std::numeric_limits<Index>::max()};
+
+    struct Arc
+    {
+        Index from{0};
+        Index to{0};
+        unsigned int travelTime{0};
+
+        // Shortcuts are made of two arcs; original arcs have no children.
+        Index firstChild{kNone};
+        Index secondChild{kNone};
+        RouteHandle route{};
+    };
+
+    struct UpwardArc
+    {
+        Index station{0};
+        unsigned int travelTime{0};
+        Index arc{0};
+    };
+
+    class Builder;
+
+    ContractionHierarchy() = default;
+
+    void unpack(Index arc, Path& path) const;
+
+private:
+    std::uint64_t m_revision{0};
+    std::size_t m_stationCount{0};
+    std::size_t m_shortcutCount{0};
+    std::vector<Index> m_order{};
+    std::vector<Arc> m_arcs{};
+
+    // Arcs leaving each station towards more important stations, in CSR layout.
+    std::vector<Index> m_upOffsets{};
+    std::vector<UpwardArc> m_up{};
+
+    // Arcs entering each station from more important stations, in CSR layout.
+    std::vector<Index> m_downOffsets{};
+    std::vector<UpwardArc> m_down{};
+};
+
+/*! \brief Keeps an up-to-date ContractionHierarchy for a changing TransportNetwork.
+ *
+ *  The current hierarchy is published through an atomic shared pointer, so queries
+ *  never wait for a rebuild. Rebuilds run on a background thread, reuse the contraction
+ *  order of the current hierarchy when the set of stations is unchanged, and are
+ *  swapped in when complete. If several rebuilds are requested while one is running,
+ *  only the most recent one is carried out.
+ */
+class ContractionHierarchyIndex
+{
+public:
+    using HierarchyPtr = std::shared_ptr<const ContractionHierarchy>;
+
+    ContractionHierarchyIndex() = default;
+
+    /*! \brief Waits for the background rebuild, if any.
+     */
+    ~ContractionHierarchyIndex();
+
+    ContractionHierarchyIndex(const ContractionHierarchyIndex&) = delete;
+    ContractionHierarchyIndex(ContractionHierarchyIndex&&) = delete;
+    ContractionHierarchyIndex& operator=(const ContractionHierarchyIndex&) = delete;
+    ContractionHierarchyIndex& operator=(ContractionHierarchyIndex&&) = delete;
+
+    /*! \brief Build a hierarchy for the network and publish it before returning.
+     */
+    void Build(const TransportNetwork& network);
+
+    /*! \brief Rebuild the hierarchy on a background thread if the network changed since
+     *  the current hierarchy was built.
+     *
+     *  The network is only read before this call returns.
+     *
+     *  \returns true if a rebuild was scheduled.
+     */
+    bool Refresh(const TransportNetwork& network);
+
+    /*! \brief Block until no rebuild is pending.
+     */
+    void Wait();
+
+    /*! \brief Return the latest published hierarchy, or nullptr if none was built yet.
+     */
+    HierarchyPtr Current() const;
+
+private:
+    void rebuildLoop();
+    void publish(ContractionHierarchy&& hierarchy);
+
+private:
+    HierarchyPtr m_current{};
+
+    std::mutex m_mutex{};
+    std::condition_variable m_idle{};
+    std::optional<ContractionHierarchy::Graph> m_pending{};
+    std::uint64_t m_scheduledRevision{0};
+    bool m_running{false};
+    std::thread m_worker{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // CONTRACTION_HIERARCHY_H
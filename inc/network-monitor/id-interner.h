@@ -0,0 +1,77 @@
+#ifndef ID_INTERNER_H
+#define ID_INTERNER_H
+
+#include <network-monitor/memory-usage.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Maps string identifiers to dense, stable integer handles.
+ *
+ *  Handles are assigned in insertion order starting from zero and are never reused,
+ *  so they can be used directly as indices into arrays that grow alongside the table.
+ *
+ *  Ids are stored once, in handle order. The lookup table is a flat, open-addressing
+ *  hash table with linear probing whose slots only hold a handle and the hash of its id,
+ *  so a lookup touches one or two cache lines of slots and the id it compares against.
+ *  Lookups take a std::string_view and never allocate.
+ */
+class IdInterner
+{
+public:
+    using Handle = std::uint32_t;
+
+    static constexpr Handle kInvalidHandle{std::numeric_limits<Handle>::max()};
+
+    /*! \brief Return the handle of an id, interning it first if it is not known yet.
+     */
+    Handle Intern(std::string_view id);
+
+    /*! \brief Return the handle of an id, or kInvalidHandle if the id is not known.
+     */
+    Handle Find(std::string_view id) const;
+
+    /*! \brief Return the id a handle was assigned to.
+     *
+     *  \note The handle must be valid.
+     */
+    const std::string& Resolve(Handle handle) const;
+
+    /*! \brief Number of interned ids.
+     */
+    std::size_t Size() const;
+
+    /*! \brief Add the memory held by the interner to the hash table and string figures.
+     */
+    void AddMemoryUsage(MemoryStats& stats) const;
+
+private:
+    struct Slot
+    {
+        std::uint32_t hash{0};
+        Handle handle{kInvalidHandle};
+    };
+
+    static std::uint32_t hashOf(std::string_view id);
+
+    /*! \brief Return the slot holding an id, or the empty slot where it would go.
+     */
+    std::size_t findSlot(std::string_view id, std::uint32_t hash) const;
+
+    void grow();
+
+private:
+    // The number of slots is zero or a power of two, and at most 3/4 of them are used.
+    std::vector<Slot> m_slots{};
+    std::vector<std::string> m_ids{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // ID_INTERNER_H
@@ -0,0 +1,94 @@
+#ifndef INLINE_VECTOR_H
+#define INLINE_VECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Vector that keeps up to N elements inside the object itself.
+ *
+ *  The first N elements are stored in a fixed array, so filling it never allocates. The
+ *  element past that moves all of them to the heap, where the vector grows as usual.
+ *  Elements must be default-constructible: the inline slots always hold an element.
+ */
+template <typename T, std::size_t N> class InlineVector
+{
+public:
+    using const_iterator = const T*;
+
+    void PushBack(T value)
+    {
+        if (m_size < N)
+        {
+            m_inline[m_size++] = std::move(value);
+            return;
+        }
+
+        if (m_size == N)
+        {
+            m_heap.reserve(2 * N);
+            m_heap.assign(std::make_move_iterator(std::begin(m_inline)),
+                          std::make_move_iterator(std::end(m_inline)));
+        }
+        m_heap.push_back(std::move(value));
+        ++m_size;
+    }
+
+    void Clear()
+    {
+        m_heap.clear();
+        m_size = 0;
+    }
+
+    std::size_t Size() const
+    {
+        return m_size;
+    }
+
+    bool Empty() const
+    {
+        return m_size == 0;
+    }
+
+    /*! \brief Whether the elements moved to the heap.
+     */
+    bool IsSpilled() const
+    {
+        return m_size > N;
+    }
+
+    const T& operator[](std::size_t idx) const
+    {
+        return data()[idx];
+    }
+
+    const_iterator begin() const
+    {
+        return data();
+    }
+
+    const_iterator end() const
+    {
+        return data() + m_size;
+    }
+
+private:
+    const T* data() const
+    {
+        return IsSpilled() ? m_heap.data() : m_inline.data();
+    }
+
+private:
+    std::array<T, N> m_inline{};
+    std::vector<T> m_heap{};
+    std::size_t m_size{0};
+};
+
+} // namespace NetworkMonitor
+
+#endif // INLINE_VECTOR_H
@@ -0,0 +1,57 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Read-only view of a whole file, memory-mapped where the platform allows it.
+ *
+ *  On POSIX systems the file is mapped with mmap and pages are only read from disk when
+ *  touched. Elsewhere the file is read into memory in one go.
+ */
+class MappedFile
+{
+public:
+    /*! \brief Construct an empty view.
+     */
+    MappedFile() = default;
+
+    /*! \brief Unmap the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& moved) noexcept;
+    MappedFile& operator=(MappedFile&& moved) noexcept;
+
+    /*! \brief Map a file.
+     *
+     *  \returns false if the file cannot be opened or mapped, leaving the view empty.
+     */
+    bool Open(const std::filesystem::path& path);
+
+    /*! \brief Unmap the file, leaving the view empty.
+     */
+    void Close();
+
+    const std::byte* Data() const;
+
+    std::size_t Size() const;
+
+private:
+    const std::byte* m_data{nullptr};
+    std::size_t m_size{0};
+
+    // Only used when the file could not be mapped.
+    std::vector<std::byte> m_buffer{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,95 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Breakdown of the heap memory held by a TransportNetwork, in bytes.
+ *
+ *  Container sizes are taken from their capacity, not their size. Hash table figures are
+ *  estimates: the standard library does not expose its node layout, so each node is
+ *  counted as the stored value plus a next pointer and a cached hash.
+ */
+struct MemoryStats
+{
+    // Station nodes and their lists of routes.
+    std::size_t stations{0};
+
+    // CSR rows and edges, spare room included.
+    std::size_t edges{0};
+
+    // Route records, their stops and their cumulative travel times.
+    std::size_t routes{0};
+
+    // Line records.
+    std::size_t lines{0};
+
+    // Buckets and nodes of the id lookup tables and the per-route stop positions.
+    std::size_t hashTables{0};
+
+    // Characters of ids and names that do not fit in the short string buffer, plus the
+    // string objects of the id tables.
+    std::size_t strings{0};
+
+    // Sharded passenger counters.
+    std::size_t passengerCounters{0};
+
+    // Per-minute and per-hour passenger statistics, if enabled.
+    std::size_t passengerStatistics{0};
+
+    // Path and journey search buffers of the calling thread. They are reused by all the
+    // searches the thread runs, on any network, and grow to the largest one.
+    std::size_t searchBuffers{0};
+
+    // Control blocks of shared pointers owned by the graph. The graph holds its nodes and
+    // edges by value, so this is zero; it is reported so that tools tracking it can tell.
+    std::size_t sharedPointerControlBlocks{0};
+
+    /*! \brief Sum of all the categories.
+     */
+    std::size_t Total() const
+    {
+        return stations + edges + routes + lines + hashTables + strings + passengerCounters +
+               passengerStatistics + searchBuffers + sharedPointerControlBlocks;
+    }
+};
+
+namespace Memory
+{
+
+/*! \brief Heap bytes of a vector's buffer, excluding whatever its elements own.
+ */
+template <typename T, typename Allocator>
+std::size_t VectorBytes(const std::vector<T, Allocator>& vector)
+{
+    return vector.capacity() * sizeof(T);
+}
+
+/*! \brief Heap bytes of a string, zero if it fits in the short string buffer.
+ */
+inline std::size_t StringBytes(const std::string& string)
+{
+    static const auto kInlineCapacity{std::string{}.capacity()};
+    return string.capacity() > kInlineCapacity ? string.capacity() + 1 : 0;
+}
+
+/*! \brief Estimated heap bytes of a hash table, excluding whatever its elements own.
+ */
+template <typename Key, typename Value, typename... Rest>
+std::size_t HashTableBytes(const std::unordered_map<Key, Value, Rest...>& map)
+{
+    using Node = std::pair<const Key, Value>;
+    return map.bucket_count() * sizeof(void*) +
+           map.size() * (sizeof(Node) + sizeof(void*) + sizeof(std::size_t));
+}
+
+} // namespace Memory
+
+} // namespace NetworkMonitor
+
+#endif // MEMORY_USAGE_H
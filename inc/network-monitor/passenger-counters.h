@@ -0,0 +1,101 @@
+#ifndef PASSENGER_COUNTERS_H
+#define PASSENGER_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Per-station passenger counters that can be updated from many threads at once.
+ *
+ *  Counters are split into shards. Each thread is assigned to one shard and only ever
+ *  increments the counters of that shard, with relaxed atomic operations. Every shard is
+ *  a separate, cache-line aligned array, so threads writing to different shards never
+ *  share a cache line. Reading a counter folds the values of all shards.
+ *
+ *  Add() and Get() can be called concurrently. Resize(), copies and moves are structural
+ *  changes and must not run concurrently with any other call.
+ */
+class PassengerCounters
+{
+public:
+    /*! \brief Construct an empty set of counters.
+     *
+     *  \param shardCount Number of shards. Defaults to the number of hardware threads, up
+     *                    to kMaxDefaultShards.
+     */
+    explicit PassengerCounters(std::size_t shardCount = DefaultShardCount());
+
+    PassengerCounters(const PassengerCounters& copied);
+    PassengerCounters(PassengerCounters&& moved) noexcept;
+    PassengerCounters& operator=(const PassengerCounters& copied);
+    PassengerCounters& operator=(PassengerCounters&& moved) noexcept;
+
+    /*! \brief Upper bound of DefaultShardCount().
+     *
+     *  Every shard costs 8 bytes per counter, in every copy of the counters. A few shards
+     *  already keep concurrent writers apart; more only add memory.
+     */
+    static constexpr std::size_t kMaxDefaultShards{8};
+
+    /*! \brief Number of shards used when none is specified.
+     */
+    static std::size_t DefaultShardCount();
+
+    /*! \brief Grow or shrink the number of counters. New counters start at zero.
+     */
+    void Resize(std::size_t size);
+
+    /*! \brief Number of counters.
+     */
+    std::size_t Size() const;
+
+    /*! \brief Number of shards.
+     */
+    std::size_t ShardCount() const;
+
+    /*! \brief Add a (possibly negative) delta to a counter.
+     *
+     *  \note The counter index must be smaller than Size().
+     */
+    void Add(std::size_t counter, long long int delta);
+
+    /*! \brief Return the value of a counter, folded over all shards.
+     *
+     *  \note The counter index must be smaller than Size().
+     */
+    long long int Get(std::size_t counter) const;
+
+    /*! \brief Heap bytes held by the counters of all shards.
+     */
+    std::size_t GetMemoryUsage() const;
+
+private:
+    static constexpr std::size_t kCacheLineSize{64};
+    static constexpr std::size_t kCountersPerLine{kCacheLineSize / sizeof(long long int)};
+
+    struct alignas(kCacheLineSize) CacheLine
+    {
+        std::atomic<long long int> counters[kCountersPerLine];
+    };
+
+    std::atomic<long long int>& at(std::size_t shard, std::size_t counter) const;
+    std::size_t currentShard() const;
+    void reallocate(std::size_t capacity);
+
+private:
+    std::size_t m_shardCount{1};
+    std::size_t m_size{0};
+
+    // Capacity of each shard, in counters. Always a multiple of kCountersPerLine.
+    std::size_t m_capacity{0};
+
+    // Shard s occupies the cache lines [s * m_capacity / kCountersPerLine, (s + 1) * ...).
+    std::unique_ptr<CacheLine[]> m_lines{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // PASSENGER_COUNTERS_H
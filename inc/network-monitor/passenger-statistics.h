@@ -0,0 +1,181 @@
+#ifndef PASSENGER_STATISTICS_H
+#define PASSENGER_STATISTICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Passengers that entered and left a station over some time.
+ */
+struct PassengerFlow
+{
+    long long int in{0};
+    long long int out{0};
+};
+
+/*! \brief A window of time and the passengers that went through a station during it.
+ */
+struct PassengerWindow
+{
+    std::chrono::system_clock::time_point start{};
+    PassengerFlow flow{};
+};
+
+/*! \brief How much history PassengerStatistics keeps for every station.
+ */
+struct PassengerStatisticsOptions
+{
+    // Number of minutes kept at minute resolution. A day by default.
+    std::size_t minutes{24 * 60};
+
+    // Number of hours kept at hour resolution. A week by default.
+    std::size_t hours{7 * 24};
+};
+
+/*! \brief Per-station passenger counts, bucketed by minute and by hour.
+ *
+ *  Every station has a ring of minute buckets and a ring of hour buckets. All rings are
+ *  allocated up front, so recording an event and querying the history never allocate.
+ *  A bucket is a single 64-bit word holding the lap of the ring it was written in and
+ *  the in and out counts of its minute or hour, so recording is a relaxed compare and
+ *  swap. A bucket counts up to 2^24 - 1 passengers in each direction, and stays there
+ *  once a count reaches it.
+ *
+ *  The rings end at the most recent minute recorded for any station. Events older than
+ *  what a ring holds are not counted in that ring.
+ *
+ *  Add() and the queries can be called concurrently. Resize(), Clear(), copies and moves
+ *  are structural changes and must not run concurrently with any other call.
+ */
+class PassengerStatistics
+{
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    /*! \brief Construct statistics that keep no history.
+     */
+    PassengerStatistics() = default;
+
+    /*! \brief Construct statistics that keep the history described by the options.
+     */
+    explicit PassengerStatistics(const PassengerStatisticsOptions& options);
+
+    PassengerStatistics(const PassengerStatistics& copied);
+    PassengerStatistics(PassengerStatistics&& moved) noexcept;
+    PassengerStatistics& operator=(const PassengerStatistics& copied);
+    PassengerStatistics& operator=(PassengerStatistics&& moved) noexcept;
+
+    /*! \brief Whether any history is kept at all.
+     */
+    bool IsEnabled() const;
+
+    /*! \brief Grow or shrink the number of stations. New stations have no history.
+     */
+    void Resize(std::size_t size);
+
+    /*! \brief Number of stations.
+     */
+    std::size_t Size() const;
+
+    /*! \brief Drop the history of a station.
+     */
+    void Clear(std::size_t station);
+
+    /*! \brief Source of a station that gets no history in Remap().
+     */
+    static constexpr std::size_t kNoStation{std::numeric_limits<std::size_t>::max()};
+
+    /*! \brief Renumber the stations: station s takes the history of station sources[s].
+     *
+     *  Sources out of range, kNoStation included, leave their station with no history.
+     *  The number of stations becomes sources.size().
+     */
+    void Remap(const std::vector<std::size_t>& sources);
+
+    /*! \brief Count passengers entering and leaving a station at a point in time.
+     *
+     *  \note The station index must be smaller than Size().
+     */
+    void Add(std::size_t station, TimePoint time, std::uint32_t in, std::uint32_t out);
+
+    /*! \brief Passengers that went through a station in [from, to).
+     *
+     *  The range is rounded outward to whole minutes. If it starts before the oldest
+     *  minute kept, it is rounded outward to whole hours and read from the hour ring
+     *  instead. Parts of the range that are no longer kept are not counted.
+     */
+    PassengerFlow GetFlow(std::size_t station, TimePoint from, TimePoint to) const;
+
+    /*! \brief The window of the given length, within [from, to), in which the most
+     *  passengers entered or left a station.
+     *
+     *  Windows start on whole minutes and only cover minutes still kept. Ties go to the
+     *  earliest window.
+     *
+     *  \returns nothing if the kept part of the range is shorter than the window.
+     */
+    std::optional<PassengerWindow> GetBusiestWindow(std::size_t station,
+                                                    std::chrono::minutes length,
+                                                    TimePoint from,
+                                                    TimePoint to) const;
+
+    /*! \brief Heap bytes held by the rings of all stations.
+     */
+    std::size_t GetMemoryUsage() const;
+
+private:
+    using Bucket = std::atomic<std::uint64_t>;
+
+    // Bucket layout: lap (16 bits) | in (24 bits) | out (24 bits).
+    static constexpr unsigned int kInShift{24};
+    static constexpr unsigned int kLapShift{48};
+    static constexpr std::uint64_t kCountMask{(std::uint64_t{1} << kInShift) - 1};
+
+    // Value of m_latestMinute before any event is recorded.
+    static constexpr std::int64_t kNoMinute{std::numeric_limits<std::int64_t>::min()};
+
+    static void add(Bucket& bucket,
+                    std::int64_t period,
+                    std::size_t ringSize,
+                    std::uint32_t in,
+                    std::uint32_t out);
+    static PassengerFlow read(const Bucket& bucket, std::int64_t period, std::size_t ringSize);
+
+    /*! \brief Sum the buckets of [first, last) periods of a ring that ends at latest.
+     */
+    static PassengerFlow sum(const Bucket* ring,
+                             std::size_t ringSize,
+                             std::int64_t latest,
+                             std::int64_t first,
+                             std::int64_t last);
+
+    void reallocate(std::size_t capacity);
+
+private:
+    std::size_t m_minuteCount{0};
+    std::size_t m_hourCount{0};
+    std::size_t m_size{0};
+
+    // Number of stations the rings are allocated for.
+    std::size_t m_capacity{0};
+
+    // Station s owns buckets [s * m_minuteCount, (s + 1) * m_minuteCount) of m_minutes,
+    // and buckets [s * m_hourCount, (s + 1) * m_hourCount) of m_hours.
+    std::unique_ptr<Bucket[]> m_minutes{};
+    std::unique_ptr<Bucket[]> m_hours{};
+
+    // Most recent minute recorded, in minutes since the epoch.
+    std::atomic<std::int64_t> m_latestMinute{kNoMinute};
+};
+
+} // namespace NetworkMonitor
+
+#endif // PASSENGER_STATISTICS_H
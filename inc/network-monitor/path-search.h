@@ -0,0 +1,357 @@
+#ifndef PATH_SEARCH_H
+#define PATH_SEARCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Array-backed d-ary min-heap of (key, value) pairs.
+ *
+ *  A wider node than a binary heap halves the depth of the tree and keeps the children
+ *  of a node in the same cache line, which makes pushes cheaper. Clear() keeps the
+ *  allocated storage, so a heap reused across searches stops allocating once warm.
+ */
+template <typename Key, typename Value, std::size_t Arity = 4> class DaryHeap
+{
+public:
+    using Item = std::pair<Key, Value>;
+
+    void Clear()
+    {
+        m_items.clear();
+    }
+
+    bool Empty() const
+    {
+        return m_items.empty();
+    }
+
+    std::size_t Size() const
+    {
+        return m_items.size();
+    }
+
+    void Reserve(std::size_t size)
+    {
+        m_items.reserve(size);
+    }
+
+    /*! \brief Heap bytes held by the heap's storage.
+     */
+    std::size_t GetMemoryUsage() const
+    {
+        return m_items.capacity() * sizeof(Item);
+    }
+
+    void Push(Key key, Value value)
+    {
+        m_items.emplace_back(key, value);
+        siftUp(m_items.size() - 1);
+    }
+
+    /*! \brief Smallest item in the heap.
+     *
+     *  \note The heap must not be empty.
+     */
+    const Item& Top() const
+    {
+        return m_items.front();
+    }
+
+    /*! \brief Remove the smallest item from the heap.
+     *
+     *  \note The heap must not be empty.
+     */
+    void Pop()
+    {
+        m_items.front() = m_items.back();
+        m_items.pop_back();
+        if (!m_items.empty())
+        {
+            siftDown(0);
+        }
+    }
+
+private:
+    void siftUp(std::size_t idx)
+    {
+        const auto item{m_items[idx]};
+        while (idx > 0)
+        {
+            const auto parent{(idx - 1) / Arity};
+            if (!(item.first < m_items[parent].first))
+            {
+                break;
+            }
+
+            m_items[idx] = m_items[parent];
+            idx = parent;
+        }
+        m_items[idx] = item;
+    }
+
+    void siftDown(std::size_t idx)
+    {
+        const auto item{m_items[idx]};
+        const auto size{m_items.size()};
+        while (true)
+        {
+            const auto first{idx * Arity + 1};
+            if (first >= size)
+            {
+                break;
+            }
+
+            auto smallest{first};
+            const auto last{std::min(first + Arity, size)};
+            for (auto child{first + 1}; child < last; ++child)
+            {
+                if (m_items[child].first < m_items[smallest].first)
+                {
+                    smallest = child;
+                }
+            }
+
+            if (!(m_items[smallest].first < item.first))
+            {
+                break;
+            }
+
+            m_items[idx] = m_items[smallest];
+            idx = smallest;
+        }
+        m_items[idx] = item;
+    }
+
+private:
+    std::vector<Item> m_items{};
+};
+
+/*! \brief Reusable buffers for shortest path searches over a TransportNetwork.
+ *
+ *  Per-station search data is tagged with the number of the search that wrote it, so
+ *  starting a new search is O(1): stale entries are simply ignored. Once the buffers
+ *  have grown to the size of the network, searches no longer allocate.
+ *
+ *  A state must not be shared by concurrent searches.
+ */
+class PathSearchState
+{
+public:
+    PathSearchState() = default;
+
+    /*! \brief Heap bytes held by the buffers.
+     */
+    std::size_t GetMemoryUsage() const;
+
+private:
+    friend class TransportNetwork;
+
+    using Index = std::uint32_t;
+
+    static constexpr Index kNone{std::numeric_limits<Index>::max()};
+
+    /*! \brief Start a new search over a graph with the given number of stations.
+     */
+    void prepare(std::size_t stationCount);
+
+    bool isReached(Index station) const
+    {
+        return m_reached[station] == m_search;
+    }
+
+    bool isSettled(Index station) const
+    {
+        return m_settled[station] == m_search;
+    }
+
+    void settle(Index station)
+    {
+        m_settled[station] = m_search;
+    }
+
+    void reach(Index station, unsigned int distance, Index parentStation, Index parentEdge)
+    {
+        m_reached[station] = m_search;
+        m_distance[station] = distance;
+        m_parentStation[station] = parentStation;
+        m_parentEdge[station] = parentEdge;
+    }
+
+    /*! \brief Lift all bans, making room for a graph of the given size.
+     *
+     *  Bans are tagged like search labels, so lifting them does not touch the buffers.
+     */
+    void clearBans(std::size_t stationCount, std::size_t edgeCount);
+
+    bool isBanned(Index station) const
+    {
+        return m_bannedStation[station] == m_ban;
+    }
+
+    bool isEdgeBanned(Index edge) const
+    {
+        return m_bannedEdge[edge] == m_ban;
+    }
+
+    void ban(Index station)
+    {
+        m_bannedStation[station] = m_ban;
+    }
+
+    void banEdge(Index edge)
+    {
+        m_bannedEdge[edge] = m_ban;
+    }
+
+private:
+    std::uint32_t m_search{0};
+    std::vector<std::uint32_t> m_reached{};
+    std::vector<std::uint32_t> m_settled{};
+    std::vector<unsigned int> m_distance{};
+    std::vector<Index> m_parentStation{};
+    std::vector<Index> m_parentEdge{};
+    DaryHeap<unsigned int, Index> m_heap{};
+
+    // Stations and edges a search must not use, for alternative path searches.
+    std::uint32_t m_ban{0};
+    std::vector<std::uint32_t> m_bannedStation{};
+    std::vector<std::uint32_t> m_bannedEdge{};
+};
+
+/*! \brief Reusable buffers for journey planning over a TransportNetwork.
+ *
+ *  Holds the per-round labels of the RAPTOR-style planner. Like PathSearchState, labels
+ *  are tagged with the number of the query that wrote them, so starting a query does not
+ *  clear them. The buffers grow to the size of the largest network queried, and are
+ *  released when a query runs on a network much smaller than that.
+ *
+ *  A state must not be shared by concurrent queries.
+ */
+class JourneySearchState
+{
+public:
+    JourneySearchState() = default;
+
+    /*! \brief Heap bytes held by the buffers.
+     */
+    std::size_t GetMemoryUsage() const;
+
+private:
+    friend class TransportNetwork;
+
+    using Index = std::uint32_t;
+
+    static constexpr Index kNone{std::numeric_limits<Index>::max()};
+    static constexpr unsigned int kUnreached{std::numeric_limits<unsigned int>::max()};
+
+    /*! \brief Route leg that led to a station: the route and where it was boarded and left.
+     */
+    struct Leg
+    {
+        Index route{kNone};
+        Index boardPosition{0};
+        Index alightPosition{0};
+    };
+
+    /*! \brief Best arrival at each station using exactly the routes of one round.
+     */
+    struct RoundLabels
+    {
+        std::vector<std::uint32_t> stamp{};
+        std::vector<unsigned int> arrival{};
+        std::vector<Leg> leg{};
+    };
+
+    /*! \brief Start a new query with the given number of rounds.
+     */
+    void prepare(std::size_t stationCount, std::size_t routeCount, std::size_t roundCount);
+
+    bool isLabelled(std::size_t round, Index station) const
+    {
+        return m_rounds[round].stamp[station] == m_query;
+    }
+
+    void label(std::size_t round, Index station, unsigned int arrival, const Leg& leg)
+    {
+        auto& labels{m_rounds[round]};
+        labels.stamp[station] = m_query;
+        labels.arrival[station] = arrival;
+        labels.leg[station] = leg;
+        m_bestStamp[station] = m_query;
+        m_best[station] = arrival;
+    }
+
+    unsigned int bestArrival(Index station) const
+    {
+        return m_bestStamp[station] == m_query ? m_best[station] : kUnreached;
+    }
+
+    /*! \brief Arrival at a station using at most the routes of the given round.
+     */
+    unsigned int arrivalUpTo(std::size_t round, Index station) const
+    {
+        for (auto idx{round + 1}; idx-- > 0;)
+        {
+            if (isLabelled(idx, station))
+            {
+                return m_rounds[idx].arrival[station];
+            }
+        }
+        return kUnreached;
+    }
+
+    /*! \brief Queue a route to be scanned from the given stop, or from an earlier one if
+     *  it is already queued.
+     */
+    void queueRoute(Index route, Index position)
+    {
+        if (m_routeStamp[route] != m_query)
+        {
+            m_routeStamp[route] = m_query;
+            m_routeStart[route] = position;
+            m_queuedRoutes.push_back(route);
+        }
+        else
+        {
+            m_routeStart[route] = std::min(m_routeStart[route], position);
+        }
+    }
+
+    /*! \brief Mark a station improved in the current round, once.
+     */
+    void mark(Index station)
+    {
+        if (m_markedStamp[station] != m_query)
+        {
+            m_markedStamp[station] = m_query;
+            m_nextMarked.push_back(station);
+        }
+    }
+
+private:
+    std::uint32_t m_query{0};
+    std::vector<RoundLabels> m_rounds{};
+    std::vector<std::uint32_t> m_bestStamp{};
+    std::vector<unsigned int> m_best{};
+
+    // Routes to scan in the current round, and the first marked stop of each.
+    std::vector<std::uint32_t> m_routeStamp{};
+    std::vector<Index> m_routeStart{};
+    std::vector<Index> m_queuedRoutes{};
+
+    // Stations improved in the previous round, and in the current one.
+    std::vector<Index> m_marked{};
+    std::vector<Index> m_nextMarked{};
+    std::vector<std::uint32_t> m_markedStamp{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // PATH_SEARCH_H
@@ -0,0 +1,130 @@
+#ifndef QUIET_ROUTE_RECOMMENDER_H
+#define QUIET_ROUTE_RECOMMENDER_H
+
+#include <network-monitor/transport-network.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Settings of the quiet route recommender.
+ */
+struct QuietRouteOptions
+{
+    // Number of alternative paths considered for each origin/destination pair, fastest
+    // first. The quiet path is only found if it is among them: a pool much larger than
+    // the handful of paths a passenger would take keeps detours around a crowd in reach.
+    std::size_t candidateCount{8};
+
+    // Travel time a path is worth losing to avoid one passenger along it.
+    double crowdingWeight{1.0};
+};
+
+/*! \brief A path recommended by the QuietRouteRecommender.
+ */
+struct QuietRoute
+{
+    Path path{};
+
+    // Sum of the passenger counts of the stations along the path.
+    long long int crowding{0};
+
+    // travelTime + crowdingWeight * crowding. Lower is better.
+    double score{0};
+};
+
+/*! \brief Recommends paths that trade travel time against crowding along the way.
+ *
+ *  For each origin/destination pair, the fastest few alternative paths are computed once
+ *  and cached. Passenger events only change the crowding of the cached candidates: the
+ *  recommender keeps an index from each station to the pairs whose candidates go
+ *  through it, so only those pairs are re-ranked when the station's count changes.
+ *
+ *  Candidates are recomputed when the network layout or travel times change, which is
+ *  detected from TransportNetwork::GetRevision(). Passenger events recorded through
+ *  RecordPassengerEvents() re-rank the affected pairs as they come in.
+ *
+ *  The recommender is not thread-safe.
+ */
+class QuietRouteRecommender
+{
+public:
+    explicit QuietRouteRecommender(QuietRouteOptions options = {});
+
+    /*! \brief Recommend the quietest path between two stations.
+     *
+     *  Candidates for the pair are computed on the first call and cached.
+     *
+     *  \returns std::nullopt if either station is unknown or B cannot be reached from A.
+     */
+    std::optional<QuietRoute> Recommend(const TransportNetwork& network,
+                                        StationHandle stationA,
+                                        StationHandle stationB);
+
+    /*! \brief Return the cached recommendation for a pair, without computing anything.
+     */
+    std::optional<QuietRoute> GetCached(StationHandle stationA, StationHandle stationB) const;
+
+    /*! \brief Re-rank the cached pairs affected by passenger events at some stations.
+     *
+     *  Call after the events have been recorded in the network.
+     *
+     *  \returns the number of pairs re-ranked.
+     */
+    std::size_t OnPassengerEvents(const TransportNetwork& network,
+                                  const std::vector<StationHandle>& stations);
+
+    /*! \brief Record a batch of passenger events in the network and re-rank the cached
+     *  pairs going through the stations whose count changed.
+     *
+     *  \returns The positions in the batch of the events that could not be recorded, see
+     *            TransportNetwork::RecordPassengerEvents().
+     */
+    std::vector<std::size_t> RecordPassengerEvents(TransportNetwork& network,
+                                                   const std::vector<PassengerEvent>& events);
+
+    /*! \brief Number of origin/destination pairs currently cached.
+     */
+    std::size_t GetCachedPairCount() const;
+
+private:
+    struct Candidate
+    {
+        Path path{};
+        long long int crowding{0};
+    };
+
+    struct Entry
+    {
+        std::vector<Candidate> candidates{};
+        std::size_t best{0};
+    };
+
+    static std::uint64_t pairKey(StationHandle stationA, StationHandle stationB);
+
+    void sync(const TransportNetwork& network);
+    void rank(const TransportNetwork& network, Entry& entry) const;
+    double score(const Candidate& candidate) const;
+    QuietRoute toRecommendation(const Entry& entry) const;
+
+private:
+    QuietRouteOptions m_options{};
+    std::uint64_t m_revision{0};
+    bool m_synced{false};
+    std::unordered_map<std::uint64_t, Entry> m_entries{};
+
+    // Pairs whose candidates go through each station, indexed by station handle.
+    std::vector<std::vector<std::uint64_t>> m_pairsByStation{};
+
+    // Stations changed by the last batch recorded, reused across batches.
+    std::vector<StationHandle> m_changedStations{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // QUIET_ROUTE_RECOMMENDER_H
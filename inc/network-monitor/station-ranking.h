@@ -0,0 +1,112 @@
+#ifndef STATION_RANKING_H
+#define STATION_RANKING_H
+
+#include <network-monitor/passenger-counters.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Stations ordered by passenger count, kept up to date incrementally.
+ *
+ *  Stations whose count changes are marked with MarkChanged(), which only touches a
+ *  per-station flag and, the first time the station changes since the last query, a
+ *  lock-free list of changed stations. Top() takes that list, moves each changed station
+ *  to its new place in an ordered set, and reads the first k entries. A query costs
+ *  O(c log n + k) for c changed stations, instead of sorting all n stations.
+ *
+ *  MarkChanged() can be called from several threads at once, concurrently with Top().
+ *  Resize(), SetRanked(), copies and moves are structural changes and must not run
+ *  concurrently with any other call.
+ */
+class StationRanking
+{
+public:
+    StationRanking() = default;
+
+    StationRanking(const StationRanking& copied);
+    StationRanking(StationRanking&& moved) noexcept;
+    StationRanking& operator=(const StationRanking& copied);
+    StationRanking& operator=(StationRanking&& moved) noexcept;
+
+    /*! \brief Grow or shrink the number of stations. New stations are ranked with a
+     *  count of zero.
+     */
+    void Resize(std::size_t size);
+
+    /*! \brief Number of stations.
+     */
+    std::size_t Size() const;
+
+    /*! \brief Include a station in the ranking or leave it out.
+     *
+     *  A station put back in is ranked with its current count at the next query.
+     */
+    void SetRanked(std::size_t station, bool ranked);
+
+    /*! \brief Note that the count of a station changed.
+     *
+     *  Must be called after the count was updated, so that the next query cannot miss
+     *  the new count.
+     *
+     *  \note The station index must be smaller than Size().
+     */
+    void MarkChanged(std::size_t station);
+
+    /*! \brief The k ranked stations with the highest counts, highest first.
+     *
+     *  Ties are broken by station index. Counts are read from counters, which must be
+     *  indexed like the ranking.
+     *
+     *  \returns The station indices and the counts they were ranked with.
+     */
+    std::vector<std::pair<std::size_t, long long int>> Top(std::size_t k,
+                                                           const PassengerCounters& counters) const;
+
+private:
+    using Index = std::uint32_t;
+    using Entry = std::pair<long long int, Index>;
+
+    static constexpr Index kEndOfList{std::numeric_limits<Index>::max()};
+
+    // Highest count first, then lowest index.
+    struct EntryOrder
+    {
+        bool operator()(const Entry& lhs, const Entry& rhs) const
+        {
+            return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second;
+        }
+    };
+
+    void pushChanged(Index station) const;
+    void reallocate(std::size_t capacity);
+
+private:
+    std::size_t m_size{0};
+    std::size_t m_capacity{0};
+
+    // Changed stations form a lock-free stack, linked through m_next. A station is in the
+    // stack at most once: m_changed is set when it is pushed and cleared when it is taken.
+    std::unique_ptr<std::atomic<bool>[]> m_changed{};
+    std::unique_ptr<std::atomic<Index>[]> m_next{};
+    mutable std::atomic<Index> m_head{kEndOfList};
+
+    // Queries update the order, so it is guarded by its own lock.
+    mutable std::mutex m_mutex{};
+    mutable std::set<Entry, EntryOrder> m_order{};
+    mutable std::vector<long long int> m_rankedCounts{};
+    std::vector<bool> m_ranked{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // STATION_RANKING_H
@@ -1,6 +1,7 @@
 #ifndef NETWORK_MONITOR_STOMP_CLIENT_H
 #define NETWORK_MONITOR_STOMP_CLIENT_H
 
+#include <network-monitor/stomp-frame-batch.h>
 #include <network-monitor/stomp-frame.h>
 
 #include <boost/asio.hpp>
@@ -185,14 +186,40 @@ private:
         m_ws.Send(frame.String(), [this](auto ec) { onWsSendStomp(ec); });
     }
 
-    void onWsMessage(boost::system::error_code ec, std::string msg)
+    void onWsMessage(boost::system::error_code ec, std::string&& msg)
     {
         using Error = StompClientError;
         StompError err;
-        StompFrame frame{err, std::move(msg)};
+
+        // A message may carry several frames. They view into the message, which outlives
+        // them and is not copied until a body is handed to a user handler.
+        const StompFrameBatch frames{err, std::string_view{msg}};
+        for (const auto& frame : frames)
+        {
+            spdlog::info(
+                "StompClient: Successfully parsed received STOMP message. Message is:\n{}",
+                frame.String());
+
+            switch (frame.GetCommand())
+            {
+            case StompCommand::CONNECTED:
+                handleConnected(frame);
+                break;
+            case StompCommand::RECEIPT:
+                handleSubscriptionReceipt(frame);
+                break;
+            case StompCommand::MESSAGE:
+                handleSubscriptionMessage(frame);
+                break;
+            default:
+                break;
+            }
+        }
+
         if (err != StompError::OK)
         {
-            spdlog::warn("StompClient: Can not parse received STOMP messsage. Message is: {}", msg);
+            spdlog::warn("StompClient: Can not parse received STOMP messsage. Message is: {}",
+                         msg);
             if (m_onConnect)
             {
                 spdlog::info(
@@ -201,25 +228,6 @@ private:
                     onConnect(Error::COULD_NOT_CREATE_VALID_FRAME);
                 });
             }
-            return;
-        }
-
-        spdlog::info("StompClient: Successfully parsed received STOMP message. Message is:\n{}",
-                     frame.String());
-
-        switch (frame.GetCommand())
-        {
-        case StompCommand::CONNECTED:
-            handleConnected(std::move(frame));
-            break;
-        case StompCommand::RECEIPT:
-            handleSubscriptionReceipt(std::move(frame));
-            break;
-        case StompCommand::MESSAGE:
-            handleSubscriptionMessage(std::move(frame));
-            break;
-        default:
-            break;
         }
     }
 
@@ -275,7 +283,7 @@ private:
         }
     }
 
-    void handleConnected(StompFrame&& /* frame */)
+    void handleConnected(const StompFrameView& /* frame */)
     {
         using Error = StompClientError;
         if (m_onConnect)
@@ -285,10 +293,10 @@ private:
         }
     }
 
-    void handleSubscriptionReceipt(StompFrame&& frame)
+    void handleSubscriptionReceipt(const StompFrameView& frame)
     {
         using Error = StompClientError;
-        auto subscriptionId{frame.GetHeaderValue(StompHeaders::RECEIPT_ID)};
+        std::string subscriptionId{frame.GetHeaderValue(StompHeaders::RECEIPT_ID)};
         auto subscriptionIt{m_subscriptions.find(subscriptionId)};
         if (m_subscriptions.end() == subscriptionIt)
         {
@@ -303,15 +311,15 @@ private:
             spdlog::info("StompClient: Calling user provided handler for subscription handling");
             boost::asio::post(m_context,
                               [onSubscribe = subscription.onSubscribe,
-                               subscriptionId = std::string(subscriptionId)]() mutable {
+                               subscriptionId = std::move(subscriptionId)]() mutable {
                                   onSubscribe(Error::OK, std::move(subscriptionId));
                               });
         }
     }
 
-    void handleSubscriptionMessage(StompFrame&& frame)
+    void handleSubscriptionMessage(const StompFrameView& frame)
     {
-        auto subscriptionId{frame.GetHeaderValue(StompHeaders::RECEIPT_ID)};
+        std::string subscriptionId{frame.GetHeaderValue(StompHeaders::RECEIPT_ID)};
         auto subscriptionIt{m_subscriptions.find(subscriptionId)};
         if (m_subscriptions.end() == subscriptionIt)
         {
@@ -343,7 +351,8 @@ private:
                 "StompClient: Calling user provided handler for subscription message handling");
             boost::asio::post(
                 m_context,
-                [message = frame.GetBody(), onMessage = subscription.onMessage]() mutable {
+                [message = std::string{frame.GetBody()},
+                 onMessage = subscription.onMessage]() mutable {
                     onMessage(StompClientError::OK, std::move(message));
                 });
         }
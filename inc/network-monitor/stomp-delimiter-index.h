@@ -0,0 +1,105 @@
+#ifndef STOMP_DELIMITER_INDEX_H
+#define STOMP_DELIMITER_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Characters that give a STOMP frame its structure.
+ */
+enum class StompDelimiter
+{
+    NEWLINE,
+    COLON,
+    NUL,
+    SIZE_OF_ENUM
+};
+
+/*! \brief Ways of scanning a frame for delimiters.
+ */
+enum class StompScanKernel
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+    SIZE_OF_ENUM
+};
+
+std::string ToString(const StompScanKernel kernel);
+std::ostream& operator<<(std::ostream& ost, const StompScanKernel kernel);
+
+/*! \brief Whether the CPU running the program supports a scan kernel.
+ */
+bool IsSupported(const StompScanKernel kernel);
+
+/*! \brief The fastest scan kernel the CPU supports. Detected once, at first use.
+ */
+StompScanKernel GetBestStompScanKernel();
+
+/*! \brief Positions of every delimiter in a STOMP frame, found in a single pass.
+ *
+ *  The frame is scanned 64 bytes at a time, producing one bit mask per delimiter for each
+ *  block. Queries then walk the masks instead of the frame, which skips long bodies with a
+ *  handful of word operations. Frames of up to 512 bytes are indexed without allocating.
+ *
+ *  The index does not own the frame, and only holds positions.
+ */
+class StompDelimiterIndex
+{
+public:
+    /*! \brief Construct an empty index.
+     */
+    StompDelimiterIndex() = default;
+
+    /*! \brief Index a frame with the fastest kernel the CPU supports.
+     */
+    explicit StompDelimiterIndex(std::string_view frame);
+
+    /*! \brief Index a frame with a given kernel.
+     *
+     *  \note The kernel must be supported, see IsSupported().
+     */
+    StompDelimiterIndex(std::string_view frame, StompScanKernel kernel);
+
+    /*! \brief Number of bytes indexed.
+     */
+    std::size_t Size() const;
+
+    /*! \brief Position of the first delimiter at or after pos.
+     *
+     *  \returns std::string::npos if there is none.
+     */
+    std::size_t Find(StompDelimiter delimiter, std::size_t pos) const;
+
+    /*! \brief Number of delimiters in [from, to).
+     */
+    std::size_t Count(StompDelimiter delimiter, std::size_t from, std::size_t to) const;
+
+private:
+    static constexpr std::size_t kBlockSize{64};
+    static constexpr std::size_t kMasksPerBlock{
+        static_cast<std::size_t>(StompDelimiter::SIZE_OF_ENUM)};
+    static constexpr std::size_t kInlineBlocks{8};
+
+    const std::uint64_t* masks() const;
+
+private:
+    std::size_t m_size{0};
+    std::size_t m_blocks{0};
+
+    // Masks of block b are at [b * kMasksPerBlock, (b + 1) * kMasksPerBlock), one per
+    // delimiter. Small frames use the inline storage.
+    std::array<std::uint64_t, kInlineBlocks * kMasksPerBlock> m_inline{};
+    std::vector<std::uint64_t> m_heap{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // STOMP_DELIMITER_INDEX_H
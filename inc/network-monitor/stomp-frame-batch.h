@@ -0,0 +1,81 @@
+#ifndef STOMP_FRAME_BATCH_H
+#define STOMP_FRAME_BATCH_H
+
+#include <network-monitor/inline-vector.h>
+#include <network-monitor/stomp-frame.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Every STOMP frame in a buffer, as views over the buffer.
+ *
+ *  Brokers may coalesce several frames into one message, with end of lines between them
+ *  as heart-beats. The batch parses them all in one pass and keeps the buffer alive for
+ *  as long as the batch, or any copy of it, exists. Copies share the buffer. A batch may
+ *  also borrow a buffer its caller keeps alive, in which case nothing is shared.
+ *
+ *  Most messages hold a single frame: the first kInlineFrames are kept inline.
+ */
+class StompFrameBatch
+{
+public:
+    static constexpr std::size_t kInlineFrames{2};
+
+    using const_iterator = const StompFrameView*;
+
+    /*! \brief Construct an empty batch.
+     */
+    StompFrameBatch() = default;
+
+    /*! \brief Parse every frame in a buffer. The buffer is moved.
+     *
+     *  The result of the operation is stored in the error code. Parsing stops at the first
+     *  invalid frame, and the frames before it are kept.
+     */
+    StompFrameBatch(StompError& ec, std::string&& buffer);
+
+    /*! \brief Parse every frame in a shared buffer.
+     *
+     *  The result of the operation is stored in the error code. Parsing stops at the first
+     *  invalid frame, and the frames before it are kept.
+     */
+    StompFrameBatch(StompError& ec, std::shared_ptr<const std::string> buffer);
+
+    /*! \brief Parse every frame in a borrowed buffer. The buffer is not copied.
+     *
+     *  The buffer must outlive the batch and its copies, and GetBuffer() is null. The result
+     *  of the operation is stored in the error code. Parsing stops at the first invalid
+     *  frame, and the frames before it are kept.
+     */
+    StompFrameBatch(StompError& ec, std::string_view buffer);
+
+    std::size_t Size() const;
+
+    bool Empty() const;
+
+    const StompFrameView& operator[](std::size_t idx) const;
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+    /*! \brief The buffer the frames view into, null if it is borrowed.
+     */
+    const std::shared_ptr<const std::string>& GetBuffer() const;
+
+private:
+    void parse(StompError& ec, std::string_view buffer);
+
+private:
+    std::shared_ptr<const std::string> m_buffer{};
+    InlineVector<StompFrameView, kInlineFrames> m_frames{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // STOMP_FRAME_BATCH_H
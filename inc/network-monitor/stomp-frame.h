@@ -1,9 +1,12 @@
 #ifndef STOMP_FRAME_H
 #define STOMP_FRAME_H
 
+#include <network-monitor/inline-vector.h>
+
 #include <cstdint>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace NetworkMonitor
@@ -77,6 +80,7 @@ enum class StompError : uint8_t
     JUNK_AFTER_BODY,
     UNTERMINATED_BODY,
     EMPTY_HEADER_VALUE,
+    FRAME_TOO_LARGE,
 
     SIZE_OF_ENUM
 };
@@ -138,21 +142,21 @@ public:
      */
     StompFrame(StompError& ec, std::string&& frame);
 
-    /*! \brief The copy constructor.
+    /*! \brief The copy constructor. Header values and body view into the copy.
      */
-    StompFrame(const StompFrame& frame) = default;
+    StompFrame(const StompFrame& frame);
 
     /*! \brief The copy assingment operator.
      */
-    StompFrame& operator=(const StompFrame& frame) = default;
+    StompFrame& operator=(const StompFrame& frame);
 
     /*! \brief The move constructor.
      */
-    StompFrame(StompFrame&& frame) = default;
+    StompFrame(StompFrame&& frame) noexcept;
 
     /*! \brief The move assingment operator.
      */
-    StompFrame& operator=(StompFrame&& frame) = default;
+    StompFrame& operator=(StompFrame&& frame) noexcept;
 
     StompCommand GetCommand() const;
 
@@ -167,15 +171,88 @@ public:
     std::string String() const;
 
 private:
+    friend class StompFrameView;
+    friend class StompStreamParser;
+
+    /*! \brief Construct an already parsed frame. Header values and body view into frame.
+     */
+    StompFrame(std::string&& frame,
+               const StompCommand cmd,
+               std::vector<Header>&& headers,
+               const Body& body);
+
     void initialize(StompError& ec);
 
+    // Point header values and body, which view into a string at base, into m_frame.
+    void rebase(const char* base);
+
 private:
     std::string m_frame;
-    StompCommand m_command;
+    StompCommand m_command{StompCommand::SIZE_OF_ENUM};
     std::vector<Header> m_headers;
     Body m_body;
 };
 
+/*! \brief Non-owning view of a parsed STOMP frame.
+ *
+ *  Header values and body view into the buffer the frame was parsed from, which must
+ *  outlive the view. Headers are kept inline, so a view allocates only for frames with
+ *  more than kInlineHeaders of them.
+ */
+class StompFrameView
+{
+public:
+    static constexpr std::size_t kInlineHeaders{8};
+
+    using Headers = InlineVector<StompFrame::Header, kInlineHeaders>;
+
+    /*! \brief Default constructor. Corresponds to an empty, invalid STOMP frame.
+     */
+    StompFrameView() = default;
+
+    /*! \brief Construct a STOMP frame view from a buffer. The buffer is not copied.
+     *
+     * The result of the operation is stored in the error code. Only end of lines may follow
+     * the frame in the buffer.
+     */
+    StompFrameView(StompError& ec, std::string_view frame);
+
+    /*! \brief Construct a view from parsed frame parts, all viewing into the same buffer.
+     */
+    StompFrameView(const StompCommand cmd,
+                   Headers&& headers,
+                   const StompFrame::Body& body,
+                   std::string_view frame);
+
+    StompCommand GetCommand() const;
+
+    /*! \brief Value of the first header with the given key.
+     *
+     *  \returns An empty view if the frame has no such header.
+     */
+    std::string_view GetHeaderValue(const StompHeaders hdr) const;
+
+    const Headers& GetHeaders() const;
+
+    StompFrame::Body GetBody() const;
+
+    /*! \brief The frame as received, up to and including its NUL octet.
+     */
+    std::string_view String() const;
+
+    /*! \brief Copy the frame into a StompFrame, which owns its bytes.
+     *
+     *  Only needed to keep a frame past the lifetime of the buffer it views into.
+     */
+    StompFrame ToOwned() const;
+
+private:
+    StompCommand m_command{StompCommand::SIZE_OF_ENUM};
+    Headers m_headers{};
+    StompFrame::Body m_body{};
+    std::string_view m_frame{};
+};
+
 } // namespace NetworkMonitor
 
 #endif // STOMP_FRAME_H
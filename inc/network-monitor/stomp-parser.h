@@ -1,8 +1,12 @@
 #ifndef STOMP_PARSER_H
 #define STOMP_PARSER_H
 
+#include <network-monitor/stomp-delimiter-index.h>
 #include <network-monitor/stomp-frame.h>
-#include <unordered_map>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace NetworkMonitor
 {
@@ -12,7 +16,11 @@ namespace NetworkMonitor
 class StompParser
 {
 public:
-    /*! \brief Constructor. Stores view into STOMP frame.
+    /*! \brief Constructor. Stores view into STOMP frame and indexes its delimiters.
+     *
+     *  Command and header names are looked up in tables resolved at compile time. The
+     *  delimiter index is the only per-frame state, and only allocates for frames larger
+     *  than 512 bytes.
      */
     explicit StompParser(std::string_view frame);
 
@@ -33,6 +41,9 @@ public:
 
     /*! \brief Parses header from a STOMP frame.
      *  Stores operation result in a error code.
+     *
+     *  The empty line that ends the headers is reported as EMPTY_HEADER. A line without a
+     *  colon or with an unknown key is a BAD_HEADER, as in the other parsers.
      */
     StompFrame::Header parseHeader(StompError& ec);
 
@@ -41,13 +52,109 @@ public:
      */
     StompFrame::Body parseBody(StompError& ec, std::size_t contentLength);
 
+    /*! \brief Skips end of lines, as sent for heart-beats, up to the next frame.
+     *
+     *  \returns false if the end of the buffer was reached.
+     */
+    bool nextFrame();
+
+    /*! \brief Parses a whole frame, up to and including its NUL octet, and moves past it.
+     *  Stores operation result in a error code.
+     *
+     *  Unlike parseBody(), anything may follow the frame, so a buffer holding several
+     *  frames can be parsed one frame at a time, together with nextFrame().
+     */
+    StompFrameView parseFrame(StompError& ec);
+
 private:
-    std::unordered_map<std::string_view, StompCommand> m_commandsMap;
-    std::unordered_map<std::string_view, StompHeaders> m_headersMap;
     std::string_view m_frame;
+    StompDelimiterIndex m_delimiters;
     size_t m_pos{0};
 };
 
+/*! \brief Incremental STOMP frame parser, for input that arrives in arbitrary chunks.
+ *
+ *  Each chunk is scanned once: the parser keeps its state between calls, so bytes it has
+ *  already consumed are never looked at again. Completed frames are handed over as they
+ *  end, and a frame can be split anywhere, even inside a header line. End of lines between
+ *  frames, as sent for heart-beats, are skipped.
+ *
+ *  The bytes of the frame being parsed are copied once, into the string that the emitted
+ *  StompFrame then owns. When the frame has a content-length header, that string is sized
+ *  up front, up to a bounded amount; beyond it, the string grows as bytes arrive.
+ */
+class StompStreamParser
+{
+public:
+    using FrameHandler = std::function<void(StompFrame&&)>;
+
+    /*! \brief Default limit on the size of a frame, in bytes.
+     */
+    static constexpr std::size_t kDefaultMaxFrameSize{16 * 1024 * 1024};
+
+    /*! \brief Construct a parser waiting for the start of a frame.
+     *
+     *  Frames larger than maxFrameSize, or announcing a larger content-length, fail with
+     *  StompError::FRAME_TOO_LARGE, so that a peer cannot make the parser allocate without
+     *  bound.
+     */
+    explicit StompStreamParser(std::size_t maxFrameSize = kDefaultMaxFrameSize);
+
+    /*! \brief Parse a chunk of bytes, calling onFrame for every frame it completes.
+     *
+     *  Stores operation result in a error code. On success the whole chunk was consumed,
+     *  and NeedsMoreData() tells whether a frame is left incomplete. After an error, the
+     *  parser keeps failing with the same error until Reset().
+     *
+     *  \returns The number of frames completed by the chunk.
+     */
+    std::size_t Parse(StompError& ec, std::string_view chunk, const FrameHandler& onFrame);
+
+    /*! \brief Whether a frame has been started but not completed.
+     */
+    bool NeedsMoreData() const;
+
+    /*! \brief Drop any partial frame and error, and wait for the start of a frame.
+     */
+    void Reset();
+
+private:
+    enum class State
+    {
+        COMMAND,
+        HEADERS,
+        BODY,
+        FAILED
+    };
+
+    struct HeaderSpan
+    {
+        StompHeaders key{StompHeaders::SIZE_OF_ENUM};
+        std::size_t offset{0};
+        std::size_t size{0};
+    };
+
+    StompError parseLine();
+    StompError completeFrame(const FrameHandler& onFrame);
+
+private:
+    std::size_t m_maxFrameSize{kDefaultMaxFrameSize};
+
+    State m_state{State::COMMAND};
+    StompError m_error{StompError::OK};
+
+    // The frame parsed so far. Lines are appended up to their end of line, so the line
+    // being parsed always starts at m_lineStart and runs to the end of the string.
+    std::string m_frame{};
+    std::size_t m_lineStart{0};
+    std::size_t m_lineColon{std::string::npos};
+
+    StompCommand m_command{StompCommand::SIZE_OF_ENUM};
+    std::vector<HeaderSpan> m_headers{};
+    std::size_t m_contentLength{std::string::npos};
+    std::size_t m_bodyStart{0};
+};
+
 } // namespace NetworkMonitor
 
 #endif // STOMP_PARSER_H
@@ -0,0 +1,174 @@
+#ifndef TRANSPORT_NETWORK_PUBLISHER_H
+#define TRANSPORT_NETWORK_PUBLISHER_H
+
+#include <network-monitor/passenger-counters.h>
+#include <network-monitor/transport-network.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace NetworkMonitor
+{
+
+/*! \brief Live passenger counts, indexed by station handle, shared by snapshots.
+ *
+ *  Events are recorded into a block without any lock, so a block is never resized once
+ *  published. A network that outgrows its block gets a larger one, chained to the old
+ *  one: events still recorded through older snapshots land in the old block and keep
+ *  being counted.
+ */
+struct PassengerCountBlock
+{
+    PassengerCounters counters{};
+    std::shared_ptr<PassengerCountBlock> previous{};
+
+    /*! \brief Count of a station, folded over the chain of blocks.
+     */
+    long long int Get(std::size_t station) const;
+};
+
+/*! \brief Immutable, versioned state of a transport network.
+ *
+ *  Passenger counts are not part of the immutable state: they live in a block shared
+ *  with the other snapshots of the same publisher, and are recorded and read through
+ *  the snapshot. The counts inside the network itself, and the statistics and ranking
+ *  derived from them, are left as the writer made them.
+ */
+struct TransportNetworkSnapshot
+{
+    std::uint64_t version{0};
+    TransportNetwork network{};
+    std::shared_ptr<PassengerCountBlock> passengerCounts{};
+
+    /*! \brief Record a passenger entering or leaving a station of this snapshot.
+     *
+     *  Lock-free: the station is resolved against this snapshot and the event goes to
+     *  the shared counters with a relaxed atomic add. Safe to call from any thread.
+     *
+     *  Returns false if the station is not in this snapshot.
+     */
+    bool RecordPassengerEvent(const PassengerEvent& event) const;
+
+    bool RecordPassengerEvent(StationHandle station, PassengerEvent::Type type) const;
+
+    /*! \brief Live passenger count of a station of this snapshot.
+     *
+     *  \throws std::runtime_error if the station is not in this snapshot.
+     */
+    long long int GetPassengerCount(std::string_view station) const;
+
+    long long int GetPassengerCount(StationHandle station) const;
+};
+
+/*! \brief Publishes immutable snapshots of a TransportNetwork to concurrent readers.
+ *
+ *  Readers acquire the current snapshot with an atomic shared_ptr load and can query it
+ *  for as long as they hold on to it. Writers never modify a published snapshot: they
+ *  copy the network, apply their changes to the copy and atomically swap the new
+ *  snapshot in, so an update costs as much as a copy of the network. The passenger
+ *  counts are not copied: consecutive snapshots share them. Old snapshots are released
+ *  once their last reader is done.
+ *
+ *  Writers are serialised with each other and readers never wait for them. Acquire()
+ *  is not lock-free, though: the standard library implements atomic shared_ptr
+ *  operations with a small internal lock (a pool of mutexes in libstdc++), held only
+ *  while the pointer is copied. Passenger events avoid it: see RecordPassengerEvent().
+ */
+class TransportNetworkPublisher
+{
+public:
+    using SnapshotPtr = std::shared_ptr<const TransportNetworkSnapshot>;
+
+    /*! \brief Mutation applied by a writer to a private copy of the current network.
+     *
+     *  Returning false discards the copy and leaves the published snapshot untouched.
+     */
+    using Mutator = std::function<bool(TransportNetwork&)>;
+
+    /*! \brief Construct a publisher whose first snapshot (version 0) is the given network.
+     *
+     *  The live passenger counts start from the counts of the network.
+     */
+    explicit TransportNetworkPublisher(TransportNetwork network = TransportNetwork{});
+
+    /*! \brief The publisher is neither copyable nor movable.
+     */
+    TransportNetworkPublisher(const TransportNetworkPublisher&) = delete;
+    TransportNetworkPublisher(TransportNetworkPublisher&&) = delete;
+    TransportNetworkPublisher& operator=(const TransportNetworkPublisher&) = delete;
+    TransportNetworkPublisher& operator=(TransportNetworkPublisher&&) = delete;
+
+    /*! \brief Return the latest published snapshot. Safe to call from any thread.
+     */
+    SnapshotPtr Acquire() const;
+
+    /*! \brief Apply a mutation to a copy of the latest snapshot and publish the result.
+     *
+     *  Station handles survive the mutation, and so do their live counts. Stations must
+     *  be removed with ApplyLayoutDiff() instead, which resets their counts.
+     *
+     *  Returns true if a new snapshot was published.
+     */
+    bool Update(const Mutator& mutator);
+
+    /*! \brief Apply a layout diff to a copy of the latest snapshot and publish the result.
+     *
+     *  The live counts of the stations the diff removes or adds back start from zero;
+     *  only those stations are visited. Events recorded through an older snapshot while
+     *  the diff is being published may still land on them.
+     *
+     *  Returns true if a new snapshot was published, see TransportNetwork::ApplyLayoutDiff().
+     */
+    bool ApplyLayoutDiff(const LayoutDiff& diff);
+
+    /*! \brief Replace the published network, e.g. after loading a new layout.
+     *
+     *  A new network may number its stations differently: the live counts start over
+     *  from the counts of the new network.
+     */
+    void Publish(TransportNetwork network);
+
+    /*! \brief Record a passenger event on the latest snapshot.
+     *
+     *  Each thread keeps the snapshot it used last and only acquires the latest one after
+     *  a writer published it, so the common case takes no lock: one atomic load, then the
+     *  lock-free TransportNetworkSnapshot::RecordPassengerEvent(). The station is resolved
+     *  and counted against that single snapshot. The flip side is that a thread keeps
+     *  its last snapshot alive until its next call.
+     *
+     *  Returns false if the station is not in the latest snapshot.
+     */
+    bool RecordPassengerEvent(const PassengerEvent& event) const;
+
+    bool RecordPassengerEvent(StationHandle station, PassengerEvent::Type type) const;
+
+    /*! \brief Live passenger count of a station of the latest snapshot.
+     *
+     *  \throws std::runtime_error if the station is not in the latest snapshot.
+     */
+    long long int GetPassengerCount(std::string_view station) const;
+
+    long long int GetPassengerCount(StationHandle station) const;
+
+private:
+    const TransportNetworkSnapshot& current() const;
+    bool update(const Mutator& mutator);
+    void publish(TransportNetwork&& network, std::shared_ptr<PassengerCountBlock> counts);
+
+private:
+    std::shared_ptr<const TransportNetworkSnapshot> m_current{};
+    std::mutex m_writerMutex{};
+
+    // Identify the latest snapshot to the per-thread caches of current(). Ids are unique
+    // across publishers, so that a cache never mistakes one publisher for another.
+    const std::uint64_t m_id{};
+    std::atomic<std::uint64_t> m_version{0};
+};
+
+} // namespace NetworkMonitor
+
+#endif // TRANSPORT_NETWORK_PUBLISHER_H
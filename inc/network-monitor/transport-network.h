@@ -1,11 +1,26 @@
 #ifndef TRANSPORT_NETWORK_H
 #define TRANSPORT_NETWORK_H
 
-#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <limits>
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include <network-monitor/id-interner.h>
+#include <network-monitor/memory-usage.h>
+#include <network-monitor/passenger-counters.h>
+#include <network-monitor/passenger-statistics.h>
+#include <network-monitor/path-search.h>
+#include <network-monitor/station-ranking.h>
+
 #include <nlohmann/json.hpp>
 
 namespace Utility
@@ -61,6 +76,69 @@ struct Line
     std::vector<Route> routes;
 };
 
+/*! \brief Travel time between two adjacent stations, in both directions.
+ */
+struct TravelTime
+{
+    Id stationA{};
+    Id stationB{};
+    unsigned int travelTime{0};
+};
+
+/*! \brief Changes to a network layout, applied with TransportNetwork::ApplyLayoutDiff().
+ */
+struct LayoutDiff
+{
+    std::vector<Station> addedStations{};
+
+    // Stations whose name changes.
+    std::vector<Station> modifiedStations{};
+
+    std::vector<Id> removedStations{};
+
+    std::vector<Line> addedLines{};
+    std::vector<Id> removedLines{};
+
+    // Routes of existing lines, identified by their line id and id. Modified routes get
+    // new stops; the rest of a modified route is left as it is.
+    std::vector<Route> addedRoutes{};
+    std::vector<Route> modifiedRoutes{};
+    std::vector<std::pair<Id, Id>> removedRoutes{};
+
+    std::vector<TravelTime> travelTimes{};
+};
+
+/*! \brief Strongly typed handle to an object interned by a TransportNetwork.
+ *
+ *  Handles are stable for the lifetime of the network that issued them and are only
+ *  meaningful for that network (and for copies of it).
+ */
+template <typename Tag> struct Handle
+{
+    static constexpr std::uint32_t kInvalid{std::numeric_limits<std::uint32_t>::max()};
+
+    std::uint32_t value{kInvalid};
+
+    bool IsValid() const
+    {
+        return value != kInvalid;
+    }
+
+    bool operator==(const Handle& other) const
+    {
+        return value == other.value;
+    }
+
+    bool operator!=(const Handle& other) const
+    {
+        return value != other.value;
+    }
+};
+
+using StationHandle = Handle<struct StationTag>;
+using RouteHandle = Handle<struct RouteTag>;
+using LineHandle = Handle<struct LineTag>;
+
 struct PassengerEvent
 {
     enum class Type
@@ -71,12 +149,80 @@ struct PassengerEvent
 
     Id stationId;
     Type type;
+
+    // When the event happened. Events without a timestamp are counted in the passenger
+    // statistics at the time they are recorded.
+    std::optional<std::chrono::system_clock::time_point> timestamp{};
+};
+
+/*! \brief A station and its passenger count, as returned by GetBusiestStations().
+ */
+struct StationCount
+{
+    StationHandle station{};
+    long long int passengerCount{0};
+};
+
+/*! \brief One step of a path through the network: arrive at a station on a route.
+ *
+ *  The first step of a path is the departure station, and has no route.
+ */
+struct PathStep
+{
+    RouteHandle route{};
+    StationHandle station{};
+};
+
+/*! \brief A path through the network and its total travel time.
+ *
+ *  An empty path means that the destination cannot be reached.
+ */
+struct Path
+{
+    std::vector<PathStep> steps{};
+    unsigned int travelTime{0};
+};
+
+/*! \brief Settings of the transfer-aware journey planner.
+ */
+struct JourneyPlannerOptions
+{
+    // Time added to a journey every time it changes route.
+    unsigned int interchangePenalty{0};
+
+    // Journeys with more changes than this are not considered.
+    unsigned int maxTransfers{4};
+};
+
+/*! \brief A journey returned by the transfer-aware planner.
+ *
+ *  The travel time of the path includes the interchange penalty of every change.
+ */
+struct JourneyOption
+{
+    Path path{};
+    unsigned int transfers{0};
 };
 
 class TransportNetwork
 {
 public:
     TransportNetwork();
+
+    /*! \brief Construct an empty network whose graph allocates from a memory resource.
+     *
+     *  The station, route, line and edge arrays, and the per-station and per-route lists
+     *  they own, all allocate from resource, which must outlive the network. With a
+     *  std::pmr::monotonic_buffer_resource, loading a network is a run of pointer bumps
+     *  and the whole graph is freed at once when the resource is released. Arrays that the
+     *  network outgrows are only reclaimed with the resource. Ids, names and passenger
+     *  counters still use the default heap.
+     *
+     *  A copy of the network allocates from the default resource. Assigning to a network
+     *  keeps its own resource.
+     */
+    explicit TransportNetwork(std::pmr::memory_resource* resource);
+
     TransportNetwork(const TransportNetwork& copied);
     TransportNetwork(TransportNetwork&& moved);
     TransportNetwork& operator=(const TransportNetwork& copied);
@@ -84,71 +230,552 @@ public:
 
     bool AddStation(const Station& station);
 
+    /*! \brief Add a line and its routes.
+     *
+     *  The edges of the line are appended to the rows of their stations, so the cost
+     *  does not depend on the size of the rest of the network.
+     */
     bool AddLine(const Line& line);
 
+    /*! \brief Add several lines, as with AddLine(), bumping the revision once.
+     *
+     *  Lines are added in order, up to the first line that cannot be added. The lines
+     *  before it stay in the network.
+     *
+     *  \returns The number of lines added.
+     */
+    std::size_t AddLines(const std::vector<Line>& lines);
+
+    /*! \brief Record a passenger entering or leaving a station.
+     *
+     *  Passenger events can be recorded from several threads at once, concurrently with
+     *  GetPassengerCount(). They must not race with changes to the network layout.
+     *  Networks shared through a TransportNetworkPublisher are immutable: their events are
+     *  recorded by the publisher instead.
+     */
     bool RecordPassengerEvent(const PassengerEvent& event);
 
-    long long int GetPassengerCount(const Id& station) const;
+    /*! \brief Record a batch of passenger events.
+     *
+     *  The events are grouped by station and the net change of each station is applied
+     *  at once. Events that cannot be recorded (e.g. unknown station) are skipped without
+     *  affecting the rest of the batch. The passenger statistics, if enabled, still see
+     *  every event.
+     *
+     *  \returns The positions in the batch of the events that could not be recorded.
+     */
+    std::vector<std::size_t> RecordPassengerEvents(const std::vector<PassengerEvent>& events);
+
+    /*! \brief Record a batch of passenger events, reporting the stations they changed.
+     *
+     *  changedStations is cleared, then filled with the stations whose count changed,
+     *  each once, in handle order.
+     */
+    std::vector<std::size_t> RecordPassengerEvents(const std::vector<PassengerEvent>& events,
+                                                   std::vector<StationHandle>& changedStations);
+
+    long long int GetPassengerCount(std::string_view station) const;
 
-    std::vector<Id> GetRoutesServingStation(const Id& station) const;
+    std::vector<Id> GetRoutesServingStation(std::string_view station) const;
 
-    bool SetTravelTime(const Id& stationA, const Id& stationB, const unsigned int travelTime);
+    bool SetTravelTime(std::string_view stationA,
+                       std::string_view stationB,
+                       const unsigned int travelTime);
 
-    unsigned int GetTravelTime(const Id& stationA, const Id& stationB);
+    unsigned int GetTravelTime(std::string_view stationA, std::string_view stationB) const;
 
     unsigned int
-    GetTravelTime(const Id& line, const Id& route, const Id& stationA, const Id& stationB);
+    GetTravelTime(const Id& line, const Id& route, const Id& stationA, const Id& stationB) const;
+
+    /*! \brief Resolve a station id to its handle.
+     *
+     *  Returns an invalid handle if the station is not in the network.
+     */
+    StationHandle GetStationHandle(std::string_view station) const;
+
+    /*! \brief Whether a station handle refers to a station of the network.
+     *
+     *  Handles of removed stations are not in the network.
+     */
+    bool Contains(StationHandle station) const;
+
+    /*! \brief Number of station handles issued by the network, removed stations included.
+     *
+     *  Handles are dense: every station handle is below this number.
+     */
+    std::size_t GetStationHandleCount() const;
+
+    /*! \brief Resolve a line id to its handle.
+     *
+     *  Returns an invalid handle if the line is not in the network.
+     */
+    LineHandle GetLineHandle(std::string_view line) const;
+
+    /*! \brief Resolve a route id to its handle. Route ids are scoped by their line.
+     *
+     *  Returns an invalid handle if the route is not in the network.
+     */
+    RouteHandle GetRouteHandle(const Id& line, const Id& route) const;
+
+    /*! \brief Return the id of a station, line or route handle.
+     *
+     *  \note The handle must be valid.
+     */
+    const Id& GetId(StationHandle station) const;
+    const Id& GetId(LineHandle line) const;
+    const Id& GetId(RouteHandle route) const;
+
+    /*! \brief Handle-based overloads of the id-based API above.
+     *
+     *  They behave like their id-based counterparts, but skip the id lookup. Invalid
+     *  handles are treated like unknown ids.
+     */
+    bool RecordPassengerEvent(StationHandle station, PassengerEvent::Type type);
+
+    bool RecordPassengerEvent(StationHandle station,
+                              PassengerEvent::Type type,
+                              std::chrono::system_clock::time_point timestamp);
+
+    long long int GetPassengerCount(StationHandle station) const;
+
+    /*! \brief The k stations with the most passengers, busiest first.
+     *
+     *  Recording an event only flags its station as changed. This call re-ranks the
+     *  stations flagged since the previous call and reads the top of the ranking, so it
+     *  does not sort the whole network. It can run concurrently with recording events;
+     *  events recorded during the call may only show up at the next one. Ties are
+     *  broken by station handle.
+     */
+    std::vector<StationCount> GetBusiestStations(std::size_t k) const;
+
+    /*! \brief Start keeping per-minute and per-hour passenger counts for every station.
+     *
+     *  Statistics are off by default and cost nothing until enabled. Enabling them
+     *  allocates the history of every station up front and drops any history kept so
+     *  far. Only events recorded afterwards are counted. This is a change to the network
+     *  layout: it must not race with recording events.
+     */
+    void EnablePassengerStatistics(const PassengerStatisticsOptions& options = {});
+
+    /*! \brief Passengers that entered and left a station in [from, to).
+     *
+     *  See PassengerStatistics::GetFlow(). Returns an empty flow if statistics are not
+     *  enabled.
+     */
+    PassengerFlow GetPassengerFlow(StationHandle station,
+                                   std::chrono::system_clock::time_point from,
+                                   std::chrono::system_clock::time_point to) const;
+
+    /*! \brief The busiest window of the given length at a station within [from, to).
+     *
+     *  See PassengerStatistics::GetBusiestWindow(). Returns nothing if statistics are not
+     *  enabled.
+     */
+    std::optional<PassengerWindow>
+    GetBusiestWindow(StationHandle station,
+                     std::chrono::minutes length,
+                     std::chrono::system_clock::time_point from,
+                     std::chrono::system_clock::time_point to) const;
+
+    /*! \brief Routes stopping at a station, in the order they were added to the network.
+     *
+     *  The returned list is maintained by the network as routes are added, so this call
+     *  does not allocate. The reference is invalidated by changes to the network layout.
+     */
+    const std::pmr::vector<RouteHandle>& GetRoutesServingStation(StationHandle station) const;
+
+    bool SetTravelTime(StationHandle stationA,
+                       StationHandle stationB,
+                       const unsigned int travelTime);
+
+    unsigned int GetTravelTime(StationHandle stationA, StationHandle stationB) const;
 
-	bool FromJson(nlohmann::json&& src);	
+    unsigned int
+    GetTravelTime(RouteHandle route, StationHandle stationA, StationHandle stationB) const;
+
+    /*! \brief Find the fastest path between two stations, changing routes as needed.
+     *
+     *  Returns an empty path if either station is unknown or B cannot be reached from A.
+     */
+    Path GetFastestPath(std::string_view stationA, std::string_view stationB) const;
+
+    /*! \brief Find the fastest path between two stations, changing routes as needed.
+     *
+     *  Search buffers are kept per thread and reused across calls.
+     */
+    Path GetFastestPath(StationHandle stationA, StationHandle stationB) const;
+
+    /*! \brief Find the fastest path between two stations using caller-owned buffers.
+     *
+     *  The result is written to path, reusing its storage. Once the search state and the
+     *  path have grown to the size of the network, this call does not allocate.
+     *
+     *  \returns false if no path was found, in which case path is left empty.
+     */
+    bool GetFastestPath(StationHandle stationA,
+                        StationHandle stationB,
+                        PathSearchState& state,
+                        Path& path) const;
+
+    /*! \brief Find up to k loopless paths between two stations, fastest first.
+     *
+     *  Uses Yen's algorithm. Paths differ in the sequence of stations they visit: between
+     *  two consecutive stations, each path takes the fastest route. The first path is the
+     *  one returned by GetFastestPath(). Fewer than k paths are returned if no more exist.
+     */
+    std::vector<Path> GetAlternativePaths(std::string_view stationA,
+                                          std::string_view stationB,
+                                          std::size_t k) const;
+
+    /*! \brief Find up to k loopless paths between two stations, fastest first.
+     *
+     *  Search buffers are kept per thread and shared by all the spur searches.
+     */
+    std::vector<Path> GetAlternativePaths(StationHandle stationA,
+                                          StationHandle stationB,
+                                          std::size_t k) const;
+
+    /*! \brief Find up to k loopless paths between two stations using caller-owned
+     *  search buffers.
+     */
+    std::vector<Path> GetAlternativePaths(StationHandle stationA,
+                                          StationHandle stationB,
+                                          std::size_t k,
+                                          PathSearchState& state) const;
+
+    /*! \brief Plan journeys between two stations, trading travel time against changes.
+     *
+     *  Returns the Pareto set of journeys: each option has fewer transfers than all the
+     *  faster ones. Options are sorted by increasing number of transfers (and therefore
+     *  decreasing travel time). The set is empty if B cannot be reached from A.
+     *
+     *  The planner works in rounds, in the style of RAPTOR: round k scans, stop by stop,
+     *  every route serving a station that was improved in round k - 1.
+     */
+    std::vector<JourneyOption> GetJourneyOptions(std::string_view stationA,
+                                                 std::string_view stationB,
+                                                 const JourneyPlannerOptions& options = {}) const;
+
+    /*! \brief Plan journeys between two stations.
+     *
+     *  Search buffers are kept per thread and reused across calls.
+     */
+    std::vector<JourneyOption> GetJourneyOptions(StationHandle stationA,
+                                                 StationHandle stationB,
+                                                 const JourneyPlannerOptions& options = {}) const;
+
+    /*! \brief Plan journeys between two stations using caller-owned search buffers.
+     */
+    std::vector<JourneyOption> GetJourneyOptions(StationHandle stationA,
+                                                 StationHandle stationB,
+                                                 const JourneyPlannerOptions& options,
+                                                 JourneySearchState& state) const;
+
+    /*! \brief Revision of the network layout and travel times.
+     *
+     *  Incremented by every successful change to stations, lines or travel times, so
+     *  indices derived from the network can tell whether they are out of date. Passenger
+     *  events do not change the revision.
+     */
+    std::uint64_t GetRevision() const;
+
+    /*! \brief Break down the heap memory held by the network.
+     *
+     *  Walks every container of the network: O(stations + routes + edges). The search
+     *  buffers of the calling thread are reported too.
+     */
+    MemoryStats GetMemoryStats() const;
+
+    /*! \brief The memory resource the graph allocates from.
+     */
+    std::pmr::memory_resource* GetMemoryResource() const;
+
+    /*! \brief Populate the network from a network layout JSON document.
+     *
+     *  Stations are added first, then lines, then travel times.
+     *
+     *  \throws std::runtime_error if a station or line cannot be added.
+     */
+    bool FromJson(nlohmann::json&& src);
+
+    /*! \brief Populate the network from a network layout JSON stream.
+     *
+     *  The stream is parsed with a SAX handler that builds stations, lines and travel
+     *  times as their JSON objects end, without materialising the document. Lines and
+     *  travel times that come before the stations they refer to are held back until the
+     *  stations are known, whatever the order of the sections in the document.
+     *
+     *  \returns false if the JSON is malformed or a travel time cannot be set.
+     *  \throws std::runtime_error if a station or line cannot be added.
+     */
+    bool FromJson(std::istream& src);
+
+    /*! \brief Apply changes to the layout in place.
+     *
+     *  Passenger counts of the stations that stay are kept, and so are the handles of all
+     *  the stations, lines and routes that stay. Removed objects leave a tombstone
+     *  behind: their handles become invalid, and adding them back later revives their
+     *  old handles. Only the edges of changed routes are replaced, in the rows of the
+     *  stations they stop at: the cost of a diff does not depend on the number of edges
+     *  in the rest of the network.
+     *
+     *  New route edges between stations that already had a travel time inherit it.
+     *  Travel times in the diff are then set as with SetTravelTime().
+     *
+     *  The structural part of the diff is validated before anything changes: if any
+     *  station, line or route change is invalid (e.g. a duplicate, an unknown id, a stop
+     *  that does not exist after the diff, or a removed station still served by a route),
+     *  the network is left untouched.
+     *
+     *  \returns false if the diff was rejected or a travel time could not be set.
+     */
+    bool ApplyLayoutDiff(const LayoutDiff& diff);
+
+    /*! \brief Save the layout and travel times to a binary snapshot file.
+     *
+     *  The snapshot is a versioned, checksummed image of the network's arrays: a string
+     *  table, station, line and route records, and the edge arrays. Passenger counts are
+     *  not saved. The file is written next to its destination and renamed into place.
+     *
+     *  If a layout file is given, its size and modification time are recorded, so that
+     *  loading can tell whether the snapshot is older than the layout.
+     */
+    bool SaveSnapshot(const std::filesystem::path& snapshot,
+                      const std::filesystem::path& layout = {}) const;
+
+    /*! \brief Replace the network with the content of a binary snapshot file.
+     *
+     *  The file is memory-mapped and no text is parsed, but the network is still rebuilt
+     *  object by object: ids are interned again, every station, line and route is
+     *  recreated with its own containers (including the per-route stop positions and the
+     *  per-line route maps), and each record is bounds-checked. Only the edge offsets and
+     *  the edges are copied as blocks. Loading is therefore linear in the size of the
+     *  network, with one allocation per object.
+     *
+     *  Passenger counts and statistics are not in the snapshot. Stations that are in the
+     *  network both before and after the load keep theirs, matched by station id, and so
+     *  do the statistics options; the other stations start from zero.
+     *
+     *  \returns false, leaving the network untouched, if the snapshot is missing, was
+     *            written by another format version, fails its checksum or, when a layout
+     *            file is given, was not taken from the current version of that layout.
+     */
+    bool LoadSnapshot(const std::filesystem::path& snapshot,
+                      const std::filesystem::path& layout = {});
+
+    /*! \brief Load a network layout, going through a snapshot of it when possible.
+     *
+     *  If the snapshot is missing or stale, the layout JSON is streamed instead and a
+     *  fresh snapshot is written for the next start.
+     *
+     *  \returns false if neither the snapshot nor the layout could be loaded.
+     */
+    bool LoadLayout(const std::filesystem::path& layout, const std::filesystem::path& snapshot);
 
 private:
-    struct GraphNode;
-    struct GraphEdge;
-    struct RouteInternal;
-    struct LineInternal;
+    friend class ContractionHierarchy;
+
+    /*! \brief Dense index into one of the internal storage arrays.
+     */
+    using Index = std::uint32_t;
+
+    static constexpr Index kInvalidIndex{std::numeric_limits<Index>::max()};
+
+    // The graph containers allocate from the network's memory resource. The internal
+    // records are allocator-aware, so that the lists they own follow the array holding
+    // them: a record copied or moved into the network ends up in its resource.
+    using Allocator = std::pmr::polymorphic_allocator<std::byte>;
 
     struct GraphNode
     {
-        Id id{};
+        using allocator_type = Allocator;
+
+        explicit GraphNode(const allocator_type& allocator = {});
+        GraphNode(const Name& name, const allocator_type& allocator);
+        GraphNode(const GraphNode& other, const allocator_type& allocator);
+        GraphNode(GraphNode&& other, const allocator_type& allocator);
+        GraphNode(const GraphNode& other) = default;
+        GraphNode(GraphNode&& other) = default;
+        GraphNode& operator=(const GraphNode& other) = default;
+        GraphNode& operator=(GraphNode&& other) = default;
+
         Name name{};
-        long long int passengerCount{0};
-        std::vector<GraphEdge> edges{};
 
-        std::vector<GraphEdge>::const_iterator FindEdgeForRoute(const std::shared_ptr<RouteInternal>& route);
+        // Every route that stops at this station, listed once.
+        std::pmr::vector<RouteHandle> routes{};
+
+        // Removed stations keep their slot, so that other handles stay valid.
+        bool removed{false};
     };
 
     struct GraphEdge
     {
-        std::shared_ptr<RouteInternal> route{nullptr};
-        std::shared_ptr<GraphNode> nextStop{nullptr};
+        Index route{kInvalidIndex};
+        Index nextStop{kInvalidIndex};
         unsigned int travelTime{0};
+
+        // Position in the route's stops of the station this edge leaves from.
+        Index stopIndex{kInvalidIndex};
     };
 
     struct RouteInternal
     {
+        using allocator_type = Allocator;
+
+        explicit RouteInternal(const allocator_type& allocator = {});
+        RouteInternal(const Id& id, const Name& name, Index line, const allocator_type& allocator);
+        RouteInternal(const RouteInternal& other, const allocator_type& allocator);
+        RouteInternal(RouteInternal&& other, const allocator_type& allocator);
+        RouteInternal(const RouteInternal& other) = default;
+        RouteInternal(RouteInternal&& other) = default;
+        RouteInternal& operator=(const RouteInternal& other) = default;
+        RouteInternal& operator=(RouteInternal&& other) = default;
+
         Id id{};
         Name name{};
-        std::shared_ptr<LineInternal> line{nullptr};
-        std::vector<std::shared_ptr<GraphNode>> stops{};
+        Index line{kInvalidIndex};
+        std::pmr::vector<Index> stops{};
+
+        // cumulativeTimes[i] is the travel time from the first stop to stops[i].
+        std::pmr::vector<unsigned int> cumulativeTimes{};
+
+        // Position of the first occurrence of each station in stops.
+        std::pmr::unordered_map<Index, Index> positions{};
+
+        bool removed{false};
     };
 
     struct LineInternal
     {
-        Id id{};
+        using allocator_type = Allocator;
+
+        explicit LineInternal(const allocator_type& allocator = {});
+        LineInternal(const Name& name, const allocator_type& allocator);
+        LineInternal(const LineInternal& other, const allocator_type& allocator);
+        LineInternal(LineInternal&& other, const allocator_type& allocator);
+        LineInternal(const LineInternal& other) = default;
+        LineInternal(LineInternal&& other) = default;
+        LineInternal& operator=(const LineInternal& other) = default;
+        LineInternal& operator=(LineInternal&& other) = default;
+
         Name name{};
-        std::unordered_map<Id, std::shared_ptr<RouteInternal>> routes{};
+        std::pmr::unordered_map<Id, Index> routes{};
+        bool removed{false};
     };
 
-    std::unordered_map<Id, std::shared_ptr<GraphNode>> m_stations{};
-    std::unordered_map<Id, std::shared_ptr<LineInternal>> m_lines{};
+    /*! \brief Slice of m_edges that holds the outgoing edges of a station.
+     */
+    struct EdgeRow
+    {
+        Index first{0};
+        Index size{0};
+        Index capacity{0};
+    };
 
-    // Helper functions
-    std::shared_ptr<GraphNode> getStation(const Id& id) const;
-    std::shared_ptr<LineInternal> getLine(const Id& id) const;
+    /*! \brief Contiguous view over the outgoing edges of a station.
+     */
+    struct EdgeRange
+    {
+        const GraphEdge* first{nullptr};
+        const GraphEdge* last{nullptr};
 
-    bool addRouteToLine(const Route& route, const std::shared_ptr<LineInternal>& lineInternal);
-    std::shared_ptr<LineInternal> getLine(const Id& lineId);
-    std::shared_ptr<RouteInternal> getRoute(const Id& lineId, const Id& routeId);
+        const GraphEdge* begin() const;
+        const GraphEdge* end() const;
+    };
+
+    // Stations, routes and lines are addressed by their position in these arrays.
+    std::pmr::vector<GraphNode> m_stations{};
+    std::pmr::vector<RouteInternal> m_routes{};
+    std::pmr::vector<LineInternal> m_lines{};
+
+    // Edges are kept in compressed sparse row layout, with room to grow: the outgoing
+    // edges of station i are m_edges[m_edgeRows[i].first] up to (excluding)
+    // m_edges[m_edgeRows[i].first + m_edgeRows[i].size]. A full row moves to the end of
+    // m_edges with twice the room, leaving a gap behind. Gaps and spare room are
+    // squeezed out once they outgrow the edges themselves.
+    std::pmr::vector<EdgeRow> m_edgeRows{};
+    std::pmr::vector<GraphEdge> m_edges{};
+    std::size_t m_edgeCount{0};
+
+    // Passenger counts, indexed like m_stations. Safe to update from several threads.
+    PassengerCounters m_passengerCounts{};
+
+    // Per-minute and per-hour passenger counts, indexed like m_stations. Off by default.
+    PassengerStatistics m_passengerStatistics{};
+
+    // Stations ordered by passenger count, indexed like m_stations.
+    StationRanking m_busiestStations{};
+
+    // Station and line ids are interned: their handles are the indices above.
+    IdInterner m_stationIds{};
+    IdInterner m_lineIds{};
+
+    std::uint64_t m_revision{0};
+
+    // Helper functions
+    Index getStation(std::string_view id) const;
+    Index getStation(StationHandle station) const;
+    Index getLine(std::string_view id) const;
+    Index getRoute(const Id& lineId, const Id& routeId) const;
+
+    EdgeRange edgesOf(Index station) const;
+
+    bool recordPassengerEvent(
+        Index station,
+        PassengerEvent::Type type,
+        const std::optional<std::chrono::system_clock::time_point>& timestamp);
+
+    /*! \brief Run Dijkstra's algorithm from source until target is settled.
+     *
+     *  With useBans, the stations and edges banned in the state are skipped.
+     */
+    bool search(Index source, Index target, PathSearchState& state, bool useBans) const;
+
+    /*! \brief Queue the routes serving the stations marked in the previous round.
+     */
+    void queueMarkedRoutes(JourneySearchState& state) const;
+
+    /*! \brief Scan a queued route in a round of GetJourneyOptions(), labelling and
+     *  marking the stations it improves.
+     */
+    void scanRoute(Index route,
+                   std::size_t round,
+                   Index target,
+                   unsigned int penalty,
+                   JourneySearchState& state) const;
+
+    /*! \brief Walk the legs that reached the target in a round back to the source.
+     */
+    JourneyOption walkJourney(Index source,
+                              Index target,
+                              std::size_t round,
+                              const JourneySearchState& state) const;
+
+    bool addLine(const Line& line, std::vector<std::pair<Index, GraphEdge>>& newEdges);
+    bool addRouteToLine(const Route& route,
+                        Index line,
+                        std::vector<std::pair<Index, GraphEdge>>& newEdges);
+    void setRouteStops(Index route,
+                       const std::vector<Index>& stops,
+                       std::vector<std::pair<Index, GraphEdge>>& newEdges);
+    void clearRouteStops(Index route);
+    void inheritTravelTimes(Index route,
+                            const std::vector<bool>& changedRoutes,
+                            const std::unordered_map<std::uint64_t, unsigned int>& previousTimes);
+
+    /*! \brief Append edges to the rows of their stations.
+     */
+    void insertEdges(const std::vector<std::pair<Index, GraphEdge>>& newEdges);
+
+    /*! \brief Drop the edges of some routes from the rows of the given stations.
+     *
+     *  The other edges of those rows keep their order.
+     */
+    void removeEdges(const std::vector<Index>& stations, const std::vector<bool>& droppedRoutes);
+
+    /*! \brief Lay the rows out back to back, without gaps or spare room.
+     */
+    void compactEdges();
 };
 
 } // namespace NetworkMonitor
@@ -2,6 +2,7 @@
 #define WEBSOCKET_CLIENT_H
 
 #include <filesystem>
+#include <optional>
 #include <string>
 
 #include <boost/asio.hpp>
@@ -98,7 +99,13 @@ private:
 
     Resolver m_resolver;
     WebSocketStream m_ws;
-    boost::beast::flat_buffer m_rBuffer;
+    // Messages are read straight into m_message, which is then handed over to the message
+    // handler. The dynamic buffer wraps it and is rebuilt for every read.
+    std::string m_message{};
+    std::optional<boost::asio::dynamic_string_buffer<char,
+                                                     std::char_traits<char>,
+                                                     std::allocator<char>>>
+        m_rBuffer{};
 
     std::function<void(boost::system::error_code)> m_onConnect;
     std::function<void(boost::system::error_code, std::string&&)> m_onMessage;
@@ -272,7 +279,8 @@ void WebSocketClient<Resolver, WebSocketStream>::listenToIncomingMessage(
         return;
     }
 
-    m_ws.async_read(m_rBuffer, [this](auto ec, auto nBytes) {
+    m_rBuffer.emplace(m_message);
+    m_ws.async_read(*m_rBuffer, [this](auto ec, auto nBytes) {
         onRead(ec, nBytes);
         listenToIncomingMessage(ec);
     });
@@ -280,15 +288,16 @@ void WebSocketClient<Resolver, WebSocketStream>::listenToIncomingMessage(
 
 template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::onRead(const boost::system::error_code& ec,
-                                                        std::size_t nBytes)
+                                                        std::size_t /* nBytes */)
 {
+    // The message is taken even on error, so the next read starts from an empty string.
+    std::string message{std::move(m_message)};
+    m_message.clear();
     if (ec)
     {
         return;
     }
 
-    std::string message{boost::beast::buffers_to_string(m_rBuffer.data())};
-    m_rBuffer.consume(nBytes);
     if (m_onMessage)
     {
         m_onMessage(ec, std::move(message));
@@ -0,0 +1,602 @@
+#include <network-monitor/contraction-hierarchy.h>
+#include <network-monitor/path-search.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <utility>
+
+namespace NetworkMonitor
+{
+
+namespace
+{
+
+constexpr unsigned int kInfinity{std::numeric_limits<unsigned int>::max()};
+
+// Witness searches give up after settling this many stations. Giving up early can only
+// add shortcuts that were not strictly needed, never lose a shortest path.
+constexpr std::size_t kWitnessSettleLimit{500};
+
+/*! \brief Dijkstra bookkeeping with O(1) reset, as in PathSearchState.
+ */
+struct SearchSpace
+{
+    std::uint32_t search{0};
+    std::vector<std::uint32_t> reached{};
+    std::vector<unsigned int> distance{};
+    std::vector<std::uint32_t> parentArc{};
+    DaryHeap<unsigned int, std::uint32_t> heap{};
+
+    void Prepare(std::size_t size)
+    {
+        if (reached.size() < size)
+        {
+            reached.resize(size, 0);
+            distance.resize(size, kInfinity);
+            parentArc.resize(size, 0);
+        }
+
+        if (++search == 0)
+        {
+            std::fill(std::begin(reached), std::end(reached), 0);
+            search = 1;
+        }
+
+        heap.Clear();
+    }
+
+    unsigned int Distance(std::uint32_t node) const
+    {
+        return reached[node] == search ? distance[node] : kInfinity;
+    }
+
+    bool Relax(std::uint32_t node, unsigned int newDistance, std::uint32_t arc)
+    {
+        if (newDistance >= Distance(node))
+        {
+            return false;
+        }
+
+        reached[node] = search;
+        distance[node] = newDistance;
+        parentArc[node] = arc;
+        heap.Push(newDistance, node);
+        return true;
+    }
+};
+
+} // namespace
+
+/*! \brief Contracts the stations of a graph and collects the resulting upward arcs.
+ */
+class ContractionHierarchy::Builder
+{
+public:
+    explicit Builder(const Graph& graph)
+        : m_out(graph.stationCount)
+        , m_in(graph.stationCount)
+        , m_contractedNeighbours(graph.stationCount, 0)
+        , m_upArcs(graph.stationCount)
+        , m_downArcs(graph.stationCount)
+    {
+        m_hierarchy.m_revision = graph.revision;
+        m_hierarchy.m_stationCount = graph.stationCount;
+        for (const auto& arc : graph.arcs)
+        {
+            if (arc.from == arc.to)
+            {
+                continue;
+            }
+
+            addOrImproveArc(arc.from, arc.to, arc.travelTime, kNone, kNone, arc.route);
+        }
+    }
+
+    ContractionHierarchy Build()
+    {
+        // Lazy updates: a station's priority is recomputed when it reaches the top of the
+        // queue, and it is only contracted if it is still the least important one.
+        const auto stationCount{static_cast<Index>(m_out.size())};
+        DaryHeap<long long int, Index> queue{};
+        queue.Reserve(stationCount);
+        for (Index station{0}; station < stationCount; ++station)
+        {
+            queue.Push(priority(station), station);
+        }
+
+        while (!queue.Empty())
+        {
+            const auto station{queue.Top().second};
+            queue.Pop();
+            const auto updated{priority(station)};
+            if (!queue.Empty() && updated > queue.Top().first)
+            {
+                queue.Push(updated, station);
+                continue;
+            }
+
+            contract(station);
+        }
+
+        return finish();
+    }
+
+    ContractionHierarchy Build(const std::vector<Index>& order)
+    {
+        for (const auto station : order)
+        {
+            contract(station);
+        }
+
+        return finish();
+    }
+
+private:
+    // Edge difference, plus the number of neighbours already contracted to spread the
+    // contraction evenly over the graph.
+    long long int priority(Index station)
+    {
+        const auto shortcuts{static_cast<long long int>(shortcutsFor(station, false))};
+        const auto removed{
+            static_cast<long long int>(m_out[station].size() + m_in[station].size())};
+        return shortcuts - removed + m_contractedNeighbours[station];
+    }
+
+    void contract(Index station)
+    {
+        shortcutsFor(station, true);
+
+        for (const auto arc : m_out[station])
+        {
+            const auto& arcData{m_hierarchy.m_arcs[arc]};
+            m_upArcs[station].push_back(UpwardArc{arcData.to, arcData.travelTime, arc});
+            removeArc(m_in[arcData.to], arc);
+            ++m_contractedNeighbours[arcData.to];
+        }
+        for (const auto arc : m_in[station])
+        {
+            const auto& arcData{m_hierarchy.m_arcs[arc]};
+            m_downArcs[station].push_back(UpwardArc{arcData.from, arcData.travelTime, arc});
+            removeArc(m_out[arcData.from], arc);
+            ++m_contractedNeighbours[arcData.from];
+        }
+
+        m_out[station].clear();
+        m_in[station].clear();
+        m_hierarchy.m_order.push_back(station);
+    }
+
+    // Count (and optionally add) the shortcuts needed to contract a station.
+    std::size_t shortcutsFor(Index station, bool add)
+    {
+        std::size_t shortcuts{0};
+        for (const auto inArc : m_in[station])
+        {
+            const auto from{m_hierarchy.m_arcs[inArc].from};
+            const auto inTime{m_hierarchy.m_arcs[inArc].travelTime};
+
+            unsigned int limit{0};
+            for (const auto outArc : m_out[station])
+            {
+                if (m_hierarchy.m_arcs[outArc].to != from)
+                {
+                    limit = std::max(limit, inTime + m_hierarchy.m_arcs[outArc].travelTime);
+                }
+            }
+            witnessSearch(from, station, limit);
+
+            for (const auto outArc : m_out[station])
+            {
+                const auto to{m_hierarchy.m_arcs[outArc].to};
+                if (to == from)
+                {
+                    continue;
+                }
+
+                const auto viaTime{inTime + m_hierarchy.m_arcs[outArc].travelTime};
+                if (m_witness.Distance(to) <= viaTime)
+                {
+                    continue;
+                }
+
+                ++shortcuts;
+                if (add)
+                {
+                    addOrImproveArc(from, to, viaTime, inArc, outArc, RouteHandle{});
+                }
+            }
+        }
+
+        return shortcuts;
+    }
+
+    // Shortest distances from a station without going through the excluded one.
+    void witnessSearch(Index source, Index excluded, unsigned int limit)
+    {
+        m_witness.Prepare(m_out.size());
+        m_witness.Relax(source, 0, kNone);
+        std::size_t settled{0};
+        while (!m_witness.heap.Empty() && settled < kWitnessSettleLimit)
+        {
+            const auto [distance, station] = m_witness.heap.Top();
+            m_witness.heap.Pop();
+            if (distance > m_witness.Distance(station))
+            {
+                continue;
+            }
+            if (distance > limit)
+            {
+                break;
+            }
+
+            ++settled;
+            for (const auto arc : m_out[station])
+            {
+                const auto& arcData{m_hierarchy.m_arcs[arc]};
+                if (arcData.to != excluded)
+                {
+                    m_witness.Relax(arcData.to, distance + arcData.travelTime, arc);
+                }
+            }
+        }
+    }
+
+    void addOrImproveArc(Index from,
+                         Index to,
+                         unsigned int travelTime,
+                         Index firstChild,
+                         Index secondChild,
+                         RouteHandle route)
+    {
+        // Neither end of the arc is contracted yet, so nothing refers to an existing arc
+        // between them and it can be updated in place.
+        for (const auto arc : m_out[from])
+        {
+            auto& arcData{m_hierarchy.m_arcs[arc]};
+            if (arcData.to == to)
+            {
+                if (travelTime < arcData.travelTime)
+                {
+                    // An original arc improved by a path through a contracted station
+                    // becomes a shortcut.
+                    if (arcData.firstChild == kNone && firstChild != kNone)
+                    {
+                        ++m_hierarchy.m_shortcutCount;
+                    }
+                    arcData = Arc{from, to, travelTime, firstChild, secondChild, route};
+                }
+                return;
+            }
+        }
+
+        const auto arc{static_cast<Index>(m_hierarchy.m_arcs.size())};
+        m_hierarchy.m_arcs.push_back(Arc{from, to, travelTime, firstChild, secondChild, route});
+        m_out[from].push_back(arc);
+        m_in[to].push_back(arc);
+        if (firstChild != kNone)
+        {
+            ++m_hierarchy.m_shortcutCount;
+        }
+    }
+
+    static void removeArc(std::vector<Index>& arcs, Index arc)
+    {
+        auto it{std::find(std::begin(arcs), std::end(arcs), arc)};
+        if (it != std::end(arcs))
+        {
+            *it = arcs.back();
+            arcs.pop_back();
+        }
+    }
+
+    static void toCsr(const std::vector<std::vector<UpwardArc>>& lists,
+                      std::vector<Index>& offsets,
+                      std::vector<UpwardArc>& arcs)
+    {
+        offsets.assign(1, 0);
+        offsets.reserve(lists.size() + 1);
+        arcs.clear();
+        for (const auto& list : lists)
+        {
+            arcs.insert(std::end(arcs), std::begin(list), std::end(list));
+            offsets.push_back(static_cast<Index>(arcs.size()));
+        }
+    }
+
+    ContractionHierarchy finish()
+    {
+        toCsr(m_upArcs, m_hierarchy.m_upOffsets, m_hierarchy.m_up);
+        toCsr(m_downArcs, m_hierarchy.m_downOffsets, m_hierarchy.m_down);
+        return std::move(m_hierarchy);
+    }
+
+private:
+    ContractionHierarchy m_hierarchy{};
+
+    // Arcs between stations that are not contracted yet.
+    std::vector<std::vector<Index>> m_out;
+    std::vector<std::vector<Index>> m_in;
+
+    std::vector<long long int> m_contractedNeighbours;
+    std::vector<std::vector<UpwardArc>> m_upArcs;
+    std::vector<std::vector<UpwardArc>> m_downArcs;
+
+    SearchSpace m_witness{};
+};
+
+ContractionHierarchy::Graph ContractionHierarchy::ExtractGraph(const TransportNetwork& network)
+{
+    Graph graph{network.m_revision, network.m_stations.size(), {}};
+
+    // Keep the fastest edge between each pair of stations.
+    std::map<std::pair<Index, Index>, std::size_t> arcs{};
+    for (Index station{0}; station < graph.stationCount; ++station)
+    {
+        for (const auto& edge : network.edgesOf(station))
+        {
+            auto [it, inserted] =
+                arcs.emplace(std::make_pair(station, edge.nextStop), graph.arcs.size());
+            if (inserted)
+            {
+                graph.arcs.push_back(
+                    Graph::Arc{station, edge.nextStop, edge.travelTime, RouteHandle{edge.route}});
+            }
+            else if (edge.travelTime < graph.arcs[it->second].travelTime)
+            {
+                graph.arcs[it->second].travelTime = edge.travelTime;
+                graph.arcs[it->second].route = RouteHandle{edge.route};
+            }
+        }
+    }
+
+    return graph;
+}
+
+ContractionHierarchy ContractionHierarchy::Build(const Graph& graph)
+{
+    return Builder{graph}.Build();
+}
+
+ContractionHierarchy ContractionHierarchy::Build(const Graph& graph,
+                                                 const std::vector<Index>& order)
+{
+    return Builder{graph}.Build(order);
+}
+
+std::uint64_t ContractionHierarchy::GetRevision() const
+{
+    return m_revision;
+}
+
+const std::vector<ContractionHierarchy::Index>& ContractionHierarchy::GetOrder() const
+{
+    return m_order;
+}
+
+std::size_t ContractionHierarchy::GetShortcutCount() const
+{
+    return m_shortcutCount;
+}
+
+Path ContractionHierarchy::GetFastestPath(StationHandle stationA, StationHandle stationB) const
+{
+    Path path{};
+    GetFastestPath(stationA, stationB, path);
+    return path;
+}
+
+bool ContractionHierarchy::GetFastestPath(StationHandle stationA,
+                                          StationHandle stationB,
+                                          Path& path) const
+{
+    path.steps.clear();
+    path.travelTime = 0;
+    if (stationA.value >= m_stationCount || stationB.value >= m_stationCount)
+    {
+        return false;
+    }
+
+    // Bidirectional search: forward from A over upward arcs, backward from B over
+    // arcs entering B from above. The best meeting point gives the fastest path.
+    thread_local SearchSpace forward{};
+    thread_local SearchSpace backward{};
+    forward.Prepare(m_stationCount);
+    backward.Prepare(m_stationCount);
+    forward.Relax(stationA.value, 0, kNone);
+    backward.Relax(stationB.value, 0, kNone);
+
+    unsigned int best{kInfinity};
+    Index meeting{kNone};
+    auto step{[&best, &meeting](SearchSpace& self,
+                                const SearchSpace& other,
+                                const std::vector<Index>& offsets,
+                                const std::vector<UpwardArc>& arcs) {
+        const auto [distance, station] = self.heap.Top();
+        self.heap.Pop();
+        if (distance > self.Distance(station))
+        {
+            return;
+        }
+
+        if (const auto otherDistance{other.Distance(station)}; otherDistance != kInfinity)
+        {
+            if (distance + otherDistance < best)
+            {
+                best = distance + otherDistance;
+                meeting = station;
+            }
+        }
+
+        for (auto idx{offsets[station]}; idx < offsets[station + 1]; ++idx)
+        {
+            const auto& arc{arcs[idx]};
+            self.Relax(arc.station, distance + arc.travelTime, arc.arc);
+        }
+    }};
+
+    while (true)
+    {
+        const auto forwardMin{forward.heap.Empty() ? kInfinity : forward.heap.Top().first};
+        const auto backwardMin{backward.heap.Empty() ? kInfinity : backward.heap.Top().first};
+        if (std::min(forwardMin, backwardMin) >= best)
+        {
+            break;
+        }
+
+        if (forwardMin <= backwardMin)
+        {
+            step(forward, backward, m_upOffsets, m_up);
+        }
+        else
+        {
+            step(backward, forward, m_downOffsets, m_down);
+        }
+    }
+
+    if (meeting == kNone)
+    {
+        return false;
+    }
+
+    // Collect the hierarchy arcs from A to the meeting point, and from there to B.
+    thread_local std::vector<Index> arcs{};
+    arcs.clear();
+    for (auto station{meeting}; station != stationA.value;)
+    {
+        const auto arc{forward.parentArc[station]};
+        arcs.push_back(arc);
+        station = m_arcs[arc].from;
+    }
+    std::reverse(std::begin(arcs), std::end(arcs));
+    for (auto station{meeting}; station != stationB.value;)
+    {
+        const auto arc{backward.parentArc[station]};
+        arcs.push_back(arc);
+        station = m_arcs[arc].to;
+    }
+
+    path.steps.push_back(PathStep{RouteHandle{}, stationA});
+    for (const auto arc : arcs)
+    {
+        unpack(arc, path);
+    }
+    path.travelTime = best;
+
+    return true;
+}
+
+void ContractionHierarchy::unpack(Index arc, Path& path) const
+{
+    // Depth-first expansion of the shortcut tree, appending original arcs in order.
+    thread_local std::vector<Index> stack{};
+    stack.clear();
+    stack.push_back(arc);
+    while (!stack.empty())
+    {
+        const auto& current{m_arcs[stack.back()]};
+        stack.pop_back();
+        if (current.firstChild == kNone)
+        {
+            path.steps.push_back(PathStep{current.route, StationHandle{current.to}});
+            continue;
+        }
+
+        stack.push_back(current.secondChild);
+        stack.push_back(current.firstChild);
+    }
+}
+
+ContractionHierarchyIndex::~ContractionHierarchyIndex()
+{
+    Wait();
+    if (m_worker.joinable())
+    {
+        m_worker.join();
+    }
+}
+
+void ContractionHierarchyIndex::Build(const TransportNetwork& network)
+{
+    publish(ContractionHierarchy::Build(ContractionHierarchy::ExtractGraph(network)));
+}
+
+bool ContractionHierarchyIndex::Refresh(const TransportNetwork& network)
+{
+    const auto revision{network.GetRevision()};
+    if (const auto current{Current()}; current != nullptr && current->GetRevision() == revision)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    if ((m_running || m_pending) && m_scheduledRevision == revision)
+    {
+        return false;
+    }
+
+    m_pending = ContractionHierarchy::ExtractGraph(network);
+    m_scheduledRevision = revision;
+    if (!m_running)
+    {
+        m_running = true;
+        if (m_worker.joinable())
+        {
+            m_worker.join();
+        }
+        m_worker = std::thread{[this]() { rebuildLoop(); }};
+    }
+
+    return true;
+}
+
+void ContractionHierarchyIndex::Wait()
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_idle.wait(lock, [this]() { return !m_running; });
+}
+
+ContractionHierarchyIndex::HierarchyPtr ContractionHierarchyIndex::Current() const
+{
+    return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+}
+
+void ContractionHierarchyIndex::rebuildLoop()
+{
+    while (true)
+    {
+        std::optional<ContractionHierarchy::Graph> graph{};
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (!m_pending)
+            {
+                m_running = false;
+                m_idle.notify_all();
+                return;
+            }
+            graph = std::move(m_pending);
+            m_pending.reset();
+        }
+
+        // Travel time changes keep the stations: the previous order stays a good one.
+        const auto current{Current()};
+        if (current != nullptr && current->GetOrder().size() == graph->stationCount)
+        {
+            publish(ContractionHierarchy::Build(*graph, current->GetOrder()));
+        }
+        else
+        {
+            publish(ContractionHierarchy::Build(*graph));
+        }
+    }
+}
+
+void ContractionHierarchyIndex::publish(ContractionHierarchy&& hierarchy)
+{
+    std::atomic_store_explicit(
+        &m_current,
+        HierarchyPtr{std::make_shared<const ContractionHierarchy>(std::move(hierarchy))},
+        std::memory_order_release);
+}
+
+} // namespace NetworkMonitor
@@ -0,0 +1,98 @@
+#include <network-monitor/id-interner.h>
+
+#include <functional>
+
+namespace NetworkMonitor
+{
+
+IdInterner::Handle IdInterner::Intern(std::string_view id)
+{
+    // Keep the load factor at or below 3/4, so that probe sequences stay short.
+    if ((m_ids.size() + 1) * 4 > m_slots.size() * 3)
+    {
+        grow();
+    }
+
+    const auto hash{hashOf(id)};
+    auto& slot{m_slots[findSlot(id, hash)]};
+    if (slot.handle == kInvalidHandle)
+    {
+        slot = Slot{hash, static_cast<Handle>(m_ids.size())};
+        m_ids.emplace_back(id);
+    }
+
+    return slot.handle;
+}
+
+IdInterner::Handle IdInterner::Find(std::string_view id) const
+{
+    if (m_slots.empty())
+    {
+        return kInvalidHandle;
+    }
+
+    return m_slots[findSlot(id, hashOf(id))].handle;
+}
+
+const std::string& IdInterner::Resolve(Handle handle) const
+{
+    return m_ids[handle];
+}
+
+std::size_t IdInterner::Size() const
+{
+    return m_ids.size();
+}
+
+void IdInterner::AddMemoryUsage(MemoryStats& stats) const
+{
+    stats.hashTables += Memory::VectorBytes(m_slots);
+    stats.strings += Memory::VectorBytes(m_ids);
+    for (const auto& id : m_ids)
+    {
+        stats.strings += Memory::StringBytes(id);
+    }
+}
+
+std::uint32_t IdInterner::hashOf(std::string_view id)
+{
+    return static_cast<std::uint32_t>(std::hash<std::string_view>{}(id));
+}
+
+std::size_t IdInterner::findSlot(std::string_view id, std::uint32_t hash) const
+{
+    // The table is never full, so the probe always ends on an empty slot.
+    const auto mask{m_slots.size() - 1};
+    for (auto idx{hash & mask};; idx = (idx + 1) & mask)
+    {
+        const auto& slot{m_slots[idx]};
+        if (slot.handle == kInvalidHandle ||
+            (slot.hash == hash && m_ids[slot.handle] == id))
+        {
+            return idx;
+        }
+    }
+}
+
+void IdInterner::grow()
+{
+    // Slots keep the hash of their id, so rehashing does not touch the ids.
+    std::vector<Slot> slots(m_slots.empty() ? 16 : 2 * m_slots.size());
+    const auto mask{slots.size() - 1};
+    for (const auto& slot : m_slots)
+    {
+        if (slot.handle == kInvalidHandle)
+        {
+            continue;
+        }
+        auto idx{slot.hash & mask};
+        while (slots[idx].handle != kInvalidHandle)
+        {
+            idx = (idx + 1) & mask;
+        }
+        slots[idx] = slot;
+    }
+    m_slots = std::move(slots);
+}
+
+} // namespace NetworkMonitor
@@ -0,0 +1,120 @@
+#include <network-monitor/mapped-file.h>
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NETWORK_MONITOR_HAS_MMAP 1
+#endif
+
+namespace NetworkMonitor
+{
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& moved) noexcept
+    : m_data{std::exchange(moved.m_data, nullptr)},
+      m_size{std::exchange(moved.m_size, 0)},
+      m_buffer{std::move(moved.m_buffer)}
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& moved) noexcept
+{
+    if (this != &moved)
+    {
+        Close();
+        m_data = std::exchange(moved.m_data, nullptr);
+        m_size = std::exchange(moved.m_size, 0);
+        m_buffer = std::move(moved.m_buffer);
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+#ifdef NETWORK_MONITOR_HAS_MMAP
+    const auto fd{::open(path.c_str(), O_RDONLY)};
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status
+    {
+    };
+    if (::fstat(fd, &status) != 0 || status.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    const auto size{static_cast<std::size_t>(status.st_size)};
+    auto* data{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_data = static_cast<const std::byte*>(data);
+    m_size = size;
+    return true;
+#else
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if (!file)
+    {
+        return false;
+    }
+
+    m_buffer.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    if (m_buffer.empty() ||
+        !file.read(reinterpret_cast<char*>(m_buffer.data()),
+                   static_cast<std::streamsize>(m_buffer.size())))
+    {
+        m_buffer.clear();
+        return false;
+    }
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::Close()
+{
+#ifdef NETWORK_MONITOR_HAS_MMAP
+    if (m_data != nullptr && m_buffer.empty())
+    {
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_buffer.clear();
+}
+
+const std::byte* MappedFile::Data() const
+{
+    return m_data;
+}
+
+std::size_t MappedFile::Size() const
+{
+    return m_size;
+}
+
+} // namespace NetworkMonitor
@@ -0,0 +1,67 @@
+#include <network-monitor/transport-network.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::MemoryStats;
+using NetworkMonitor::TransportNetwork;
+
+// Load a network layout and print how much memory each part of the network takes.
+//
+// Usage: network-memory-stats [network-layout.json]
+int main(int argc, char* argv[])
+{
+    const std::string layout{argc > 1 ? argv[1] : TESTS_NETWORK_LAYOUT_JSON};
+    std::ifstream file{layout};
+    if (!file)
+    {
+        std::cerr << "Could not open " << layout << "\n";
+        return 1;
+    }
+
+    TransportNetwork network{};
+    try
+    {
+        if (!network.FromJson(file))
+        {
+            std::cerr << "Could not load " << layout << "\n";
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Could not load " << layout << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    const auto stats{network.GetMemoryStats()};
+    const std::vector<std::pair<const char*, std::size_t>> rows{
+        {"stations", stats.stations},
+        {"edges", stats.edges},
+        {"routes", stats.routes},
+        {"lines", stats.lines},
+        {"hash tables", stats.hashTables},
+        {"strings", stats.strings},
+        {"passenger counters", stats.passengerCounters},
+        {"passenger statistics", stats.passengerStatistics},
+        {"search buffers", stats.searchBuffers},
+        {"shared_ptr control blocks", stats.sharedPointerControlBlocks},
+    };
+
+    const auto total{stats.Total()};
+    std::cout << layout << "\n";
+    for (const auto& [name, bytes] : rows)
+    {
+        std::cout << std::left << std::setw(28) << name << std::right << std::setw(12) << bytes
+                  << " B" << std::setw(8) << std::fixed << std::setprecision(1)
+                  << (total > 0 ? 100.0 * bytes / total : 0.0) << " %\n";
+    }
+    std::cout << std::left << std::setw(28) << "total" << std::right << std::setw(12) << total
+              << " B\n";
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <network-monitor/passenger-counters.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace NetworkMonitor
+{
+
+PassengerCounters::PassengerCounters(std::size_t shardCount)
+    : m_shardCount{std::max<std::size_t>(shardCount, 1)}
+{
+}
+
+PassengerCounters::PassengerCounters(const PassengerCounters& copied)
+    : m_shardCount{copied.m_shardCount}
+{
+    *this = copied;
+}
+
+PassengerCounters::PassengerCounters(PassengerCounters&& moved) noexcept
+{
+    *this = std::move(moved);
+}
+
+PassengerCounters& PassengerCounters::operator=(const PassengerCounters& copied)
+{
+    if (this == &copied)
+    {
+        return *this;
+    }
+
+    m_shardCount = copied.m_shardCount;
+    m_size = 0;
+    m_capacity = 0;
+    m_lines.reset();
+    reallocate(copied.m_capacity);
+    m_size = copied.m_size;
+    for (std::size_t shard{0}; shard < m_shardCount; ++shard)
+    {
+        for (std::size_t counter{0}; counter < m_size; ++counter)
+        {
+            at(shard, counter).store(copied.at(shard, counter).load(std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
+        }
+    }
+
+    return *this;
+}
+
+PassengerCounters& PassengerCounters::operator=(PassengerCounters&& moved) noexcept
+{
+    // The moved-from counters are left empty, but usable.
+    m_shardCount = moved.m_shardCount;
+    m_size = std::exchange(moved.m_size, 0);
+    m_capacity = std::exchange(moved.m_capacity, 0);
+    m_lines = std::move(moved.m_lines);
+    return *this;
+}
+
+std::size_t PassengerCounters::DefaultShardCount()
+{
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, kMaxDefaultShards);
+}
+
+void PassengerCounters::Resize(std::size_t size)
+{
+    if (size > m_capacity)
+    {
+        reallocate(std::max(size, 2 * m_capacity));
+    }
+
+    // Counters dropped by a shrink must read as zero if they are grown back.
+    for (std::size_t shard{0}; shard < m_shardCount; ++shard)
+    {
+        for (std::size_t counter{size}; counter < m_size; ++counter)
+        {
+            at(shard, counter).store(0, std::memory_order_relaxed);
+        }
+    }
+
+    m_size = size;
+}
+
+std::size_t PassengerCounters::Size() const
+{
+    return m_size;
+}
+
+std::size_t PassengerCounters::ShardCount() const
+{
+    return m_shardCount;
+}
+
+void PassengerCounters::Add(std::size_t counter, long long int delta)
+{
+    at(currentShard(), counter).fetch_add(delta, std::memory_order_relaxed);
+}
+
+long long int PassengerCounters::Get(std::size_t counter) const
+{
+    long long int total{0};
+    for (std::size_t shard{0}; shard < m_shardCount; ++shard)
+    {
+        total += at(shard, counter).load(std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+std::size_t PassengerCounters::GetMemoryUsage() const
+{
+    return m_shardCount * m_capacity / kCountersPerLine * sizeof(CacheLine);
+}
+
+std::atomic<long long int>& PassengerCounters::at(std::size_t shard, std::size_t counter) const
+{
+    const auto index{shard * m_capacity + counter};
+    return m_lines[index / kCountersPerLine].counters[index % kCountersPerLine];
+}
+
+std::size_t PassengerCounters::currentShard() const
+{
+    // Threads are assigned to shards round-robin the first time they record an event.
+    static std::atomic<std::size_t> nextThread{0};
+    thread_local const std::size_t threadIndex{nextThread.fetch_add(1)};
+    return threadIndex % m_shardCount;
+}
+
+void PassengerCounters::reallocate(std::size_t capacity)
+{
+    capacity = (capacity + kCountersPerLine - 1) / kCountersPerLine * kCountersPerLine;
+    const auto lineCount{m_shardCount * capacity / kCountersPerLine};
+    std::unique_ptr<CacheLine[]> lines{new CacheLine[lineCount]};
+    for (std::size_t line{0}; line < lineCount; ++line)
+    {
+        for (auto& counter : lines[line].counters)
+        {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    for (std::size_t shard{0}; shard < m_shardCount; ++shard)
+    {
+        for (std::size_t counter{0}; counter < m_size; ++counter)
+        {
+            const auto index{shard * capacity + counter};
+            lines[index / kCountersPerLine].counters[index % kCountersPerLine].store(
+                at(shard, counter).load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    m_lines = std::move(lines);
+    m_capacity = capacity;
+}
+
+} // namespace NetworkMonitor
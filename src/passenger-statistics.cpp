@@ -0,0 +1,416 @@
+#include <network-monitor/passenger-statistics.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace NetworkMonitor
+{
+
+namespace
+{
+
+constexpr std::int64_t kMinutesPerHour{60};
+
+// Integer division and remainder rounding towards negative infinity, so that times
+// before the epoch still land in the right bucket.
+std::int64_t FloorDiv(std::int64_t value, std::int64_t divisor)
+{
+    const auto quotient{value / divisor};
+    return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+std::int64_t FloorMod(std::int64_t value, std::int64_t divisor)
+{
+    return value - FloorDiv(value, divisor) * divisor;
+}
+
+std::int64_t FloorMinute(PassengerStatistics::TimePoint time)
+{
+    return std::chrono::floor<std::chrono::minutes>(time.time_since_epoch()).count();
+}
+
+std::int64_t CeilMinute(PassengerStatistics::TimePoint time)
+{
+    return std::chrono::ceil<std::chrono::minutes>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+PassengerStatistics::PassengerStatistics(const PassengerStatisticsOptions& options)
+    : m_minuteCount{options.minutes}, m_hourCount{options.hours}
+{
+}
+
+PassengerStatistics::PassengerStatistics(const PassengerStatistics& copied)
+{
+    *this = copied;
+}
+
+PassengerStatistics::PassengerStatistics(PassengerStatistics&& moved) noexcept
+{
+    *this = std::move(moved);
+}
+
+PassengerStatistics& PassengerStatistics::operator=(const PassengerStatistics& copied)
+{
+    if (this == &copied)
+    {
+        return *this;
+    }
+
+    m_minuteCount = copied.m_minuteCount;
+    m_hourCount = copied.m_hourCount;
+    m_size = 0;
+    m_capacity = 0;
+    m_minutes.reset();
+    m_hours.reset();
+    reallocate(copied.m_size);
+    m_size = copied.m_size;
+    for (std::size_t bucket{0}; bucket < m_size * m_minuteCount; ++bucket)
+    {
+        m_minutes[bucket].store(copied.m_minutes[bucket].load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+    }
+    for (std::size_t bucket{0}; bucket < m_size * m_hourCount; ++bucket)
+    {
+        m_hours[bucket].store(copied.m_hours[bucket].load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+    }
+    m_latestMinute.store(copied.m_latestMinute.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+
+    return *this;
+}
+
+PassengerStatistics& PassengerStatistics::operator=(PassengerStatistics&& moved) noexcept
+{
+    // The moved-from statistics are left empty, but usable.
+    m_minuteCount = moved.m_minuteCount;
+    m_hourCount = moved.m_hourCount;
+    m_size = std::exchange(moved.m_size, 0);
+    m_capacity = std::exchange(moved.m_capacity, 0);
+    m_minutes = std::move(moved.m_minutes);
+    m_hours = std::move(moved.m_hours);
+    m_latestMinute.store(moved.m_latestMinute.exchange(kNoMinute, std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    return *this;
+}
+
+bool PassengerStatistics::IsEnabled() const
+{
+    return m_minuteCount > 0 || m_hourCount > 0;
+}
+
+void PassengerStatistics::Resize(std::size_t size)
+{
+    if (!IsEnabled())
+    {
+        m_size = size;
+        return;
+    }
+
+    if (size > m_capacity)
+    {
+        reallocate(std::max(size, 2 * m_capacity));
+    }
+
+    // Stations dropped by a shrink must have no history if they are grown back.
+    for (auto station{size}; station < m_size; ++station)
+    {
+        Clear(station);
+    }
+
+    m_size = size;
+}
+
+std::size_t PassengerStatistics::Size() const
+{
+    return m_size;
+}
+
+void PassengerStatistics::Clear(std::size_t station)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    for (std::size_t bucket{0}; bucket < m_minuteCount; ++bucket)
+    {
+        m_minutes[station * m_minuteCount + bucket].store(0, std::memory_order_relaxed);
+    }
+    for (std::size_t bucket{0}; bucket < m_hourCount; ++bucket)
+    {
+        m_hours[station * m_hourCount + bucket].store(0, std::memory_order_relaxed);
+    }
+}
+
+void PassengerStatistics::Remap(const std::vector<std::size_t>& sources)
+{
+    if (!IsEnabled())
+    {
+        m_size = sources.size();
+        return;
+    }
+
+    const auto capacity{sources.size()};
+    std::unique_ptr<Bucket[]> minutes{new Bucket[capacity * m_minuteCount]};
+    std::unique_ptr<Bucket[]> hours{new Bucket[capacity * m_hourCount]};
+    for (std::size_t station{0}; station < capacity; ++station)
+    {
+        const auto source{sources[station]};
+        for (std::size_t bucket{0}; bucket < m_minuteCount; ++bucket)
+        {
+            minutes[station * m_minuteCount + bucket].store(
+                source < m_size
+                    ? m_minutes[source * m_minuteCount + bucket].load(std::memory_order_relaxed)
+                    : 0,
+                std::memory_order_relaxed);
+        }
+        for (std::size_t bucket{0}; bucket < m_hourCount; ++bucket)
+        {
+            hours[station * m_hourCount + bucket].store(
+                source < m_size
+                    ? m_hours[source * m_hourCount + bucket].load(std::memory_order_relaxed)
+                    : 0,
+                std::memory_order_relaxed);
+        }
+    }
+
+    m_minutes = std::move(minutes);
+    m_hours = std::move(hours);
+    m_capacity = capacity;
+    m_size = capacity;
+}
+
+void PassengerStatistics::Add(std::size_t station,
+                              TimePoint time,
+                              std::uint32_t in,
+                              std::uint32_t out)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    // Move the end of the rings forward. This only writes once a minute.
+    const auto minute{FloorMinute(time)};
+    auto latest{m_latestMinute.load(std::memory_order_relaxed)};
+    while (minute > latest &&
+           !m_latestMinute.compare_exchange_weak(latest, minute, std::memory_order_relaxed))
+    {
+    }
+    latest = std::max(latest, minute);
+
+    const auto minuteCount{static_cast<std::int64_t>(m_minuteCount)};
+    if (minuteCount > 0 && minute > latest - minuteCount)
+    {
+        add(m_minutes[station * m_minuteCount + FloorMod(minute, minuteCount)],
+            minute,
+            m_minuteCount,
+            in,
+            out);
+    }
+
+    const auto hour{FloorDiv(minute, kMinutesPerHour)};
+    const auto hourCount{static_cast<std::int64_t>(m_hourCount)};
+    if (hourCount > 0 && hour > FloorDiv(latest, kMinutesPerHour) - hourCount)
+    {
+        add(m_hours[station * m_hourCount + FloorMod(hour, hourCount)],
+            hour,
+            m_hourCount,
+            in,
+            out);
+    }
+}
+
+PassengerFlow PassengerStatistics::GetFlow(std::size_t station, TimePoint from, TimePoint to) const
+{
+    const auto latest{m_latestMinute.load(std::memory_order_relaxed)};
+    if (latest == kNoMinute)
+    {
+        return PassengerFlow{};
+    }
+
+    const auto first{FloorMinute(from)};
+    const auto last{CeilMinute(to)};
+    const auto minuteCount{static_cast<std::int64_t>(m_minuteCount)};
+    if (m_hourCount == 0 || (m_minuteCount > 0 && first > latest - minuteCount))
+    {
+        return sum(m_minutes.get() + station * m_minuteCount, m_minuteCount, latest, first, last);
+    }
+
+    return sum(m_hours.get() + station * m_hourCount,
+               m_hourCount,
+               FloorDiv(latest, kMinutesPerHour),
+               FloorDiv(first, kMinutesPerHour),
+               FloorDiv(last + kMinutesPerHour - 1, kMinutesPerHour));
+}
+
+std::optional<PassengerWindow> PassengerStatistics::GetBusiestWindow(std::size_t station,
+                                                                     std::chrono::minutes length,
+                                                                     TimePoint from,
+                                                                     TimePoint to) const
+{
+    const auto latest{m_latestMinute.load(std::memory_order_relaxed)};
+    const auto minuteCount{static_cast<std::int64_t>(m_minuteCount)};
+    const auto window{static_cast<std::int64_t>(length.count())};
+    if (latest == kNoMinute || minuteCount == 0 || window <= 0)
+    {
+        return std::nullopt;
+    }
+
+    const auto first{std::max(FloorMinute(from), latest - minuteCount + 1)};
+    const auto last{std::min(CeilMinute(to), latest + 1)};
+    if (last - first < window)
+    {
+        return std::nullopt;
+    }
+
+    // Slide the window one minute at a time, adding the minute entering it and taking
+    // out the one leaving it.
+    const auto* ring{m_minutes.get() + station * m_minuteCount};
+    auto bucketAt{[ring, minuteCount, this](std::int64_t minute) {
+        return read(ring[FloorMod(minute, minuteCount)], minute, m_minuteCount);
+    }};
+
+    PassengerFlow flow{};
+    for (auto minute{first}; minute < first + window; ++minute)
+    {
+        const auto bucket{bucketAt(minute)};
+        flow.in += bucket.in;
+        flow.out += bucket.out;
+    }
+
+    PassengerWindow busiest{TimePoint{std::chrono::minutes{first}}, flow};
+    for (auto start{first + 1}; start + window <= last; ++start)
+    {
+        const auto entering{bucketAt(start + window - 1)};
+        const auto leaving{bucketAt(start - 1)};
+        flow.in += entering.in - leaving.in;
+        flow.out += entering.out - leaving.out;
+        if (flow.in + flow.out > busiest.flow.in + busiest.flow.out)
+        {
+            busiest = PassengerWindow{TimePoint{std::chrono::minutes{start}}, flow};
+        }
+    }
+
+    return busiest;
+}
+
+std::size_t PassengerStatistics::GetMemoryUsage() const
+{
+    return m_capacity * (m_minuteCount + m_hourCount) * sizeof(Bucket);
+}
+
+void PassengerStatistics::add(Bucket& bucket,
+                              std::int64_t period,
+                              std::size_t ringSize,
+                              std::uint32_t in,
+                              std::uint32_t out)
+{
+    const auto lap{
+        static_cast<std::uint16_t>(FloorDiv(period, static_cast<std::int64_t>(ringSize)))};
+    // Each field saturates on its own, so that an overflow never carries into its
+    // neighbour.
+    auto pack{[lap, in, out](std::uint64_t currentIn, std::uint64_t currentOut) {
+        const auto newIn{std::min(currentIn + in, kCountMask)};
+        const auto newOut{std::min(currentOut + out, kCountMask)};
+        return (std::uint64_t{lap} << kLapShift) | (newIn << kInShift) | newOut;
+    }};
+
+    auto current{bucket.load(std::memory_order_relaxed)};
+    while (true)
+    {
+        const auto currentLap{static_cast<std::uint16_t>(current >> kLapShift)};
+        std::uint64_t next{0};
+        if (currentLap == lap)
+        {
+            next = pack((current >> kInShift) & kCountMask, current & kCountMask);
+        }
+        else if ((current & ~(std::uint64_t{0xFFFF} << kLapShift)) == 0 ||
+                 static_cast<std::int16_t>(lap - currentLap) > 0)
+        {
+            // The bucket is empty or holds an older lap: start it over.
+            next = pack(0, 0);
+        }
+        else
+        {
+            // Another thread already moved the bucket to a newer lap.
+            return;
+        }
+
+        if (bucket.compare_exchange_weak(current, next, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+}
+
+PassengerFlow PassengerStatistics::read(const Bucket& bucket,
+                                        std::int64_t period,
+                                        std::size_t ringSize)
+{
+    const auto value{bucket.load(std::memory_order_relaxed)};
+    const auto lap{
+        static_cast<std::uint16_t>(FloorDiv(period, static_cast<std::int64_t>(ringSize)))};
+    if (static_cast<std::uint16_t>(value >> kLapShift) != lap)
+    {
+        return PassengerFlow{};
+    }
+
+    return PassengerFlow{static_cast<long long int>((value >> kInShift) & kCountMask),
+                         static_cast<long long int>(value & kCountMask)};
+}
+
+PassengerFlow PassengerStatistics::sum(const Bucket* ring,
+                                       std::size_t ringSize,
+                                       std::int64_t latest,
+                                       std::int64_t first,
+                                       std::int64_t last)
+{
+    PassengerFlow flow{};
+    const auto size{static_cast<std::int64_t>(ringSize)};
+    if (size == 0)
+    {
+        return flow;
+    }
+
+    // Only the periods still in the ring are counted.
+    first = std::max(first, latest - size + 1);
+    last = std::min(last, latest + 1);
+    for (auto period{first}; period < last; ++period)
+    {
+        const auto bucket{read(ring[FloorMod(period, size)], period, ringSize)};
+        flow.in += bucket.in;
+        flow.out += bucket.out;
+    }
+
+    return flow;
+}
+
+void PassengerStatistics::reallocate(std::size_t capacity)
+{
+    std::unique_ptr<Bucket[]> minutes{new Bucket[capacity * m_minuteCount]};
+    std::unique_ptr<Bucket[]> hours{new Bucket[capacity * m_hourCount]};
+    for (std::size_t bucket{0}; bucket < capacity * m_minuteCount; ++bucket)
+    {
+        minutes[bucket].store(bucket < m_size * m_minuteCount
+                                  ? m_minutes[bucket].load(std::memory_order_relaxed)
+                                  : 0,
+                              std::memory_order_relaxed);
+    }
+    for (std::size_t bucket{0}; bucket < capacity * m_hourCount; ++bucket)
+    {
+        hours[bucket].store(bucket < m_size * m_hourCount
+                                ? m_hours[bucket].load(std::memory_order_relaxed)
+                                : 0,
+                            std::memory_order_relaxed);
+    }
+
+    m_minutes = std::move(minutes);
+    m_hours = std::move(hours);
+    m_capacity = capacity;
+}
+
+} // namespace NetworkMonitor
@@ -0,0 +1,134 @@
+#include <network-monitor/path-search.h>
+
+#include <network-monitor/memory-usage.h>
+
+#include <algorithm>
+
+namespace NetworkMonitor
+{
+
+// A journey state is released when its buffers are this many times larger than the
+// network queried, and larger than kMinShrinkSize stations or routes.
+static constexpr std::size_t kShrinkFactor{4};
+static constexpr std::size_t kMinShrinkSize{1024};
+
+void PathSearchState::prepare(std::size_t stationCount)
+{
+    if (m_reached.size() < stationCount)
+    {
+        m_reached.resize(stationCount, 0);
+        m_settled.resize(stationCount, 0);
+        m_distance.resize(stationCount, 0);
+        m_parentStation.resize(stationCount, kNone);
+        m_parentEdge.resize(stationCount, kNone);
+    }
+
+    // On wrap-around old tags could collide with the new search number: reset them.
+    if (++m_search == 0)
+    {
+        std::fill(std::begin(m_reached), std::end(m_reached), 0);
+        std::fill(std::begin(m_settled), std::end(m_settled), 0);
+        m_search = 1;
+    }
+
+    m_heap.Clear();
+}
+
+void PathSearchState::clearBans(std::size_t stationCount, std::size_t edgeCount)
+{
+    if (m_bannedStation.size() < stationCount)
+    {
+        m_bannedStation.resize(stationCount, 0);
+    }
+    if (m_bannedEdge.size() < edgeCount)
+    {
+        m_bannedEdge.resize(edgeCount, 0);
+    }
+
+    if (++m_ban == 0)
+    {
+        std::fill(std::begin(m_bannedStation), std::end(m_bannedStation), 0);
+        std::fill(std::begin(m_bannedEdge), std::end(m_bannedEdge), 0);
+        m_ban = 1;
+    }
+}
+
+std::size_t PathSearchState::GetMemoryUsage() const
+{
+    return Memory::VectorBytes(m_reached) + Memory::VectorBytes(m_settled) +
+           Memory::VectorBytes(m_distance) + Memory::VectorBytes(m_parentStation) +
+           Memory::VectorBytes(m_parentEdge) + m_heap.GetMemoryUsage() +
+           Memory::VectorBytes(m_bannedStation) + Memory::VectorBytes(m_bannedEdge);
+}
+
+std::size_t JourneySearchState::GetMemoryUsage() const
+{
+    auto bytes{Memory::VectorBytes(m_rounds)};
+    for (const auto& labels : m_rounds)
+    {
+        bytes += Memory::VectorBytes(labels.stamp) + Memory::VectorBytes(labels.arrival) +
+                 Memory::VectorBytes(labels.leg);
+    }
+    return bytes + Memory::VectorBytes(m_bestStamp) + Memory::VectorBytes(m_best) +
+           Memory::VectorBytes(m_routeStamp) + Memory::VectorBytes(m_routeStart) +
+           Memory::VectorBytes(m_queuedRoutes) + Memory::VectorBytes(m_marked) +
+           Memory::VectorBytes(m_nextMarked) + Memory::VectorBytes(m_markedStamp);
+}
+
+void JourneySearchState::prepare(std::size_t stationCount,
+                                 std::size_t routeCount,
+                                 std::size_t roundCount)
+{
+    // Buffers left over from a much larger network are released rather than kept for
+    // good. Starting afresh also resets the query tags.
+    if (m_best.size() > kShrinkFactor * std::max(stationCount, kMinShrinkSize) ||
+        m_routeStamp.size() > kShrinkFactor * std::max(routeCount, kMinShrinkSize) ||
+        m_rounds.size() > kShrinkFactor * roundCount)
+    {
+        *this = JourneySearchState{};
+    }
+
+    if (m_rounds.size() < roundCount)
+    {
+        m_rounds.resize(roundCount);
+    }
+    for (auto& labels : m_rounds)
+    {
+        if (labels.stamp.size() < stationCount)
+        {
+            labels.stamp.resize(stationCount, 0);
+            labels.arrival.resize(stationCount, 0);
+            labels.leg.resize(stationCount);
+        }
+    }
+    if (m_best.size() < stationCount)
+    {
+        m_bestStamp.resize(stationCount, 0);
+        m_best.resize(stationCount, 0);
+        m_markedStamp.resize(stationCount, 0);
+    }
+    if (m_routeStamp.size() < routeCount)
+    {
+        m_routeStamp.resize(routeCount, 0);
+        m_routeStart.resize(routeCount, 0);
+    }
+
+    // On wrap-around old tags could collide with the new query number: reset them.
+    if (++m_query == 0)
+    {
+        for (auto& labels : m_rounds)
+        {
+            std::fill(std::begin(labels.stamp), std::end(labels.stamp), 0);
+        }
+        std::fill(std::begin(m_bestStamp), std::end(m_bestStamp), 0);
+        std::fill(std::begin(m_routeStamp), std::end(m_routeStamp), 0);
+        std::fill(std::begin(m_markedStamp), std::end(m_markedStamp), 0);
+        m_query = 1;
+    }
+
+    m_queuedRoutes.clear();
+    m_marked.clear();
+    m_nextMarked.clear();
+}
+
+} // namespace NetworkMonitor
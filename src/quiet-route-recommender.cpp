@@ -0,0 +1,161 @@
+#include <network-monitor/quiet-route-recommender.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+namespace NetworkMonitor
+{
+
+QuietRouteRecommender::QuietRouteRecommender(QuietRouteOptions options) : m_options{options}
+{
+}
+
+std::optional<QuietRoute> QuietRouteRecommender::Recommend(const TransportNetwork& network,
+                                                           StationHandle stationA,
+                                                           StationHandle stationB)
+{
+    sync(network);
+
+    const auto key{pairKey(stationA, stationB)};
+    auto entryIt{m_entries.find(key)};
+    if (entryIt == m_entries.end())
+    {
+        Entry entry{};
+        for (auto& path : network.GetAlternativePaths(stationA, stationB, m_options.candidateCount))
+        {
+            entry.candidates.push_back(Candidate{std::move(path), 0});
+        }
+        if (entry.candidates.empty())
+        {
+            return std::nullopt;
+        }
+
+        // Index the pair under every station its candidates go through, once per station.
+        std::unordered_set<std::uint32_t> stations{};
+        for (const auto& candidate : entry.candidates)
+        {
+            for (const auto& step : candidate.path.steps)
+            {
+                if (!stations.insert(step.station.value).second)
+                {
+                    continue;
+                }
+                if (m_pairsByStation.size() <= step.station.value)
+                {
+                    m_pairsByStation.resize(step.station.value + 1);
+                }
+                m_pairsByStation[step.station.value].push_back(key);
+            }
+        }
+
+        rank(network, entry);
+        entryIt = m_entries.emplace(key, std::move(entry)).first;
+    }
+
+    return toRecommendation(entryIt->second);
+}
+
+std::optional<QuietRoute> QuietRouteRecommender::GetCached(StationHandle stationA,
+                                                           StationHandle stationB) const
+{
+    const auto entryIt{m_entries.find(pairKey(stationA, stationB))};
+    if (entryIt == m_entries.end())
+    {
+        return std::nullopt;
+    }
+    return toRecommendation(entryIt->second);
+}
+
+std::size_t QuietRouteRecommender::OnPassengerEvents(const TransportNetwork& network,
+                                                     const std::vector<StationHandle>& stations)
+{
+    sync(network);
+
+    std::unordered_set<std::uint64_t> affected{};
+    for (const auto& station : stations)
+    {
+        if (!station.IsValid() || station.value >= m_pairsByStation.size())
+        {
+            continue;
+        }
+        const auto& pairs{m_pairsByStation[station.value]};
+        affected.insert(std::begin(pairs), std::end(pairs));
+    }
+
+    for (const auto key : affected)
+    {
+        rank(network, m_entries.at(key));
+    }
+    return affected.size();
+}
+
+std::vector<std::size_t> QuietRouteRecommender::RecordPassengerEvents(
+    TransportNetwork& network,
+    const std::vector<PassengerEvent>& events)
+{
+    auto failed{network.RecordPassengerEvents(events, m_changedStations)};
+    OnPassengerEvents(network, m_changedStations);
+    return failed;
+}
+
+std::size_t QuietRouteRecommender::GetCachedPairCount() const
+{
+    return m_entries.size();
+}
+
+std::uint64_t QuietRouteRecommender::pairKey(StationHandle stationA, StationHandle stationB)
+{
+    return (static_cast<std::uint64_t>(stationA.value) << 32) | stationB.value;
+}
+
+void QuietRouteRecommender::sync(const TransportNetwork& network)
+{
+    // Candidates are only valid for the layout and travel times they were computed on.
+    const auto revision{network.GetRevision()};
+    if (m_synced && revision == m_revision)
+    {
+        return;
+    }
+    m_entries.clear();
+    m_pairsByStation.clear();
+    m_revision = revision;
+    m_synced = true;
+}
+
+void QuietRouteRecommender::rank(const TransportNetwork& network, Entry& entry) const
+{
+    for (auto& candidate : entry.candidates)
+    {
+        // Counts can dip below zero when events are lost: never reward a station for it.
+        candidate.crowding = 0;
+        for (const auto& step : candidate.path.steps)
+        {
+            candidate.crowding += std::max(0LL, network.GetPassengerCount(step.station));
+        }
+    }
+
+    // Candidates are sorted by travel time, so ties go to the fastest path.
+    entry.best = 0;
+    for (std::size_t idx{1}; idx < entry.candidates.size(); ++idx)
+    {
+        if (score(entry.candidates[idx]) < score(entry.candidates[entry.best]))
+        {
+            entry.best = idx;
+        }
+    }
+}
+
+double QuietRouteRecommender::score(const Candidate& candidate) const
+{
+    return candidate.path.travelTime +
+           m_options.crowdingWeight * static_cast<double>(candidate.crowding);
+}
+
+QuietRoute QuietRouteRecommender::toRecommendation(const Entry& entry) const
+{
+    const auto& candidate{entry.candidates[entry.best]};
+    return QuietRoute{candidate.path, candidate.crowding, score(candidate)};
+}
+
+} // namespace NetworkMonitor
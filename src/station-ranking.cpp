@@ -0,0 +1,212 @@
+#include <network-monitor/station-ranking.h>
+
+#include <algorithm>
+
+namespace NetworkMonitor
+{
+
+StationRanking::StationRanking(const StationRanking& copied)
+{
+    *this = copied;
+}
+
+StationRanking::StationRanking(StationRanking&& moved) noexcept
+{
+    *this = std::move(moved);
+}
+
+StationRanking& StationRanking::operator=(const StationRanking& copied)
+{
+    if (this == &copied)
+    {
+        return *this;
+    }
+
+    m_size = 0;
+    m_capacity = 0;
+    m_changed.reset();
+    m_next.reset();
+    m_head.store(kEndOfList, std::memory_order_relaxed);
+    reallocate(copied.m_size);
+    m_size = copied.m_size;
+    m_order = copied.m_order;
+    m_rankedCounts = copied.m_rankedCounts;
+    m_ranked = copied.m_ranked;
+
+    // Stations still waiting to be re-ranked in the copied ranking wait in this one too.
+    for (Index station{0}; station < m_size; ++station)
+    {
+        if (copied.m_changed[station].load(std::memory_order_relaxed))
+        {
+            m_changed[station].store(true, std::memory_order_relaxed);
+            pushChanged(station);
+        }
+    }
+
+    return *this;
+}
+
+StationRanking& StationRanking::operator=(StationRanking&& moved) noexcept
+{
+    // The moved-from ranking is left empty, but usable.
+    m_size = std::exchange(moved.m_size, 0);
+    m_capacity = std::exchange(moved.m_capacity, 0);
+    m_changed = std::move(moved.m_changed);
+    m_next = std::move(moved.m_next);
+    m_head.store(moved.m_head.exchange(kEndOfList, std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+    m_order = std::move(moved.m_order);
+    m_rankedCounts = std::move(moved.m_rankedCounts);
+    m_ranked = std::move(moved.m_ranked);
+    moved.m_order.clear();
+    moved.m_rankedCounts.clear();
+    moved.m_ranked.clear();
+    return *this;
+}
+
+void StationRanking::Resize(std::size_t size)
+{
+    if (size > m_capacity)
+    {
+        reallocate(std::max(size, 2 * m_capacity));
+    }
+
+    for (auto station{size}; station < m_size; ++station)
+    {
+        SetRanked(station, false);
+    }
+
+    m_rankedCounts.resize(size, 0);
+    m_ranked.resize(size, true);
+    for (auto station{m_size}; station < size; ++station)
+    {
+        m_rankedCounts[station] = 0;
+        m_ranked[station] = true;
+        m_order.emplace(0, static_cast<Index>(station));
+    }
+
+    m_size = size;
+}
+
+std::size_t StationRanking::Size() const
+{
+    return m_size;
+}
+
+void StationRanking::SetRanked(std::size_t station, bool ranked)
+{
+    if (m_ranked[station] == ranked)
+    {
+        return;
+    }
+
+    m_ranked[station] = ranked;
+    if (!ranked)
+    {
+        m_order.erase(Entry{m_rankedCounts[station], static_cast<Index>(station)});
+        return;
+    }
+
+    // The count is read again at the next query.
+    m_rankedCounts[station] = 0;
+    m_order.emplace(0, static_cast<Index>(station));
+    MarkChanged(station);
+}
+
+void StationRanking::MarkChanged(std::size_t station)
+{
+    // Order the caller's count update before the flag check. Top() clears the flag before
+    // reading the count, with a matching fence: either this call sees the flag cleared and
+    // pushes the station again, or the query that cleared it sees the new count. Without
+    // both fences, each side could miss the other's write and leave a stale rank.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // A station already waiting to be re-ranked only costs a load, which stays in cache
+    // until the next query.
+    auto& changed{m_changed[station]};
+    if (changed.load(std::memory_order_relaxed) ||
+        changed.exchange(true, std::memory_order_acquire))
+    {
+        return;
+    }
+
+    pushChanged(static_cast<Index>(station));
+}
+
+std::vector<std::pair<std::size_t, long long int>>
+StationRanking::Top(std::size_t k, const PassengerCounters& counters) const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    // Take the whole list of changed stations at once. Producers push onto a new list
+    // from here on.
+    auto station{m_head.exchange(kEndOfList, std::memory_order_acquire)};
+    while (station != kEndOfList)
+    {
+        // Read the link before clearing the flag: once the flag is clear, the station can
+        // be pushed again, which overwrites its link.
+        const auto next{m_next[station].load(std::memory_order_relaxed)};
+        m_changed[station].store(false, std::memory_order_release);
+
+        // Pairs with the fence in MarkChanged().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (station < m_size && m_ranked[station])
+        {
+            const auto count{counters.Get(station)};
+            auto& rankedCount{m_rankedCounts[station]};
+            if (count != rankedCount)
+            {
+                // Reuse the set node, so that moving a station does not allocate.
+                auto node{m_order.extract(Entry{rankedCount, station})};
+                node.value().first = count;
+                m_order.insert(std::move(node));
+                rankedCount = count;
+            }
+        }
+
+        station = next;
+    }
+
+    std::vector<std::pair<std::size_t, long long int>> top{};
+    top.reserve(std::min(k, m_order.size()));
+    for (auto it{m_order.cbegin()}; it != m_order.cend() && top.size() < k; ++it)
+    {
+        top.emplace_back(it->second, it->first);
+    }
+
+    return top;
+}
+
+void StationRanking::pushChanged(Index station) const
+{
+    auto head{m_head.load(std::memory_order_relaxed)};
+    do
+    {
+        m_next[station].store(head, std::memory_order_relaxed);
+    } while (!m_head.compare_exchange_weak(
+        head, station, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void StationRanking::reallocate(std::size_t capacity)
+{
+    std::unique_ptr<std::atomic<bool>[]> changed{new std::atomic<bool>[capacity]};
+    std::unique_ptr<std::atomic<Index>[]> next{new std::atomic<Index>[capacity]};
+
+    // Stations dropped by a shrink can still be linked in the list of changed stations,
+    // so the whole capacity is carried over.
+    for (std::size_t station{0}; station < capacity; ++station)
+    {
+        const auto old{station < m_capacity};
+        changed[station].store(old && m_changed[station].load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+        next[station].store(old ? m_next[station].load(std::memory_order_relaxed) : kEndOfList,
+                            std::memory_order_relaxed);
+    }
+
+    m_changed = std::move(changed);
+    m_next = std::move(next);
+    m_capacity = capacity;
+}
+
+} // namespace NetworkMonitor
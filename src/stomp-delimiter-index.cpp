@@ -0,0 +1,309 @@
+#include <network-monitor/stomp-delimiter-index.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NETWORK_MONITOR_HAS_X86_KERNELS 1
+#endif
+
+namespace NetworkMonitor
+{
+
+namespace
+{
+
+constexpr std::size_t kBlockSize{64};
+constexpr std::size_t kNewline{static_cast<std::size_t>(StompDelimiter::NEWLINE)};
+constexpr std::size_t kColon{static_cast<std::size_t>(StompDelimiter::COLON)};
+constexpr std::size_t kNul{static_cast<std::size_t>(StompDelimiter::NUL)};
+constexpr std::size_t kMasksPerBlock{static_cast<std::size_t>(StompDelimiter::SIZE_OF_ENUM)};
+
+// Kernels fill the masks of whole 64-byte blocks.
+using ScanFunction = void (*)(const char* data, std::size_t blocks, std::uint64_t* masks);
+
+std::size_t CountTrailingZeros(std::uint64_t mask)
+{
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctzll(mask));
+#else
+    std::size_t count{0};
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+std::size_t PopCount(std::uint64_t mask)
+{
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_popcountll(mask));
+#else
+    std::size_t count{0};
+    for (; mask != 0; mask &= mask - 1)
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+void ScanScalar(const char* data, std::size_t blocks, std::uint64_t* masks)
+{
+    for (std::size_t block{0}; block < blocks; ++block, data += kBlockSize)
+    {
+        std::uint64_t newline{0};
+        std::uint64_t colon{0};
+        std::uint64_t nul{0};
+        for (std::size_t idx{0}; idx < kBlockSize; ++idx)
+        {
+            const auto bit{std::uint64_t{1} << idx};
+            newline |= data[idx] == '\n' ? bit : 0;
+            colon |= data[idx] == ':' ? bit : 0;
+            nul |= data[idx] == '\0' ? bit : 0;
+        }
+
+        auto* blockMasks{masks + block * kMasksPerBlock};
+        blockMasks[kNewline] = newline;
+        blockMasks[kColon] = colon;
+        blockMasks[kNul] = nul;
+    }
+}
+
+#ifdef NETWORK_MONITOR_HAS_X86_KERNELS
+
+// Helpers carry the target of the kernel calling them, as lambdas would not.
+__attribute__((target("sse2"))) std::uint64_t ToMask(__m128i matches, std::size_t lane)
+{
+    return std::uint64_t{static_cast<std::uint16_t>(_mm_movemask_epi8(matches))} << (16 * lane);
+}
+
+__attribute__((target("avx2"))) std::uint64_t ToMask(__m256i low, __m256i high)
+{
+    return std::uint64_t{static_cast<std::uint32_t>(_mm256_movemask_epi8(low))} |
+           (std::uint64_t{static_cast<std::uint32_t>(_mm256_movemask_epi8(high))} << 32);
+}
+
+__attribute__((target("sse2"))) void ScanSse2(const char* data,
+                                              std::size_t blocks,
+                                              std::uint64_t* masks)
+{
+    const auto newline{_mm_set1_epi8('\n')};
+    const auto colon{_mm_set1_epi8(':')};
+    const auto nul{_mm_setzero_si128()};
+
+    for (std::size_t block{0}; block < blocks; ++block, data += kBlockSize)
+    {
+        auto* blockMasks{masks + block * kMasksPerBlock};
+        blockMasks[kNewline] = 0;
+        blockMasks[kColon] = 0;
+        blockMasks[kNul] = 0;
+        for (std::size_t lane{0}; lane < 4; ++lane)
+        {
+            const auto chunk{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * lane))};
+            blockMasks[kNewline] |= ToMask(_mm_cmpeq_epi8(chunk, newline), lane);
+            blockMasks[kColon] |= ToMask(_mm_cmpeq_epi8(chunk, colon), lane);
+            blockMasks[kNul] |= ToMask(_mm_cmpeq_epi8(chunk, nul), lane);
+        }
+    }
+}
+
+__attribute__((target("avx2"))) void ScanAvx2(const char* data,
+                                              std::size_t blocks,
+                                              std::uint64_t* masks)
+{
+    const auto newline{_mm256_set1_epi8('\n')};
+    const auto colon{_mm256_set1_epi8(':')};
+    const auto nul{_mm256_setzero_si256()};
+
+    for (std::size_t block{0}; block < blocks; ++block, data += kBlockSize)
+    {
+        const auto low{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data))};
+        const auto high{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32))};
+
+        auto* blockMasks{masks + block * kMasksPerBlock};
+        blockMasks[kNewline] =
+            ToMask(_mm256_cmpeq_epi8(low, newline), _mm256_cmpeq_epi8(high, newline));
+        blockMasks[kColon] = ToMask(_mm256_cmpeq_epi8(low, colon), _mm256_cmpeq_epi8(high, colon));
+        blockMasks[kNul] = ToMask(_mm256_cmpeq_epi8(low, nul), _mm256_cmpeq_epi8(high, nul));
+    }
+}
+
+#endif // NETWORK_MONITOR_HAS_X86_KERNELS
+
+ScanFunction GetScanFunction(const StompScanKernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef NETWORK_MONITOR_HAS_X86_KERNELS
+    case StompScanKernel::SSE2:
+        return ScanSse2;
+    case StompScanKernel::AVX2:
+        return ScanAvx2;
+#endif
+    default:
+        return ScanScalar;
+    }
+}
+
+} // namespace
+
+std::string ToString(const StompScanKernel kernel)
+{
+    switch (kernel)
+    {
+    case StompScanKernel::SCALAR:
+        return std::string{"SCALAR"};
+        break;
+    case StompScanKernel::SSE2:
+        return std::string{"SSE2"};
+        break;
+    case StompScanKernel::AVX2:
+        return std::string{"AVX2"};
+        break;
+    default:
+        return std::string{"SIZE_OF_ENUM"};
+        break;
+    }
+}
+
+std::ostream& operator<<(std::ostream& ost, const StompScanKernel kernel)
+{
+    ost << ToString(kernel);
+    return ost;
+}
+
+bool IsSupported(const StompScanKernel kernel)
+{
+    switch (kernel)
+    {
+    case StompScanKernel::SCALAR:
+        return true;
+#ifdef NETWORK_MONITOR_HAS_X86_KERNELS
+    case StompScanKernel::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case StompScanKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+StompScanKernel GetBestStompScanKernel()
+{
+    static const auto best{[]() {
+        for (auto kernel : {StompScanKernel::AVX2, StompScanKernel::SSE2})
+        {
+            if (IsSupported(kernel))
+            {
+                return kernel;
+            }
+        }
+        return StompScanKernel::SCALAR;
+    }()};
+    return best;
+}
+
+StompDelimiterIndex::StompDelimiterIndex(std::string_view frame)
+    : StompDelimiterIndex(frame, GetBestStompScanKernel())
+{
+}
+
+StompDelimiterIndex::StompDelimiterIndex(std::string_view frame, StompScanKernel kernel)
+    : m_size{frame.size()}, m_blocks{(frame.size() + kBlockSize - 1) / kBlockSize}
+{
+    if (m_blocks > kInlineBlocks)
+    {
+        m_heap.resize(m_blocks * kMasksPerBlock);
+    }
+    auto* out{m_heap.empty() ? m_inline.data() : m_heap.data()};
+
+    const auto scan{GetScanFunction(kernel)};
+    const auto fullBlocks{m_size / kBlockSize};
+    scan(frame.data(), fullBlocks, out);
+
+    // The last partial block is scanned from a padded copy, so that kernels never read
+    // past the frame. The padding is then masked out.
+    if (const auto tail{m_size % kBlockSize}; tail > 0)
+    {
+        char block[kBlockSize]{};
+        std::memcpy(block, frame.data() + fullBlocks * kBlockSize, tail);
+        auto* tailMasks{out + fullBlocks * kMasksPerBlock};
+        scan(block, 1, tailMasks);
+        const auto valid{(std::uint64_t{1} << tail) - 1};
+        for (std::size_t delimiter{0}; delimiter < kMasksPerBlock; ++delimiter)
+        {
+            tailMasks[delimiter] &= valid;
+        }
+    }
+}
+
+std::size_t StompDelimiterIndex::Size() const
+{
+    return m_size;
+}
+
+std::size_t StompDelimiterIndex::Find(StompDelimiter delimiter, std::size_t pos) const
+{
+    if (pos >= m_size)
+    {
+        return std::string::npos;
+    }
+
+    const auto* data{masks() + static_cast<std::size_t>(delimiter)};
+    auto block{pos / kBlockSize};
+    auto mask{data[block * kMasksPerBlock] & (~std::uint64_t{0} << (pos % kBlockSize))};
+    while (mask == 0)
+    {
+        if (++block == m_blocks)
+        {
+            return std::string::npos;
+        }
+        mask = data[block * kMasksPerBlock];
+    }
+
+    return block * kBlockSize + CountTrailingZeros(mask);
+}
+
+std::size_t StompDelimiterIndex::Count(StompDelimiter delimiter,
+                                       std::size_t from,
+                                       std::size_t to) const
+{
+    to = std::min(to, m_size);
+    if (from >= to)
+    {
+        return 0;
+    }
+
+    const auto* data{masks() + static_cast<std::size_t>(delimiter)};
+    const auto first{from / kBlockSize};
+    const auto last{(to - 1) / kBlockSize};
+    std::size_t count{0};
+    for (auto block{first}; block <= last; ++block)
+    {
+        auto mask{data[block * kMasksPerBlock]};
+        if (block == first)
+        {
+            mask &= ~std::uint64_t{0} << (from % kBlockSize);
+        }
+        if (block == last && to % kBlockSize != 0)
+        {
+            mask &= (std::uint64_t{1} << (to % kBlockSize)) - 1;
+        }
+        count += PopCount(mask);
+    }
+
+    return count;
+}
+
+const std::uint64_t* StompDelimiterIndex::masks() const
+{
+    return m_heap.empty() ? m_inline.data() : m_heap.data();
+}
+
+} // namespace NetworkMonitor
@@ -0,0 +1,76 @@
+#include <network-monitor/stomp-frame-batch.h>
+#include <network-monitor/stomp-parser.h>
+
+#include <utility>
+
+namespace NetworkMonitor
+{
+
+StompFrameBatch::StompFrameBatch(StompError& ec, std::string&& buffer)
+    : StompFrameBatch(ec, std::make_shared<const std::string>(std::move(buffer)))
+{
+}
+
+StompFrameBatch::StompFrameBatch(StompError& ec, std::shared_ptr<const std::string> buffer)
+    : m_buffer{std::move(buffer)}
+{
+    ec = StompError::OK;
+    if (!m_buffer)
+    {
+        return;
+    }
+
+    parse(ec, *m_buffer);
+}
+
+StompFrameBatch::StompFrameBatch(StompError& ec, std::string_view buffer)
+{
+    ec = StompError::OK;
+    parse(ec, buffer);
+}
+
+std::size_t StompFrameBatch::Size() const
+{
+    return m_frames.Size();
+}
+
+bool StompFrameBatch::Empty() const
+{
+    return m_frames.Empty();
+}
+
+const StompFrameView& StompFrameBatch::operator[](std::size_t idx) const
+{
+    return m_frames[idx];
+}
+
+StompFrameBatch::const_iterator StompFrameBatch::begin() const
+{
+    return m_frames.begin();
+}
+
+StompFrameBatch::const_iterator StompFrameBatch::end() const
+{
+    return m_frames.end();
+}
+
+const std::shared_ptr<const std::string>& StompFrameBatch::GetBuffer() const
+{
+    return m_buffer;
+}
+
+void StompFrameBatch::parse(StompError& ec, std::string_view buffer)
+{
+    StompParser parser{buffer};
+    while (parser.nextFrame())
+    {
+        auto frame{parser.parseFrame(ec)};
+        if (StompError::OK != ec)
+        {
+            return;
+        }
+        m_frames.PushBack(std::move(frame));
+    }
+}
+
+} // namespace NetworkMonitor
@@ -47,6 +47,58 @@ StompFrame::StompFrame(StompError& ec, std::string&& frame)
     initialize(ec);
 }
 
+StompFrame::StompFrame(std::string&& frame,
+                       const StompCommand cmd,
+                       std::vector<Header>&& headers,
+                       const Body& body)
+    : m_command{cmd}, m_headers{std::move(headers)}, m_body{body}
+{
+    const auto* base{frame.data()};
+    m_frame = std::move(frame);
+    rebase(base);
+}
+
+StompFrame::StompFrame(const StompFrame& frame)
+    : m_frame{frame.m_frame},
+      m_command{frame.m_command},
+      m_headers{frame.m_headers},
+      m_body{frame.m_body}
+{
+    rebase(frame.m_frame.data());
+}
+
+StompFrame& StompFrame::operator=(const StompFrame& frame)
+{
+    if (this != &frame)
+    {
+        m_frame = frame.m_frame;
+        m_command = frame.m_command;
+        m_headers = frame.m_headers;
+        m_body = frame.m_body;
+        rebase(frame.m_frame.data());
+    }
+    return *this;
+}
+
+StompFrame::StompFrame(StompFrame&& frame) noexcept
+{
+    *this = std::move(frame);
+}
+
+StompFrame& StompFrame::operator=(StompFrame&& frame) noexcept
+{
+    if (this != &frame)
+    {
+        const auto* base{frame.m_frame.data()};
+        m_frame = std::move(frame.m_frame);
+        m_command = frame.m_command;
+        m_headers = std::move(frame.m_headers);
+        m_body = frame.m_body;
+        rebase(base);
+    }
+    return *this;
+}
+
 StompCommand StompFrame::GetCommand() const
 {
     return m_command;
@@ -176,6 +228,88 @@ void StompFrame::initialize(StompError& ec)
     m_body = body;
 }
 
+void StompFrame::rebase(const char* base)
+{
+    // A copy has its own buffer, and short strings do not keep theirs when moved, so views
+    // are carried over by offset.
+    auto carry{[this, base](std::string_view view) {
+        return view.data() == nullptr
+                   ? view
+                   : std::string_view{m_frame.data() + (view.data() - base), view.size()};
+    }};
+    for (auto& header : m_headers)
+    {
+        header.value = carry(header.value);
+    }
+    m_body = carry(m_body);
+}
+
+StompFrameView::StompFrameView(StompError& ec, std::string_view frame)
+{
+    StompParser parser{frame};
+    auto view{parser.parseFrame(ec)};
+    if (StompError::OK != ec)
+    {
+        return;
+    }
+
+    if (parser.nextFrame())
+    {
+        ec = StompError::JUNK_AFTER_BODY;
+        return;
+    }
+
+    *this = std::move(view);
+}
+
+StompFrameView::StompFrameView(const StompCommand cmd,
+                               Headers&& headers,
+                               const StompFrame::Body& body,
+                               std::string_view frame)
+    : m_command{cmd}, m_headers{std::move(headers)}, m_body{body}, m_frame{frame}
+{
+}
+
+StompCommand StompFrameView::GetCommand() const
+{
+    return m_command;
+}
+
+std::string_view StompFrameView::GetHeaderValue(const StompHeaders hdr) const
+{
+    auto it = std::find_if(std::begin(m_headers),
+                           std::end(m_headers),
+                           [&hdr](const auto& header) { return header.key == hdr; });
+
+    return it != std::end(m_headers) ? it->value : std::string_view{};
+}
+
+const StompFrameView::Headers& StompFrameView::GetHeaders() const
+{
+    return m_headers;
+}
+
+StompFrame::Body StompFrameView::GetBody() const
+{
+    return m_body;
+}
+
+std::string_view StompFrameView::String() const
+{
+    return m_frame;
+}
+
+StompFrame StompFrameView::ToOwned() const
+{
+    StompFrame frame{};
+    frame.m_frame = std::string{m_frame};
+    frame.m_command = m_command;
+    frame.m_headers.assign(std::begin(m_headers), std::end(m_headers));
+    frame.m_body = m_body;
+    frame.rebase(m_frame.data());
+    return frame;
+}
+
 std::ostream& operator<<(std::ostream& ost, const StompError err)
 {
     ost << ToString(err);
@@ -204,6 +338,9 @@ std::string ToString(const StompError err)
     case NetworkMonitor::StompError::EMPTY_HEADER_VALUE:
         return std::string{"EMPTY_HEADER_VALUE"};
         break;
+    case NetworkMonitor::StompError::FRAME_TOO_LARGE:
+        return std::string{"FRAME_TOO_LARGE"};
+        break;
     case NetworkMonitor::StompError::BAD_HEADER:
         return std::string{"BAD_HEADER"};
         break;
@@ -325,6 +462,9 @@ std::string ToString(const StompHeaders cmd)
     case NetworkMonitor::StompHeaders::ACK:
         return std::string{"ack"};
         break;
+    case NetworkMonitor::StompHeaders::VERSION:
+        return std::string{"version"};
+        break;
     case NetworkMonitor::StompHeaders::SESSION:
         return std::string{"session"};
         break;
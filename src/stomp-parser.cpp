@@ -1,49 +1,211 @@
 #include <network-monitor/stomp-parser.h>
 
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 
 namespace NetworkMonitor
 {
 
+namespace
+{
+
+constexpr StompCommand MatchCommand(std::string_view name,
+                                    std::string_view expected,
+                                    StompCommand command)
+{
+    return name == expected ? command : StompCommand::SIZE_OF_ENUM;
+}
+
+constexpr StompHeaders MatchHeader(std::string_view name,
+                                   std::string_view expected,
+                                   StompHeaders header)
+{
+    return name == expected ? header : StompHeaders::SIZE_OF_ENUM;
+}
+
+// Command and header names are told apart by their length and one character, then
+// confirmed with a single comparison. Nothing is built at run time, so creating a parser
+// for every frame is free.
+constexpr StompCommand LookupCommand(std::string_view name)
+{
+    using Command = StompCommand;
+    switch (name.size())
+    {
+    case 3:
+        return MatchCommand(name, "ACK", Command::ACK);
+    case 4:
+        return name[0] == 'S' ? MatchCommand(name, "SEND", Command::SEND)
+                              : MatchCommand(name, "NACK", Command::NACK);
+    case 5:
+        switch (name[0])
+        {
+        case 'A':
+            return MatchCommand(name, "ABORT", Command::ABORT);
+        case 'B':
+            return MatchCommand(name, "BEGIN", Command::BEGIN);
+        case 'E':
+            return MatchCommand(name, "ERROR", Command::ERROR);
+        case 'S':
+            return MatchCommand(name, "STOMP", Command::STOMP);
+        default:
+            return Command::SIZE_OF_ENUM;
+        }
+    case 7:
+        switch (name[2])
+        {
+        case 'M':
+            return MatchCommand(name, "COMMENT", Command::COMMENT);
+        case 'N':
+            return MatchCommand(name, "CONNECT", Command::CONNECT);
+        case 'S':
+            return MatchCommand(name, "MESSAGE", Command::MESSAGE);
+        case 'C':
+            return MatchCommand(name, "RECEIPT", Command::RECEIPT);
+        default:
+            return Command::SIZE_OF_ENUM;
+        }
+    case 9:
+        return name[0] == 'S' ? MatchCommand(name, "SUBSCRIBE", Command::SUBSCRIBE)
+                              : MatchCommand(name, "CONNECTED", Command::CONNECTED);
+    case 10:
+        return MatchCommand(name, "DISCONNECT", Command::DISCONNECT);
+    case 11:
+        return MatchCommand(name, "UNSUBSCRIBE", Command::UNSUBSCRIBE);
+    default:
+        return Command::SIZE_OF_ENUM;
+    }
+}
+
+constexpr StompHeaders LookupHeader(std::string_view name)
+{
+    using Header = StompHeaders;
+    switch (name.size())
+    {
+    case 2:
+        return MatchHeader(name, "id", Header::ID);
+    case 3:
+        return MatchHeader(name, "ack", Header::ACK);
+    case 4:
+        return MatchHeader(name, "host", Header::HOST);
+    case 5:
+        return MatchHeader(name, "login", Header::LOGIN);
+    case 7:
+        switch (name[0])
+        {
+        case 'r':
+            return MatchHeader(name, "receipt", Header::RECEIPT);
+        case 's':
+            return MatchHeader(name, "session", Header::SESSION);
+        case 'v':
+            return MatchHeader(name, "version", Header::VERSION);
+        default:
+            return Header::SIZE_OF_ENUM;
+        }
+    case 8:
+        return MatchHeader(name, "passcode", Header::PASSCODE);
+    case 10:
+        return MatchHeader(name, "receipt-id", Header::RECEIPT_ID);
+    case 11:
+        return MatchHeader(name, "destination", Header::DESTINATION);
+    case 12:
+        return MatchHeader(name, "content-type", Header::CONTENT_TYPE);
+    case 14:
+        return name[0] == 'c' ? MatchHeader(name, "content-length", Header::CONTENT_LENGTH)
+                              : MatchHeader(name, "accept-version", Header::ACCEPT_VERSION);
+    default:
+        return Header::SIZE_OF_ENUM;
+    }
+}
+
+static_assert(LookupCommand("CONNECTED") == StompCommand::CONNECTED);
+static_assert(LookupCommand("COMMENT") == StompCommand::COMMENT);
+static_assert(LookupCommand("CONNECTX") == StompCommand::SIZE_OF_ENUM);
+static_assert(LookupHeader("content-length") == StompHeaders::CONTENT_LENGTH);
+static_assert(LookupHeader("accept-version") == StompHeaders::ACCEPT_VERSION);
+static_assert(LookupHeader("content-lengtx") == StompHeaders::SIZE_OF_ENUM);
+
+// Most a stream parser reserves for a body ahead of its bytes arriving.
+constexpr std::size_t kMaxBodyReserve{64 * 1024};
+
+// Split a header line, without its end of line, at its first colon.
+StompError ParseHeaderLine(std::string_view line, std::size_t colon, StompFrame::Header& header)
+{
+    if (colon == std::string::npos)
+    {
+        return StompError::BAD_HEADER;
+    }
+
+    header.key = LookupHeader(line.substr(0, colon));
+    if (header.key == StompHeaders::SIZE_OF_ENUM)
+    {
+        return StompError::BAD_HEADER;
+    }
+
+    header.value = line.substr(colon + 1);
+    if (header.value.empty())
+    {
+        return StompError::EMPTY_HEADER_VALUE;
+    }
+
+    return StompError::OK;
+}
+
+StompError ParseContentLength(std::string_view value, std::size_t& contentLength)
+{
+    const auto* end{value.data() + value.size()};
+    if (auto [ptr, err] = std::from_chars(value.data(), end, contentLength);
+        err != std::errc{} || ptr != end)
+    {
+        return StompError::WRONG_CONTENT_LENGTH;
+    }
+
+    return StompError::OK;
+}
+
+template <typename Headers>
+StompError CheckRequiredHeaders(StompCommand command, const Headers& headers)
+{
+    if (command != StompCommand::CONNECT)
+    {
+        return StompError::OK;
+    }
+
+    auto hasHeader{[&headers](StompHeaders key) {
+        return std::any_of(std::begin(headers), std::end(headers), [key](const auto& header) {
+            return header.key == key;
+        });
+    }};
+    if (!hasHeader(StompHeaders::ACCEPT_VERSION))
+    {
+        return StompError::MISSING_ACCEPT_VERSION;
+    }
+    if (!hasHeader(StompHeaders::HOST))
+    {
+        return StompError::MISSING_HOST;
+    }
+
+    return StompError::OK;
+}
+
+} // namespace
+
 StompParser::StompParser(std::string_view frame)
-    : m_commandsMap{{"SEND", StompCommand::SEND},
-                    {"SUBSCRIBE", StompCommand::SUBSCRIBE},
-                    {"UNSUBSCRIBE", StompCommand::UNSUBSCRIBE},
-                    {"BEGIN", StompCommand::BEGIN},
-                    {"COMMENT", StompCommand::COMMENT},
-                    {"ABORT", StompCommand::ABORT},
-                    {"ACK", StompCommand::ACK},
-                    {"NACK", StompCommand::NACK},
-                    {"DISCONNECT", StompCommand::DISCONNECT},
-                    {"CONNECT", StompCommand::CONNECT},
-                    {"STOMP", StompCommand::STOMP},
-                    {"CONNECTED", StompCommand::CONNECTED},
-                    {"MESSAGE", StompCommand::MESSAGE},
-                    {"RECEIPT", StompCommand::RECEIPT},
-                    {"ERROR", StompCommand::ERROR}}
-    , m_headersMap{{"content-length", StompHeaders::CONTENT_LENGTH},
-                   {"content-type", StompHeaders::CONTENT_TYPE},
-                   {"receipt", StompHeaders::RECEIPT},
-                   {"accept-version", StompHeaders::ACCEPT_VERSION},
-                   {"host", StompHeaders::HOST},
-                   {"version", StompHeaders::VERSION},
-                   {"session", StompHeaders::SESSION},
-                   {"receipt-id", StompHeaders::RECEIPT_ID}}
-    , m_frame{frame}
+    : m_frame{frame}, m_delimiters{frame}
 {
 }
 
 StompCommand StompParser::parseCommand(StompError& ec)
 {
     size_t currentPos = m_pos;
-    size_t newPos = m_frame.find_first_of('\n', m_pos);
+    size_t newPos = m_delimiters.Find(StompDelimiter::NEWLINE, m_pos);
 
     std::string_view command{m_frame.substr(currentPos, newPos - currentPos)};
-    if (auto cmdIt = m_commandsMap.find(command); cmdIt != m_commandsMap.end())
+    if (auto cmd = LookupCommand(command); cmd != StompCommand::SIZE_OF_ENUM)
     {
         m_pos = newPos + 1;
         ec = StompError::OK;
-        return cmdIt->second;
+        return cmd;
     }
 
     ec = StompError::UNDEFINED_COMMAND;
@@ -53,7 +215,7 @@ StompCommand StompParser::parseCommand(StompError& ec)
 StompFrame::Header StompParser::parseHeader(StompError& ec)
 {
     size_t currentPos = m_pos;
-    size_t newPos = m_frame.find_first_of('\n', currentPos);
+    size_t newPos = m_delimiters.Find(StompDelimiter::NEWLINE, currentPos);
 
     std::string_view header = m_frame.substr(currentPos, newPos - currentPos);
     if (header.size() == 0)
@@ -63,23 +225,20 @@ StompFrame::Header StompParser::parseHeader(StompError& ec)
     }
 
     // Parse and detect header key.
-    size_t headerDelimPos = header.find_first_of(':');
-    if (std::string::npos == headerDelimPos)
+    size_t headerDelimPos = m_delimiters.Find(StompDelimiter::COLON, currentPos);
+    if (std::string::npos == headerDelimPos || headerDelimPos >= currentPos + header.size())
     {
         ec = StompError::BAD_HEADER;
         return StompFrame::Header{StompHeaders::SIZE_OF_ENUM, ""};
     }
 
+    headerDelimPos -= currentPos;
     std::string_view headerKeyView = header.substr(0, headerDelimPos);
-    StompHeaders headerKey{StompHeaders::SIZE_OF_ENUM};
-    if (auto it = m_headersMap.find(headerKeyView); it != m_headersMap.end())
-    {
-        headerKey = it->second;
-    }
+    StompHeaders headerKey{LookupHeader(headerKeyView)};
 
     if (headerKey == StompHeaders::SIZE_OF_ENUM)
     {
-        ec = StompError::EMPTY_HEADER;
+        ec = StompError::BAD_HEADER;
         return StompFrame::Header{StompHeaders::SIZE_OF_ENUM, ""};
     }
 
@@ -99,8 +258,7 @@ StompFrame::Header StompParser::parseHeader(StompError& ec)
 StompFrame::Body StompParser::parseBody(StompError& ec, std::size_t contentLength)
 {
     size_t currentPos = m_pos;
-    size_t bodyNewlinePos = m_frame.find_first_of('\n', m_pos);
-    if (currentPos != bodyNewlinePos)
+    if (currentPos >= m_frame.size() || m_frame[currentPos] != '\n')
     {
         ec = StompError::MISSING_BODY_NEWLINE;
         return std::string_view{};
@@ -112,7 +270,7 @@ StompFrame::Body StompParser::parseBody(StompError& ec, std::size_t contentLengt
     size_t newPos = contentLength;
     if (newPos >= m_frame.size() || std::string::npos == newPos)
     {
-        newPos = m_frame.find_first_of('\0', currentPos);
+        newPos = m_delimiters.Find(StompDelimiter::NUL, currentPos);
     }
 
     if (std::string::npos == newPos)
@@ -125,26 +283,337 @@ StompFrame::Body StompParser::parseBody(StompError& ec, std::size_t contentLengt
     ec = StompError::OK;
     m_pos = newPos + 1;
 
-    if (auto afterBody = m_frame.substr(m_pos); afterBody.size() != 0)
+    // Only newlines may follow the body.
+    if (m_pos < m_frame.size() &&
+        m_delimiters.Count(StompDelimiter::NEWLINE, m_pos, m_frame.size()) !=
+            m_frame.size() - m_pos)
+    {
+        ec = StompError::JUNK_AFTER_BODY;
+        return std::string_view{};
+    }
+
+    return body;
+}
+
+bool StompParser::nextFrame()
+{
+    while (m_pos < m_frame.size() && m_frame[m_pos] == '\n')
     {
-        bool allNewline{true};
-        for (auto ch : afterBody)
+        ++m_pos;
+    }
+
+    return m_pos < m_frame.size();
+}
+
+StompFrameView StompParser::parseFrame(StompError& ec)
+{
+    const auto frameStart{m_pos};
+
+    // A frame cut short before the empty line ending its headers misses its body newline.
+    auto lineEnd{m_delimiters.Find(StompDelimiter::NEWLINE, m_pos)};
+    if (std::string::npos == lineEnd)
+    {
+        ec = StompError::MISSING_BODY_NEWLINE;
+        return StompFrameView{};
+    }
+
+    const auto command{LookupCommand(m_frame.substr(m_pos, lineEnd - m_pos))};
+    if (command == StompCommand::SIZE_OF_ENUM)
+    {
+        ec = StompError::UNDEFINED_COMMAND;
+        return StompFrameView{};
+    }
+    m_pos = lineEnd + 1;
+
+    StompFrameView::Headers headers{};
+    std::size_t contentLength{std::string::npos};
+    while (true)
+    {
+        lineEnd = m_delimiters.Find(StompDelimiter::NEWLINE, m_pos);
+        if (std::string::npos == lineEnd)
+        {
+            ec = StompError::MISSING_BODY_NEWLINE;
+            return StompFrameView{};
+        }
+        if (lineEnd == m_pos)
+        {
+            ++m_pos;
+            break;
+        }
+
+        const auto colon{m_delimiters.Find(StompDelimiter::COLON, m_pos)};
+        StompFrame::Header header{};
+        ec = ParseHeaderLine(m_frame.substr(m_pos, lineEnd - m_pos),
+                             colon < lineEnd ? colon - m_pos : std::string::npos,
+                             header);
+        if (StompError::OK != ec)
+        {
+            return StompFrameView{};
+        }
+
+        // Only the first occurrence of a repeated header counts.
+        if (header.key == StompHeaders::CONTENT_LENGTH && contentLength == std::string::npos)
         {
-            if (ch != '\n')
+            ec = ParseContentLength(header.value, contentLength);
+            if (StompError::OK != ec)
+            {
+                return StompFrameView{};
+            }
+        }
+
+        headers.PushBack(header);
+        m_pos = lineEnd + 1;
+    }
+
+    // With a content-length, the body may contain NUL octets.
+    std::size_t bodyEnd{std::string::npos};
+    if (contentLength != std::string::npos)
+    {
+        if (contentLength >= m_frame.size() - m_pos || m_frame[m_pos + contentLength] != '\0')
+        {
+            ec = StompError::WRONG_CONTENT_LENGTH;
+            return StompFrameView{};
+        }
+        bodyEnd = m_pos + contentLength;
+    }
+    else
+    {
+        bodyEnd = m_delimiters.Find(StompDelimiter::NUL, m_pos);
+        if (std::string::npos == bodyEnd)
+        {
+            ec = StompError::UNTERMINATED_BODY;
+            return StompFrameView{};
+        }
+    }
+
+    const auto body{m_frame.substr(m_pos, bodyEnd - m_pos)};
+    m_pos = bodyEnd + 1;
+
+    ec = CheckRequiredHeaders(command, headers);
+    if (StompError::OK != ec)
+    {
+        return StompFrameView{};
+    }
+
+    return StompFrameView{
+        command, std::move(headers), body, m_frame.substr(frameStart, m_pos - frameStart)};
+}
+
+StompStreamParser::StompStreamParser(std::size_t maxFrameSize)
+    : m_maxFrameSize{maxFrameSize}
+{
+}
+
+std::size_t StompStreamParser::Parse(StompError& ec,
+                                     std::string_view chunk,
+                                     const FrameHandler& onFrame)
+{
+    if (m_state == State::FAILED)
+    {
+        ec = m_error;
+        return 0;
+    }
+
+    StompDelimiterIndex delimiters{chunk};
+    std::size_t frames{0};
+    std::size_t pos{0};
+    ec = StompError::OK;
+    while (pos < chunk.size() && ec == StompError::OK)
+    {
+        switch (m_state)
+        {
+        case State::COMMAND:
+        case State::HEADERS:
+        {
+            // End of lines between frames are heart-beats.
+            if (m_state == State::COMMAND && m_frame.empty() && chunk[pos] == '\n')
+            {
+                ++pos;
+                break;
+            }
+
+            const auto newline{delimiters.Find(StompDelimiter::NEWLINE, pos)};
+            const auto lineEnd{std::min(newline, chunk.size())};
+            if (m_lineColon == std::string::npos)
+            {
+                if (const auto colon{delimiters.Find(StompDelimiter::COLON, pos)};
+                    colon < lineEnd)
+                {
+                    m_lineColon = m_frame.size() + (colon - pos);
+                }
+            }
+            m_frame.append(chunk.substr(pos, lineEnd - pos));
+            pos = lineEnd;
+            if (newline == std::string::npos)
             {
-                allNewline = false;
                 break;
             }
+
+            ++pos;
+            ec = parseLine();
+            m_frame.push_back('\n');
+            m_lineStart = m_frame.size();
+            m_lineColon = std::string::npos;
+            if (ec == StompError::OK && m_state == State::BODY)
+            {
+                m_bodyStart = m_frame.size();
+                if (m_contentLength != std::string::npos)
+                {
+                    // The length comes from the peer: check it against the limit, and only
+                    // trust it up to a point when sizing the string.
+                    if (m_bodyStart >= m_maxFrameSize ||
+                        m_contentLength > m_maxFrameSize - m_bodyStart - 1)
+                    {
+                        ec = StompError::FRAME_TOO_LARGE;
+                        break;
+                    }
+                    m_frame.reserve(m_bodyStart + std::min(m_contentLength, kMaxBodyReserve) + 1);
+                }
+            }
+            break;
+        }
+        case State::BODY:
+        {
+            if (m_contentLength != std::string::npos)
+            {
+                // The body may contain NUL octets, so only its length tells where it ends.
+                const auto bodyEnd{m_bodyStart + m_contentLength};
+                const auto take{std::min(chunk.size() - pos, bodyEnd - m_frame.size())};
+                m_frame.append(chunk.substr(pos, take));
+                pos += take;
+                if (m_frame.size() < bodyEnd || pos == chunk.size())
+                {
+                    break;
+                }
+                if (chunk[pos] != '\0')
+                {
+                    ec = StompError::WRONG_CONTENT_LENGTH;
+                    break;
+                }
+            }
+            else
+            {
+                const auto nul{delimiters.Find(StompDelimiter::NUL, pos)};
+                const auto bodyEnd{std::min(nul, chunk.size())};
+                m_frame.append(chunk.substr(pos, bodyEnd - pos));
+                pos = bodyEnd;
+                if (nul == std::string::npos)
+                {
+                    break;
+                }
+            }
+
+            // Skip the NUL octet.
+            ++pos;
+            ec = completeFrame(onFrame);
+            frames += ec == StompError::OK ? 1 : 0;
+            break;
+        }
+        default:
+            ec = StompError::DEV_ERROR;
+            break;
         }
 
-        if (!allNewline)
+        if (ec == StompError::OK && m_frame.size() >= m_maxFrameSize)
         {
-            ec = StompError::JUNK_AFTER_BODY;
-            return std::string_view{};
+            ec = StompError::FRAME_TOO_LARGE;
         }
     }
 
-    return body;
+    if (ec != StompError::OK)
+    {
+        m_state = State::FAILED;
+        m_error = ec;
+    }
+
+    return frames;
+}
+
+bool StompStreamParser::NeedsMoreData() const
+{
+    return m_state == State::HEADERS || m_state == State::BODY ||
+           (m_state == State::COMMAND && !m_frame.empty());
+}
+
+void StompStreamParser::Reset()
+{
+    m_state = State::COMMAND;
+    m_error = StompError::OK;
+    m_frame.clear();
+    m_lineStart = 0;
+    m_lineColon = std::string::npos;
+    m_command = StompCommand::SIZE_OF_ENUM;
+    m_headers.clear();
+    m_contentLength = std::string::npos;
+    m_bodyStart = 0;
+}
+
+StompError StompStreamParser::parseLine()
+{
+    const std::string_view line{m_frame.data() + m_lineStart, m_frame.size() - m_lineStart};
+    if (m_state == State::COMMAND)
+    {
+        m_command = LookupCommand(line);
+        if (m_command == StompCommand::SIZE_OF_ENUM)
+        {
+            return StompError::UNDEFINED_COMMAND;
+        }
+
+        m_state = State::HEADERS;
+        return StompError::OK;
+    }
+
+    // An empty line ends the headers.
+    if (line.empty())
+    {
+        m_state = State::BODY;
+        return StompError::OK;
+    }
+
+    StompFrame::Header header{};
+    const auto colon{m_lineColon == std::string::npos ? m_lineColon : m_lineColon - m_lineStart};
+    if (auto ec{ParseHeaderLine(line, colon, header)}; ec != StompError::OK)
+    {
+        return ec;
+    }
+
+    // Only the first occurrence of a repeated header counts.
+    if (header.key == StompHeaders::CONTENT_LENGTH && m_contentLength == std::string::npos)
+    {
+        if (auto ec{ParseContentLength(header.value, m_contentLength)}; ec != StompError::OK)
+        {
+            return ec;
+        }
+    }
+
+    m_headers.push_back(HeaderSpan{header.key, m_lineColon + 1, header.value.size()});
+    return StompError::OK;
+}
+
+StompError StompStreamParser::completeFrame(const FrameHandler& onFrame)
+{
+    if (auto ec{CheckRequiredHeaders(m_command, m_headers)}; ec != StompError::OK)
+    {
+        return ec;
+    }
+
+    const auto bodySize{m_frame.size() - m_bodyStart};
+    m_frame.push_back('\0');
+
+    std::vector<StompFrame::Header> headers{};
+    headers.reserve(m_headers.size());
+    for (const auto& header : m_headers)
+    {
+        headers.push_back(StompFrame::Header{
+            header.key, std::string_view{m_frame.data() + header.offset, header.size}});
+    }
+    StompFrame::Body body{m_frame.data() + m_bodyStart, bodySize};
+
+    // The parser is ready for the next frame before the handler runs.
+    StompFrame frame{std::move(m_frame), m_command, std::move(headers), body};
+    Reset();
+    onFrame(std::move(frame));
+    return StompError::OK;
 }
 
 } // namespace NetworkMonitor
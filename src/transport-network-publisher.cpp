@@ -0,0 +1,255 @@
+#include <network-monitor/transport-network-publisher.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace NetworkMonitor
+{
+
+// Smallest block of passenger counters. Blocks are sized with room to spare, so that
+// adding a few stations does not chain a new block every time.
+static constexpr std::size_t kMinPassengerCounts{64};
+
+static std::shared_ptr<PassengerCountBlock> MakeCountBlock(
+    std::size_t size,
+    std::shared_ptr<PassengerCountBlock> previous)
+{
+    auto block{std::make_shared<PassengerCountBlock>()};
+    block->counters.Resize(std::max(size, kMinPassengerCounts));
+    block->previous = std::move(previous);
+    return block;
+}
+
+static std::uint64_t NextPublisherId()
+{
+    // 0 is left to the per-thread caches that have not seen any publisher yet.
+    static std::atomic<std::uint64_t> lastId{0};
+    return ++lastId;
+}
+
+long long int PassengerCountBlock::Get(std::size_t station) const
+{
+    long long int count{0};
+    for (auto block{this}; block != nullptr; block = block->previous.get())
+    {
+        if (station < block->counters.Size())
+        {
+            count += block->counters.Get(station);
+        }
+    }
+    return count;
+}
+
+bool TransportNetworkSnapshot::RecordPassengerEvent(const PassengerEvent& event) const
+{
+    return RecordPassengerEvent(network.GetStationHandle(event.stationId), event.type);
+}
+
+bool TransportNetworkSnapshot::RecordPassengerEvent(StationHandle station,
+                                                    PassengerEvent::Type type) const
+{
+    long long int delta{0};
+    switch (type)
+    {
+    case PassengerEvent::Type::In:
+        delta = 1;
+        break;
+    case PassengerEvent::Type::Out:
+        delta = -1;
+        break;
+    default:
+        return false;
+    }
+
+    // The block of a snapshot always covers all of its stations.
+    if (!network.Contains(station))
+    {
+        return false;
+    }
+    passengerCounts->counters.Add(station.value, delta);
+    return true;
+}
+
+long long int TransportNetworkSnapshot::GetPassengerCount(std::string_view station) const
+{
+    const auto handle{network.GetStationHandle(station)};
+    if (!handle.IsValid())
+    {
+        throw std::runtime_error("Could not find station in the network: " + Id{station});
+    }
+
+    return GetPassengerCount(handle);
+}
+
+long long int TransportNetworkSnapshot::GetPassengerCount(StationHandle station) const
+{
+    if (!network.Contains(station))
+    {
+        throw std::runtime_error("Could not find station in the network: handle " +
+                                 std::to_string(station.value));
+    }
+
+    return passengerCounts->Get(station.value);
+}
+
+TransportNetworkPublisher::TransportNetworkPublisher(TransportNetwork network)
+    : m_id{NextPublisherId()}
+{
+    Publish(std::move(network));
+}
+
+TransportNetworkPublisher::SnapshotPtr TransportNetworkPublisher::Acquire() const
+{
+    return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+}
+
+bool TransportNetworkPublisher::Update(const Mutator& mutator)
+{
+    std::lock_guard<std::mutex> lock{m_writerMutex};
+    return update(mutator);
+}
+
+bool TransportNetworkPublisher::ApplyLayoutDiff(const LayoutDiff& diff)
+{
+    std::lock_guard<std::mutex> lock{m_writerMutex};
+    const auto previous{Acquire()};
+
+    // Resolved before the update, while the removed stations are still in the network.
+    std::vector<StationHandle> removed{};
+    removed.reserve(diff.removedStations.size());
+    for (const auto& station : diff.removedStations)
+    {
+        removed.push_back(previous->network.GetStationHandle(station));
+    }
+
+    if (!update([&diff](auto& network) { return network.ApplyLayoutDiff(diff); }))
+    {
+        return false;
+    }
+
+    const auto snapshot{Acquire()};
+    auto& counts{*snapshot->passengerCounts};
+    const auto reset{[&counts](StationHandle station) {
+        if (station.IsValid())
+        {
+            counts.counters.Add(station.value, -counts.Get(station.value));
+        }
+    }};
+    for (const auto& station : removed)
+    {
+        reset(station);
+    }
+
+    // A station that comes back gets its old handle back, which may still hold the
+    // count it had when it was removed.
+    for (const auto& station : diff.addedStations)
+    {
+        const auto handle{snapshot->network.GetStationHandle(station.id)};
+        if (handle.value < previous->network.GetStationHandleCount() &&
+            !previous->network.Contains(handle))
+        {
+            reset(handle);
+        }
+    }
+    return true;
+}
+
+void TransportNetworkPublisher::Publish(TransportNetwork network)
+{
+    std::lock_guard<std::mutex> lock{m_writerMutex};
+
+    const auto size{network.GetStationHandleCount()};
+    auto counts{MakeCountBlock(2 * size, nullptr)};
+    for (std::size_t station{0}; station < size; ++station)
+    {
+        const StationHandle handle{static_cast<std::uint32_t>(station)};
+        if (network.Contains(handle))
+        {
+            counts->counters.Add(station, network.GetPassengerCount(handle));
+        }
+    }
+    publish(std::move(network), std::move(counts));
+}
+
+bool TransportNetworkPublisher::update(const Mutator& mutator)
+{
+    // Only writers replace m_current, and they are serialised by m_writerMutex, so the
+    // snapshot we copy from cannot go stale before we publish.
+    const auto snapshot{Acquire()};
+    TransportNetwork network{snapshot->network};
+    if (!mutator(network))
+    {
+        return false;
+    }
+
+    // Stations keep their handles across updates, so the counts carry over as they are.
+    // The block is only replaced when the new stations do not fit in it.
+    auto counts{snapshot->passengerCounts};
+    const auto size{network.GetStationHandleCount()};
+    if (size > counts->counters.Size())
+    {
+        counts = MakeCountBlock(std::max(size, 2 * counts->counters.Size()), counts);
+    }
+    publish(std::move(network), std::move(counts));
+    return true;
+}
+
+bool TransportNetworkPublisher::RecordPassengerEvent(const PassengerEvent& event) const
+{
+    return current().RecordPassengerEvent(event);
+}
+
+bool TransportNetworkPublisher::RecordPassengerEvent(StationHandle station,
+                                                     PassengerEvent::Type type) const
+{
+    return current().RecordPassengerEvent(station, type);
+}
+
+long long int TransportNetworkPublisher::GetPassengerCount(std::string_view station) const
+{
+    return current().GetPassengerCount(station);
+}
+
+long long int TransportNetworkPublisher::GetPassengerCount(StationHandle station) const
+{
+    return current().GetPassengerCount(station);
+}
+
+const TransportNetworkSnapshot& TransportNetworkPublisher::current() const
+{
+    struct Cache
+    {
+        std::uint64_t publisher{0};
+        std::uint64_t version{0};
+        SnapshotPtr snapshot{};
+    };
+    thread_local Cache cache{};
+
+    const auto version{m_version.load(std::memory_order_acquire)};
+    if (cache.publisher != m_id || cache.version != version)
+    {
+        cache.snapshot = Acquire();
+        cache.publisher = m_id;
+        cache.version = cache.snapshot->version;
+    }
+    return *cache.snapshot;
+}
+
+void TransportNetworkPublisher::publish(TransportNetwork&& network,
+                                        std::shared_ptr<PassengerCountBlock> counts)
+{
+    const auto previous{Acquire()};
+    const auto version{previous == nullptr ? 0 : previous->version + 1};
+    std::atomic_store_explicit(
+        &m_current,
+        std::shared_ptr<const TransportNetworkSnapshot>{std::make_shared<TransportNetworkSnapshot>(
+            TransportNetworkSnapshot{version, std::move(network), std::move(counts)})},
+        std::memory_order_release);
+    m_version.store(version, std::memory_order_release);
+}
+
+} // namespace NetworkMonitor
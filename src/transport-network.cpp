@@ -1,20 +1,145 @@
 #include <network-monitor/transport-network.h>
 
+#include <network-monitor/mapped-file.h>
+
+#include <boost/assert.hpp>
+
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <set>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
 
 namespace NetworkMonitor
 {
 
-std::vector<TransportNetwork::GraphEdge>::const_iterator
-TransportNetwork::GraphNode::FindEdgeForRoute(const std::shared_ptr<RouteInternal>& route)
+namespace
+{
+
+std::uint64_t EdgeKey(std::uint32_t from, std::uint32_t to)
+{
+    return (static_cast<std::uint64_t>(from) << 32) | to;
+}
+
+// Room given to an edge row the first time it grows.
+constexpr std::uint32_t kMinEdgeRowCapacity{4};
+
+// Gaps and spare room in the edge array are only squeezed out past this size.
+constexpr std::size_t kMinSpareEdges{1024};
+
+// Search buffers used by the queries that do not take caller-owned ones.
+PathSearchState& ThreadPathSearchState()
+{
+    thread_local PathSearchState state{};
+    return state;
+}
+
+JourneySearchState& ThreadJourneySearchState()
+{
+    thread_local JourneySearchState state{};
+    return state;
+}
+
+} // namespace
+
+const TransportNetwork::GraphEdge* TransportNetwork::EdgeRange::begin() const
+{
+    return first;
+}
+
+const TransportNetwork::GraphEdge* TransportNetwork::EdgeRange::end() const
+{
+    return last;
+}
+
+TransportNetwork::GraphNode::GraphNode(const allocator_type& allocator) : routes{allocator}
+{
+}
+
+TransportNetwork::GraphNode::GraphNode(const Name& name, const allocator_type& allocator)
+    : name{name}, routes{allocator}
+{
+}
+
+TransportNetwork::GraphNode::GraphNode(const GraphNode& other, const allocator_type& allocator)
+    : name{other.name}, routes{other.routes, allocator}, removed{other.removed}
+{
+}
+
+TransportNetwork::GraphNode::GraphNode(GraphNode&& other, const allocator_type& allocator)
+    : name{std::move(other.name)}, routes{std::move(other.routes), allocator},
+      removed{other.removed}
 {
-    return std::find_if(std::begin(edges), std::end(edges), [&route](const auto& edge) {
-        return edge.route == route;
-    });
 }
 
-TransportNetwork::TransportNetwork() = default;
+TransportNetwork::RouteInternal::RouteInternal(const allocator_type& allocator)
+    : stops{allocator}, cumulativeTimes{allocator}, positions{allocator}
+{
+}
+
+TransportNetwork::RouteInternal::RouteInternal(const Id& id,
+                                               const Name& name,
+                                               Index line,
+                                               const allocator_type& allocator)
+    : id{id}, name{name}, line{line}, stops{allocator}, cumulativeTimes{allocator},
+      positions{allocator}
+{
+}
+
+TransportNetwork::RouteInternal::RouteInternal(const RouteInternal& other,
+                                               const allocator_type& allocator)
+    : id{other.id}, name{other.name}, line{other.line}, stops{other.stops, allocator},
+      cumulativeTimes{other.cumulativeTimes, allocator}, positions{other.positions, allocator},
+      removed{other.removed}
+{
+}
+
+TransportNetwork::RouteInternal::RouteInternal(RouteInternal&& other,
+                                               const allocator_type& allocator)
+    : id{std::move(other.id)}, name{std::move(other.name)}, line{other.line},
+      stops{std::move(other.stops), allocator},
+      cumulativeTimes{std::move(other.cumulativeTimes), allocator},
+      positions{std::move(other.positions), allocator}, removed{other.removed}
+{
+}
+
+TransportNetwork::LineInternal::LineInternal(const allocator_type& allocator) : routes{allocator}
+{
+}
+
+TransportNetwork::LineInternal::LineInternal(const Name& name, const allocator_type& allocator)
+    : name{name}, routes{allocator}
+{
+}
+
+TransportNetwork::LineInternal::LineInternal(const LineInternal& other,
+                                             const allocator_type& allocator)
+    : name{other.name}, routes{other.routes, allocator}, removed{other.removed}
+{
+}
+
+TransportNetwork::LineInternal::LineInternal(LineInternal&& other, const allocator_type& allocator)
+    : name{std::move(other.name)}, routes{std::move(other.routes), allocator},
+      removed{other.removed}
+{
+}
+
+TransportNetwork::TransportNetwork() : TransportNetwork{std::pmr::get_default_resource()}
+{
+}
+
+TransportNetwork::TransportNetwork(std::pmr::memory_resource* resource)
+    : m_stations{resource}, m_routes{resource}, m_lines{resource},
+      m_edgeRows{resource}, m_edges{resource}
+{
+}
 
 TransportNetwork::TransportNetwork(const TransportNetwork& copied) = default;
 
@@ -26,341 +151,2343 @@ TransportNetwork& TransportNetwork::operator=(TransportNetwork&& moved) = defaul
 
 bool TransportNetwork::AddStation(const Station& station)
 {
-    if (getStation(station.id) != nullptr)
+    if (getStation(station.id) != kInvalidIndex)
     {
         return false;
     }
 
-    auto node{std::make_shared<GraphNode>(GraphNode{station.id, station.name, 0, {}})};
-    m_stations.emplace(node->id, std::move(node));
+    // A station that was removed gets its old slot back.
+    const auto stationIndex{m_stationIds.Intern(station.id)};
+    if (stationIndex < m_stations.size())
+    {
+        m_stations[stationIndex] = GraphNode{station.name, m_stations.get_allocator()};
+        m_busiestStations.SetRanked(stationIndex, true);
+        ++m_revision;
+        return true;
+    }
+
+    m_stations.emplace_back(station.name);
+    m_passengerCounts.Resize(m_stations.size());
+    m_passengerStatistics.Resize(m_stations.size());
+    m_busiestStations.Resize(m_stations.size());
+
+    // A new station has no outgoing edges yet: its row in the CSR is empty.
+    m_edgeRows.emplace_back();
+    ++m_revision;
     return true;
 }
 
 bool TransportNetwork::AddLine(const Line& line)
 {
-    if (getLine(line.id) != nullptr)
+    std::vector<std::pair<Index, GraphEdge>> newEdges{};
+    if (!addLine(line, newEdges))
     {
         return false;
     }
 
-    auto lineInternal{std::make_shared<LineInternal>(LineInternal{line.id, line.name, {}})};
-    for (const auto& route : line.routes)
-    {
-        if (!addRouteToLine(route, lineInternal))
-        {
-            return false;
-        }
-    }
-
-    m_lines.emplace(lineInternal->id, lineInternal);
-
+    insertEdges(newEdges);
+    ++m_revision;
     return true;
 }
 
-bool TransportNetwork::RecordPassengerEvent(const PassengerEvent& event)
+std::size_t TransportNetwork::AddLines(const std::vector<Line>& lines)
 {
-    const auto node{getStation(event.stationId)};
-    if (node == nullptr)
+    // Edges of the lines added before a failing one are kept.
+    std::vector<std::pair<Index, GraphEdge>> newEdges{};
+    std::size_t added{0};
+    while (added < lines.size() && addLine(lines[added], newEdges))
     {
-        return false;
+        ++added;
     }
 
-    switch (event.type)
+    if (added > 0)
     {
-    case PassengerEvent::Type::In:
-        node->passengerCount++;
-        return true;
-    case PassengerEvent::Type::Out:
-        node->passengerCount--;
-        return true;
-    default:
-        return false;
-    };
+        insertEdges(newEdges);
+        ++m_revision;
+    }
+    return added;
 }
 
-long long int TransportNetwork::GetPassengerCount(const Id& station) const
+bool TransportNetwork::addLine(const Line& line,
+                               std::vector<std::pair<Index, GraphEdge>>& newEdges)
 {
-    const auto node{getStation(station)};
-    if (nullptr == node)
+    if (getLine(line.id) != kInvalidIndex)
     {
-        throw std::runtime_error("Could not find station in the network: " + station);
+        return false;
     }
 
-    return node->passengerCount;
-}
-
-std::vector<Id> TransportNetwork::GetRoutesServingStation(const Id& station) const
-{
-    const auto node{getStation(station)};
-    if (nullptr == node)
+    // Validate the whole line before touching the graph, so that a bad route does not
+    // leave a half-inserted line behind.
+    std::unordered_map<Id, bool> seenRoutes{};
+    for (const auto& route : line.routes)
     {
-        throw std::runtime_error("Could not find station in the network: " + station);
+        if (!seenRoutes.emplace(route.id, true).second)
+        {
+            return false;
+        }
+
+        for (const auto& stop : route.stops)
+        {
+            if (getStation(stop) == kInvalidIndex)
+            {
+                return false;
+            }
+        }
     }
 
-    const auto& edges{node->edges};
-    std::vector<Id> routes{};
-    routes.reserve(edges.size());
-    const auto size = edges.size();
-    for (const auto& edge : edges)
+    // A line that was removed gets its old slot back.
+    const auto lineIndex{m_lineIds.Intern(line.id)};
+    if (lineIndex < m_lines.size())
+    {
+        m_lines[lineIndex] = LineInternal{line.name, m_lines.get_allocator()};
+    }
+    else
     {
-        routes.push_back(edge.route->id);
+        m_lines.emplace_back(line.name);
     }
 
-    // FIXME: In the worst case, we are iterating over all routes
-    // for all lines in the network. We may want to optimize this.
-    for (const auto& [_, line] : m_lines)
+    for (const auto& route : line.routes)
     {
-        for (const auto& [_, route] : line->routes)
+        if (!addRouteToLine(route, lineIndex, newEdges))
         {
-            const auto endStop{route->stops.back()};
-            if (endStop == node)
-            {
-                routes.push_back(route->id);
-            }
+            return false;
         }
     }
 
-    return routes;
+    return true;
 }
 
-bool TransportNetwork::SetTravelTime(const Id& stationA,
-                                     const Id& stationB,
-                                     const unsigned int travelTime)
+bool TransportNetwork::ApplyLayoutDiff(const LayoutDiff& diff)
 {
-    const auto stationANode{getStation(stationA)};
-    const auto stationBNode{getStation(stationB)};
-    if (stationANode == nullptr || stationBNode == nullptr)
+    // Validate the structural changes first, so that a bad diff leaves no trace.
+    std::unordered_set<Id> addedStations{};
+    for (const auto& station : diff.addedStations)
     {
-        return false;
+        if (getStation(station.id) != kInvalidIndex || !addedStations.insert(station.id).second)
+        {
+            return false;
+        }
+    }
+    std::unordered_set<Index> removedStations{};
+    for (const auto& id : diff.removedStations)
+    {
+        const auto station{getStation(id)};
+        if (station == kInvalidIndex || !removedStations.insert(station).second)
+        {
+            return false;
+        }
+    }
+    for (const auto& station : diff.modifiedStations)
+    {
+        const auto index{getStation(station.id)};
+        if (index == kInvalidIndex || removedStations.count(index) > 0)
+        {
+            return false;
+        }
     }
 
-    bool foundAnyEdge{false};
-    auto setTravelTime{[&foundAnyEdge, &travelTime](auto from, auto to) {
-        for (auto& edge : from->edges)
+    // Stations the routes can stop at once the diff is applied.
+    auto resolveStops{[this, &addedStations, &removedStations](const Route& route,
+                                                               std::vector<Index>* stops) {
+        for (const auto& stop : route.stops)
         {
-            if (edge.nextStop == to)
+            const auto station{getStation(stop)};
+            const auto exists{station != kInvalidIndex ? removedStations.count(station) == 0
+                                                       : addedStations.count(stop) > 0};
+            if (!exists)
             {
-                edge.travelTime = travelTime;
-                foundAnyEdge = true;
+                return false;
+            }
+            if (stops != nullptr)
+            {
+                stops->push_back(station);
             }
         }
+        return true;
     }};
 
-    setTravelTime(stationANode, stationBNode);
-    setTravelTime(stationBNode, stationANode);
-
-    return foundAnyEdge;
-}
-
-unsigned int TransportNetwork::GetTravelTime(const Id& stationA, const Id& stationB)
-{
-    if (stationA == stationB)
+    std::vector<bool> changedRoutes(m_routes.size(), false);
+    std::vector<bool> isDropped(m_routes.size(), false);
+    std::vector<Index> droppedRoutes{};
+    std::unordered_set<Index> removedLines{};
+    for (const auto& id : diff.removedLines)
     {
-        return 0;
+        const auto line{getLine(id)};
+        if (line == kInvalidIndex || !removedLines.insert(line).second)
+        {
+            return false;
+        }
+        for (const auto& [_, route] : m_lines[line].routes)
+        {
+            changedRoutes[route] = true;
+            isDropped[route] = true;
+            droppedRoutes.push_back(route);
+        }
     }
-
-    const auto stationANode{getStation(stationA)};
-    const auto stationBNode{getStation(stationB)};
-    if (stationANode == nullptr || stationBNode == nullptr)
+    for (const auto& [lineId, routeId] : diff.removedRoutes)
     {
-        return 0;
+        const auto route{getRoute(lineId, routeId)};
+        if (route == kInvalidIndex || changedRoutes[route])
+        {
+            return false;
+        }
+        changedRoutes[route] = true;
+        isDropped[route] = true;
+        droppedRoutes.push_back(route);
+    }
+    std::vector<Index> modifiedRoutes{};
+    for (const auto& route : diff.modifiedRoutes)
+    {
+        const auto index{getRoute(route.lineId, route.id)};
+        if (index == kInvalidIndex || changedRoutes[index] || !resolveStops(route, nullptr))
+        {
+            return false;
+        }
+        changedRoutes[index] = true;
+        modifiedRoutes.push_back(index);
     }
 
-    for (const auto& edge : stationANode->edges)
+    std::unordered_set<Id> addedLines{};
+    for (const auto& line : diff.addedLines)
     {
-        if (edge.nextStop == stationBNode)
+        if (getLine(line.id) != kInvalidIndex || !addedLines.insert(line.id).second)
         {
-            return edge.travelTime;
+            return false;
+        }
+        std::unordered_set<Id> routes{};
+        for (const auto& route : line.routes)
+        {
+            if (!routes.insert(route.id).second || !resolveStops(route, nullptr))
+            {
+                return false;
+            }
+        }
+    }
+    std::unordered_map<Index, std::unordered_set<Id>> addedRoutes{};
+    for (const auto& route : diff.addedRoutes)
+    {
+        const auto line{getLine(route.lineId)};
+        if (line == kInvalidIndex || removedLines.count(line) > 0 ||
+            !resolveStops(route, nullptr) || !addedRoutes[line].insert(route.id).second)
+        {
+            return false;
+        }
+        // An id can only be reused once its route is dropped: a route that is modified
+        // by the same diff keeps its id.
+        const auto existing{getRoute(route.lineId, route.id)};
+        if (existing != kInvalidIndex && !isDropped[existing])
+        {
+            return false;
         }
     }
 
-    for (const auto& edge : stationBNode->edges)
+    // A station can only go once no route stops there any more.
+    for (const auto station : removedStations)
     {
-        if (edge.nextStop == stationANode)
+        for (const auto& route : m_stations[station].routes)
         {
-            return edge.travelTime;
+            if (!changedRoutes[route.value])
+            {
+                return false;
+            }
         }
     }
 
-    return 0;
-}
+    // Apply the changes. Validation ruled out every way they could fail. Edges of dropped
+    // and modified routes leave from their old stops: only the rows of those stations
+    // lose edges.
+    std::vector<Index> affectedStations{};
+    for (const auto route : droppedRoutes)
+    {
+        const auto& stops{m_routes[route].stops};
+        affectedStations.insert(affectedStations.end(), stops.begin(), stops.end());
+    }
+    for (const auto route : modifiedRoutes)
+    {
+        const auto& stops{m_routes[route].stops};
+        affectedStations.insert(affectedStations.end(), stops.begin(), stops.end());
+    }
+    std::sort(affectedStations.begin(), affectedStations.end());
+    affectedStations.erase(std::unique(affectedStations.begin(), affectedStations.end()),
+                           affectedStations.end());
 
-unsigned int TransportNetwork::GetTravelTime(const Id& line,
-                                             const Id& route,
-                                             const Id& stationA,
-                                             const Id& stationB)
-{
-    auto routeInternal{getRoute(line, route)};
-    if (routeInternal == nullptr)
+    for (const auto& station : diff.addedStations)
     {
-        return 0;
+        AddStation(station);
+    }
+    for (const auto& station : diff.modifiedStations)
+    {
+        m_stations[getStation(station.id)].name = station.name;
     }
 
-    const auto& stationANode{getStation(stationA)};
-    const auto& stationBNode{getStation(stationB)};
-    if (stationANode == nullptr || stationBNode == nullptr)
+    for (const auto route : droppedRoutes)
     {
-        return 0;
+        clearRouteStops(route);
+        auto& routeInternal{m_routes[route]};
+        routeInternal.removed = true;
+        m_lines[routeInternal.line].routes.erase(routeInternal.id);
+    }
+    for (const auto line : removedLines)
+    {
+        m_lines[line].removed = true;
+    }
+
+    std::vector<std::pair<Index, GraphEdge>> newEdges{};
+    for (std::size_t idx{0}; idx < modifiedRoutes.size(); ++idx)
+    {
+        std::vector<Index> stops{};
+        resolveStops(diff.modifiedRoutes[idx], &stops);
+        clearRouteStops(modifiedRoutes[idx]);
+        setRouteStops(modifiedRoutes[idx], stops, newEdges);
     }
 
-    unsigned int travelTime{0};
-    bool found{false};
-    for (const auto& stop : routeInternal->stops)
+    // New routes always get new slots: a route id that comes back is a new route.
+    const auto firstNewRoute{static_cast<Index>(m_routes.size())};
+    for (const auto& line : diff.addedLines)
     {
-        if (stop == stationANode)
+        const auto lineIndex{m_lineIds.Intern(line.id)};
+        if (lineIndex < m_lines.size())
         {
-            found = true;
+            m_lines[lineIndex] = LineInternal{line.name, m_lines.get_allocator()};
         }
-
-        if (stop == stationBNode)
+        else
         {
-            return travelTime;
+            m_lines.emplace_back(line.name);
         }
-
-        if (found)
+        for (const auto& route : line.routes)
         {
-            auto edgeIt{stop->FindEdgeForRoute(routeInternal)};
-            if (edgeIt == stop->edges.end())
-            {
-                return 0;
-            }
-
-            travelTime += edgeIt->travelTime;
+            [[maybe_unused]] const auto added{addRouteToLine(route, lineIndex, newEdges)};
+            BOOST_ASSERT(added);
         }
     }
+    for (const auto& route : diff.addedRoutes)
+    {
+        [[maybe_unused]] const auto added{
+            addRouteToLine(route, getLine(route.lineId), newEdges)};
+        BOOST_ASSERT(added);
+    }
 
-    return travelTime;
-}
+    for (const auto station : removedStations)
+    {
+        m_stations[station].removed = true;
+        m_passengerCounts.Add(station, -m_passengerCounts.Get(station));
+        m_passengerStatistics.Clear(station);
+        m_busiestStations.SetRanked(station, false);
+    }
 
-bool TransportNetwork::FromJson(nlohmann::json&& src)
-{
-    bool ok{true};
-    for (const auto& lineJson : src["lines"])
+    // Remember the travel times of the edges about to go, for the routes that replace
+    // them.
+    std::unordered_map<std::uint64_t, unsigned int> previousTimes{};
+    for (const auto station : affectedStations)
     {
-        auto line{Line{std::move(lineJson["line_id"].get<std::string>()),
-                       std::move(lineJson["name"].get<std::string>())}};
-        for (const auto& routeJson : lineJson["routes"])
+        for (const auto& edge : edgesOf(station))
         {
-            auto route{Route{std::move(routeJson["route_id"].get<std::string>()),
-                             std::move(routeJson["line_id"].get<std::string>()),
-                             std::move(routeJson["start_station_id"].get<std::string>()),
-                             std::move(routeJson["end_station_id"].get<std::string>())}};
-
-            for (const auto& stop : routeJson["route_stops"])
+            if (changedRoutes[edge.route])
             {
-                route.stops.emplace_back(stop);
+                previousTimes[EdgeKey(station, edge.nextStop)] = edge.travelTime;
             }
-
-            line.routes.emplace_back(std::move(route));
-        }
-
-        ok &= AddLine(line);
-        if (!ok)
-        {
-            throw std::runtime_error("Could not add line " + line.id);
         }
     }
+    removeEdges(affectedStations, changedRoutes);
+    insertEdges(newEdges);
 
-    for (const auto& stationJson : src["stations"])
+    changedRoutes.resize(m_routes.size(), true);
+    for (const auto route : modifiedRoutes)
     {
-        Station station{std::move(stationJson["station_id"].get<std::string>()),
-                        std::move(stationJson["name"].get<std::string>())};
-        ok &= AddStation(station);
-        if (!ok)
-        {
-            throw std::runtime_error("Could not add station " + station.id);
-        }
+        inheritTravelTimes(route, changedRoutes, previousTimes);
     }
-
-    for (const auto& travelTimeJson : src["travel_times"])
+    for (auto route{firstNewRoute}; route < m_routes.size(); ++route)
     {
-        ok &= SetTravelTime(std::move(travelTimeJson["start_station_id"].get<std::string>()),
-                            std::move(travelTimeJson["end_station_id"].get<std::string>()),
-                            std::move(travelTimeJson["travel_time"].get<unsigned int>()));
+        inheritTravelTimes(route, changedRoutes, previousTimes);
     }
+    ++m_revision;
 
+    bool ok{true};
+    for (const auto& travelTime : diff.travelTimes)
+    {
+        ok &= SetTravelTime(travelTime.stationA, travelTime.stationB, travelTime.travelTime);
+    }
     return ok;
 }
 
-std::shared_ptr<TransportNetwork::GraphNode> TransportNetwork::getStation(const Id& id) const
+bool TransportNetwork::RecordPassengerEvent(const PassengerEvent& event)
 {
-    auto itStation = m_stations.find(id);
-    return (itStation != m_stations.end() ? itStation->second : nullptr);
+    return recordPassengerEvent(getStation(event.stationId), event.type, event.timestamp);
 }
 
-std::shared_ptr<TransportNetwork::LineInternal> TransportNetwork::getLine(const Id& id) const
+std::vector<std::size_t>
+TransportNetwork::RecordPassengerEvents(const std::vector<PassengerEvent>& events)
 {
-    auto itLine = m_lines.find(id);
-    return (itLine != m_lines.end() ? itLine->second : nullptr);
+    std::vector<StationHandle> changedStations{};
+    return RecordPassengerEvents(events, changedStations);
 }
 
-bool TransportNetwork::addRouteToLine(
-    const Route& route,
-    const std::shared_ptr<TransportNetwork::LineInternal>& lineInternal)
+std::vector<std::size_t>
+TransportNetwork::RecordPassengerEvents(const std::vector<PassengerEvent>& events,
+                                        std::vector<StationHandle>& changedStations)
 {
-    if (lineInternal->routes.find(route.id) != lineInternal->routes.end())
-    {
-        return false;
-    }
+    changedStations.clear();
+    std::vector<std::size_t> failed{};
+    std::vector<std::pair<Index, long long int>> deltas{};
+    deltas.reserve(events.size());
 
-    std::vector<std::shared_ptr<GraphNode>> stops{};
-    stops.reserve(route.stops.size());
-    for (const auto& stop : route.stops)
+    // Resolve all ids first. Consecutive events for the same station are common in a
+    // burst, so we only hash an id when it differs from the previous one.
+    const Id* lastId{nullptr};
+    Index lastStation{kInvalidIndex};
+    std::optional<std::chrono::system_clock::time_point> now{};
+    for (std::size_t idx{0}; idx < events.size(); ++idx)
     {
-        const auto& station{getStation(stop)};
-        if (station == nullptr)
+        const auto& event{events[idx]};
+        if (lastId == nullptr || *lastId != event.stationId)
         {
-            return false;
+            lastId = &event.stationId;
+            lastStation = getStation(event.stationId);
         }
 
-        stops.push_back(station);
-    }
+        if (lastStation == kInvalidIndex)
+        {
+            failed.push_back(idx);
+            continue;
+        }
+
+        switch (event.type)
+        {
+        case PassengerEvent::Type::In:
+            deltas.emplace_back(lastStation, 1);
+            break;
+        case PassengerEvent::Type::Out:
+            deltas.emplace_back(lastStation, -1);
+            break;
+        default:
+            failed.push_back(idx);
+            continue;
+        }
 
-    auto routeInternal{std::make_shared<RouteInternal>(
-        RouteInternal{route.id, route.name, lineInternal, std::move(stops)})};
+        // Statistics keep the ins and outs apart, so they are recorded event by event.
+        if (m_passengerStatistics.IsEnabled())
+        {
+            if (!event.timestamp.has_value() && !now.has_value())
+            {
+                now = std::chrono::system_clock::now();
+            }
+            const auto isIn{event.type == PassengerEvent::Type::In};
+            m_passengerStatistics.Add(lastStation,
+                                      event.timestamp ? *event.timestamp : *now,
+                                      isIn ? 1 : 0,
+                                      isIn ? 0 : 1);
+        }
+    }
 
-    for (size_t idx{0}; idx < routeInternal->stops.size() - 1; ++idx)
+    // Group by station and apply the net change of each station once.
+    std::sort(std::begin(deltas), std::end(deltas), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    for (auto it{deltas.cbegin()}; it != deltas.cend();)
     {
-        const auto& thisStop{routeInternal->stops[idx]};
-        const auto& nextStop{routeInternal->stops[idx + 1]};
-        GraphEdge edge{routeInternal, nextStop, 0};
+        const auto station{it->first};
+        long long int delta{0};
+        for (; it != deltas.cend() && it->first == station; ++it)
+        {
+            delta += it->second;
+        }
 
-        thisStop->edges.emplace_back(std::move(edge));
+        if (delta != 0)
+        {
+            m_passengerCounts.Add(station, delta);
+            m_busiestStations.MarkChanged(station);
+            changedStations.push_back(StationHandle{station});
+        }
     }
 
-    lineInternal->routes[route.id] = std::move(routeInternal);
-
-    return true;
+    return failed;
 }
 
-std::shared_ptr<TransportNetwork::LineInternal> TransportNetwork::getLine(const Id& lineId)
+long long int TransportNetwork::GetPassengerCount(std::string_view station) const
 {
-    auto lineIt = m_lines.find(lineId);
-    if (lineIt == m_lines.end())
+    const auto handle{GetStationHandle(station)};
+    if (!handle.IsValid())
     {
-        return nullptr;
+        throw std::runtime_error("Could not find station in the network: " + Id{station});
     }
 
-    return lineIt->second;
+    return GetPassengerCount(handle);
 }
 
-std::shared_ptr<TransportNetwork::RouteInternal> TransportNetwork::getRoute(const Id& lineId,
-                                                                            const Id& routeId)
+std::vector<Id> TransportNetwork::GetRoutesServingStation(std::string_view station) const
 {
-    auto line{getLine(lineId)};
-    if (!line)
+    const auto handle{GetStationHandle(station)};
+    if (!handle.IsValid())
     {
-        return nullptr;
+        throw std::runtime_error("Could not find station in the network: " + Id{station});
     }
 
-    const auto& routes{line->routes};
-    auto routeIt = routes.find(routeId);
-    if (routeIt == routes.end())
+    const auto& routeHandles{GetRoutesServingStation(handle)};
+    std::vector<Id> routes{};
+    routes.reserve(routeHandles.size());
+    for (const auto route : routeHandles)
     {
-        return nullptr;
+        routes.push_back(GetId(route));
     }
 
-    return routeIt->second;
+    return routes;
+}
+
+bool TransportNetwork::SetTravelTime(std::string_view stationA,
+                                     std::string_view stationB,
+                                     const unsigned int travelTime)
+{
+    return SetTravelTime(GetStationHandle(stationA), GetStationHandle(stationB), travelTime);
+}
+
+unsigned int TransportNetwork::GetTravelTime(std::string_view stationA,
+                                             std::string_view stationB) const
+{
+    if (stationA == stationB)
+    {
+        return 0;
+    }
+
+    return GetTravelTime(GetStationHandle(stationA), GetStationHandle(stationB));
+}
+
+unsigned int TransportNetwork::GetTravelTime(const Id& line,
+                                             const Id& route,
+                                             const Id& stationA,
+                                             const Id& stationB) const
+{
+    return GetTravelTime(
+        GetRouteHandle(line, route), GetStationHandle(stationA), GetStationHandle(stationB));
+}
+
+StationHandle TransportNetwork::GetStationHandle(std::string_view station) const
+{
+    return StationHandle{getStation(station)};
+}
+
+bool TransportNetwork::Contains(StationHandle station) const
+{
+    return getStation(station) != kInvalidIndex;
+}
+
+std::size_t TransportNetwork::GetStationHandleCount() const
+{
+    return m_stations.size();
+}
+
+LineHandle TransportNetwork::GetLineHandle(std::string_view line) const
+{
+    return LineHandle{getLine(line)};
+}
+
+RouteHandle TransportNetwork::GetRouteHandle(const Id& line, const Id& route) const
+{
+    return RouteHandle{getRoute(line, route)};
+}
+
+const Id& TransportNetwork::GetId(StationHandle station) const
+{
+    return m_stationIds.Resolve(station.value);
+}
+
+const Id& TransportNetwork::GetId(LineHandle line) const
+{
+    return m_lineIds.Resolve(line.value);
+}
+
+const Id& TransportNetwork::GetId(RouteHandle route) const
+{
+    return m_routes[route.value].id;
+}
+
+bool TransportNetwork::RecordPassengerEvent(StationHandle station, PassengerEvent::Type type)
+{
+    return recordPassengerEvent(getStation(station), type, std::nullopt);
+}
+
+bool TransportNetwork::RecordPassengerEvent(StationHandle station,
+                                            PassengerEvent::Type type,
+                                            std::chrono::system_clock::time_point timestamp)
+{
+    return recordPassengerEvent(getStation(station), type, timestamp);
+}
+
+long long int TransportNetwork::GetPassengerCount(StationHandle station) const
+{
+    const auto index{getStation(station)};
+    if (kInvalidIndex == index)
+    {
+        throw std::runtime_error("Could not find station in the network: handle " +
+                                 std::to_string(station.value));
+    }
+
+    return m_passengerCounts.Get(index);
+}
+
+std::vector<StationCount> TransportNetwork::GetBusiestStations(std::size_t k) const
+{
+    const auto top{m_busiestStations.Top(k, m_passengerCounts)};
+    std::vector<StationCount> stations{};
+    stations.reserve(top.size());
+    for (const auto& [station, count] : top)
+    {
+        stations.push_back(StationCount{StationHandle{static_cast<Index>(station)}, count});
+    }
+
+    return stations;
+}
+
+void TransportNetwork::EnablePassengerStatistics(const PassengerStatisticsOptions& options)
+{
+    m_passengerStatistics = PassengerStatistics{options};
+    m_passengerStatistics.Resize(m_stations.size());
+}
+
+PassengerFlow TransportNetwork::GetPassengerFlow(StationHandle station,
+                                                 std::chrono::system_clock::time_point from,
+                                                 std::chrono::system_clock::time_point to) const
+{
+    const auto index{getStation(station)};
+    if (kInvalidIndex == index)
+    {
+        throw std::runtime_error("Could not find station in the network: handle " +
+                                 std::to_string(station.value));
+    }
+
+    return m_passengerStatistics.GetFlow(index, from, to);
+}
+
+std::optional<PassengerWindow>
+TransportNetwork::GetBusiestWindow(StationHandle station,
+                                   std::chrono::minutes length,
+                                   std::chrono::system_clock::time_point from,
+                                   std::chrono::system_clock::time_point to) const
+{
+    const auto index{getStation(station)};
+    if (kInvalidIndex == index)
+    {
+        throw std::runtime_error("Could not find station in the network: handle " +
+                                 std::to_string(station.value));
+    }
+
+    return m_passengerStatistics.GetBusiestWindow(index, length, from, to);
+}
+
+const std::pmr::vector<RouteHandle>&
+TransportNetwork::GetRoutesServingStation(StationHandle station) const
+{
+    const auto index{getStation(station)};
+    if (kInvalidIndex == index)
+    {
+        throw std::runtime_error("Could not find station in the network: handle " +
+                                 std::to_string(station.value));
+    }
+
+    return m_stations[index].routes;
+}
+
+bool TransportNetwork::SetTravelTime(StationHandle stationA,
+                                     StationHandle stationB,
+                                     const unsigned int travelTime)
+{
+    const auto stationAIndex{getStation(stationA)};
+    const auto stationBIndex{getStation(stationB)};
+    if (stationAIndex == kInvalidIndex || stationBIndex == kInvalidIndex)
+    {
+        return false;
+    }
+
+    bool foundAnyEdge{false};
+    auto setTravelTime{[this, &foundAnyEdge, &travelTime](Index from, Index to) {
+        const auto& row{m_edgeRows[from]};
+        for (auto idx{row.first}; idx < row.first + row.size; ++idx)
+        {
+            auto& edge{m_edges[idx]};
+            if (edge.nextStop == to)
+            {
+                // Shift the cumulative times of the stops after this edge. Unsigned
+                // wrap-around makes this correct for negative changes as well.
+                const auto delta{travelTime - edge.travelTime};
+                auto& cumulativeTimes{m_routes[edge.route].cumulativeTimes};
+                for (auto stop{edge.stopIndex + 1}; stop < cumulativeTimes.size(); ++stop)
+                {
+                    cumulativeTimes[stop] += delta;
+                }
+
+                edge.travelTime = travelTime;
+                foundAnyEdge = true;
+            }
+        }
+    }};
+
+    setTravelTime(stationAIndex, stationBIndex);
+    setTravelTime(stationBIndex, stationAIndex);
+
+    if (foundAnyEdge)
+    {
+        ++m_revision;
+    }
+
+    return foundAnyEdge;
+}
+
+unsigned int TransportNetwork::GetTravelTime(StationHandle stationA, StationHandle stationB) const
+{
+    const auto stationAIndex{getStation(stationA)};
+    const auto stationBIndex{getStation(stationB)};
+    if (stationAIndex == kInvalidIndex || stationBIndex == kInvalidIndex ||
+        stationAIndex == stationBIndex)
+    {
+        return 0;
+    }
+
+    for (const auto& edge : edgesOf(stationAIndex))
+    {
+        if (edge.nextStop == stationBIndex)
+        {
+            return edge.travelTime;
+        }
+    }
+
+    for (const auto& edge : edgesOf(stationBIndex))
+    {
+        if (edge.nextStop == stationAIndex)
+        {
+            return edge.travelTime;
+        }
+    }
+
+    return 0;
+}
+
+unsigned int TransportNetwork::GetTravelTime(RouteHandle route,
+                                             StationHandle stationA,
+                                             StationHandle stationB) const
+{
+    if (!route.IsValid() || route.value >= m_routes.size())
+    {
+        return 0;
+    }
+
+    const auto stationAIndex{getStation(stationA)};
+    const auto stationBIndex{getStation(stationB)};
+    if (stationAIndex == kInvalidIndex || stationBIndex == kInvalidIndex)
+    {
+        return 0;
+    }
+
+    const auto& routeInternal{m_routes[route.value]};
+    const auto stationAIt{routeInternal.positions.find(stationAIndex)};
+    const auto stationBIt{routeInternal.positions.find(stationBIndex)};
+    if (stationAIt == routeInternal.positions.end() ||
+        stationBIt == routeInternal.positions.end() || stationAIt->second > stationBIt->second)
+    {
+        return 0;
+    }
+
+    const auto& cumulativeTimes{routeInternal.cumulativeTimes};
+    return cumulativeTimes[stationBIt->second] - cumulativeTimes[stationAIt->second];
+}
+
+Path TransportNetwork::GetFastestPath(std::string_view stationA, std::string_view stationB) const
+{
+    return GetFastestPath(GetStationHandle(stationA), GetStationHandle(stationB));
+}
+
+Path TransportNetwork::GetFastestPath(StationHandle stationA, StationHandle stationB) const
+{
+    Path path{};
+    GetFastestPath(stationA, stationB, ThreadPathSearchState(), path);
+    return path;
+}
+
+bool TransportNetwork::GetFastestPath(StationHandle stationA,
+                                      StationHandle stationB,
+                                      PathSearchState& state,
+                                      Path& path) const
+{
+    path.steps.clear();
+    path.travelTime = 0;
+
+    const auto source{getStation(stationA)};
+    const auto target{getStation(stationB)};
+    if (source == kInvalidIndex || target == kInvalidIndex)
+    {
+        return false;
+    }
+
+    if (!search(source, target, state, false))
+    {
+        return false;
+    }
+
+    // Walk the parent links back from the target, then put the steps in travel order.
+    for (auto station{target}; station != kInvalidIndex; station = state.m_parentStation[station])
+    {
+        const auto edge{state.m_parentEdge[station]};
+        path.steps.push_back(PathStep{edge == kInvalidIndex ? RouteHandle{}
+                                                            : RouteHandle{m_edges[edge].route},
+                                      StationHandle{station}});
+    }
+    std::reverse(std::begin(path.steps), std::end(path.steps));
+    path.travelTime = state.m_distance[target];
+
+    return true;
+}
+
+std::vector<Path> TransportNetwork::GetAlternativePaths(std::string_view stationA,
+                                                        std::string_view stationB,
+                                                        std::size_t k) const
+{
+    return GetAlternativePaths(GetStationHandle(stationA), GetStationHandle(stationB), k);
+}
+
+std::vector<Path> TransportNetwork::GetAlternativePaths(StationHandle stationA,
+                                                        StationHandle stationB,
+                                                        std::size_t k) const
+{
+    return GetAlternativePaths(stationA, stationB, k, ThreadPathSearchState());
+}
+
+std::vector<Path> TransportNetwork::GetAlternativePaths(StationHandle stationA,
+                                                        StationHandle stationB,
+                                                        std::size_t k,
+                                                        PathSearchState& state) const
+{
+    std::vector<Path> paths{};
+    const auto source{getStation(stationA)};
+    const auto target{getStation(stationB)};
+    if (k == 0 || source == kInvalidIndex || target == kInvalidIndex)
+    {
+        return paths;
+    }
+
+    // A path as a list of stations and the edges between them. distances[i] is the
+    // travel time from the source to stations[i]. Spur searches of a path only start
+    // from its deviation point onwards: earlier spur stations were already explored
+    // from the path it deviated from (Lawler's refinement of Yen's algorithm).
+    struct Candidate
+    {
+        std::vector<Index> stations{};
+        std::vector<Index> edges{};
+        std::vector<unsigned int> distances{};
+        std::size_t deviation{0};
+    };
+
+    state.clearBans(m_stations.size(), m_edges.size());
+    if (!search(source, target, state, false))
+    {
+        return paths;
+    }
+
+    // Append the path found by the last search, from its start station to target.
+    auto appendSearchPath{[this, &state, target](Candidate& candidate, Index start) {
+        const auto offset{candidate.stations.size()};
+        const auto edgeOffset{candidate.edges.size()};
+        const auto base{candidate.distances.empty() ? 0 : candidate.distances.back()};
+        for (auto station{target}; station != start; station = state.m_parentStation[station])
+        {
+            candidate.stations.push_back(station);
+            candidate.edges.push_back(state.m_parentEdge[station]);
+            candidate.distances.push_back(base + state.m_distance[station]);
+        }
+        std::reverse(std::begin(candidate.stations) + offset, std::end(candidate.stations));
+        std::reverse(std::begin(candidate.edges) + edgeOffset, std::end(candidate.edges));
+        std::reverse(std::begin(candidate.distances) + offset, std::end(candidate.distances));
+    }};
+
+    std::vector<Candidate> accepted{};
+    accepted.emplace_back();
+    accepted.back().stations.push_back(source);
+    accepted.back().distances.push_back(0);
+    appendSearchPath(accepted.back(), source);
+
+    // Candidates are kept in a heap ordered by travel time; the station sequences of
+    // all the paths seen so far avoid queuing the same path twice.
+    auto slower{[](const Candidate& a, const Candidate& b) {
+        return a.distances.back() > b.distances.back();
+    }};
+    std::vector<Candidate> candidates{};
+    std::set<std::vector<Index>> seen{accepted.back().stations};
+
+    while (accepted.size() < k)
+    {
+        const auto& last{accepted.back()};
+        for (auto spur{last.deviation}; spur + 1 < last.stations.size(); ++spur)
+        {
+            const auto spurStation{last.stations[spur]};
+
+            // The root path must stay loopless, and the next hop of each accepted path
+            // sharing this root is already known.
+            state.clearBans(m_stations.size(), m_edges.size());
+            for (std::size_t idx{0}; idx < spur; ++idx)
+            {
+                state.ban(last.stations[idx]);
+            }
+            for (const auto& path : accepted)
+            {
+                if (path.stations.size() > spur + 1 &&
+                    std::equal(std::begin(path.stations),
+                               std::begin(path.stations) + spur + 1,
+                               std::begin(last.stations)))
+                {
+                    const auto next{path.stations[spur + 1]};
+                    const auto& row{m_edgeRows[spurStation]};
+                    for (auto idx{row.first}; idx < row.first + row.size; ++idx)
+                    {
+                        if (m_edges[idx].nextStop == next)
+                        {
+                            state.banEdge(idx);
+                        }
+                    }
+                }
+            }
+
+            if (!search(spurStation, target, state, true))
+            {
+                continue;
+            }
+
+            Candidate candidate{};
+            candidate.stations.assign(std::begin(last.stations),
+                                      std::begin(last.stations) + spur + 1);
+            candidate.edges.assign(std::begin(last.edges), std::begin(last.edges) + spur);
+            candidate.distances.assign(std::begin(last.distances),
+                                       std::begin(last.distances) + spur + 1);
+            candidate.deviation = spur;
+            appendSearchPath(candidate, spurStation);
+            if (seen.insert(candidate.stations).second)
+            {
+                candidates.push_back(std::move(candidate));
+                std::push_heap(std::begin(candidates), std::end(candidates), slower);
+            }
+        }
+
+        if (candidates.empty())
+        {
+            break;
+        }
+        std::pop_heap(std::begin(candidates), std::end(candidates), slower);
+        accepted.push_back(std::move(candidates.back()));
+        candidates.pop_back();
+    }
+
+    paths.reserve(accepted.size());
+    for (const auto& candidate : accepted)
+    {
+        Path path{};
+        path.steps.reserve(candidate.stations.size());
+        path.steps.push_back(PathStep{RouteHandle{}, StationHandle{source}});
+        for (std::size_t idx{0}; idx < candidate.edges.size(); ++idx)
+        {
+            path.steps.push_back(PathStep{RouteHandle{m_edges[candidate.edges[idx]].route},
+                                          StationHandle{candidate.stations[idx + 1]}});
+        }
+        path.travelTime = candidate.distances.back();
+        paths.push_back(std::move(path));
+    }
+
+    return paths;
+}
+
+std::vector<JourneyOption> TransportNetwork::GetJourneyOptions(
+    std::string_view stationA,
+    std::string_view stationB,
+    const JourneyPlannerOptions& options) const
+{
+    return GetJourneyOptions(GetStationHandle(stationA), GetStationHandle(stationB), options);
+}
+
+std::vector<JourneyOption> TransportNetwork::GetJourneyOptions(
+    StationHandle stationA,
+    StationHandle stationB,
+    const JourneyPlannerOptions& options) const
+{
+    return GetJourneyOptions(stationA, stationB, options, ThreadJourneySearchState());
+}
+
+std::vector<JourneyOption> TransportNetwork::GetJourneyOptions(
+    StationHandle stationA,
+    StationHandle stationB,
+    const JourneyPlannerOptions& options,
+    JourneySearchState& state) const
+{
+    std::vector<JourneyOption> journeys{};
+    const auto source{getStation(stationA)};
+    const auto target{getStation(stationB)};
+    if (source == kInvalidIndex || target == kInvalidIndex)
+    {
+        return journeys;
+    }
+
+    if (source == target)
+    {
+        journeys.push_back(JourneyOption{Path{{PathStep{RouteHandle{}, stationA}}, 0}, 0});
+        return journeys;
+    }
+
+    const auto roundCount{static_cast<std::size_t>(options.maxTransfers) + 2};
+    state.prepare(m_stations.size(), m_routes.size(), roundCount);
+    state.label(0, source, 0, JourneySearchState::Leg{});
+    state.m_marked.push_back(source);
+
+    for (std::size_t round{1}; round < roundCount && !state.m_marked.empty(); ++round)
+    {
+        queueMarkedRoutes(state);
+
+        // Boarding costs the interchange penalty from the second route on.
+        const auto penalty{round > 1 ? options.interchangePenalty : 0};
+        for (const auto route : state.m_queuedRoutes)
+        {
+            scanRoute(route, round, target, penalty, state);
+        }
+
+        for (const auto station : state.m_nextMarked)
+        {
+            state.m_markedStamp[station] = 0;
+        }
+        std::swap(state.m_marked, state.m_nextMarked);
+        state.m_nextMarked.clear();
+
+        if (state.isLabelled(round, target))
+        {
+            journeys.push_back(walkJourney(source, target, round, state));
+        }
+    }
+
+    return journeys;
+}
+
+std::uint64_t TransportNetwork::GetRevision() const
+{
+    return m_revision;
+}
+
+std::pmr::memory_resource* TransportNetwork::GetMemoryResource() const
+{
+    return m_stations.get_allocator().resource();
+}
+
+MemoryStats TransportNetwork::GetMemoryStats() const
+{
+    MemoryStats stats{};
+
+    stats.stations += Memory::VectorBytes(m_stations);
+    for (const auto& station : m_stations)
+    {
+        stats.stations += Memory::VectorBytes(station.routes);
+        stats.strings += Memory::StringBytes(station.name);
+    }
+
+    stats.edges += Memory::VectorBytes(m_edgeRows) + Memory::VectorBytes(m_edges);
+
+    stats.routes += Memory::VectorBytes(m_routes);
+    for (const auto& route : m_routes)
+    {
+        stats.routes += Memory::VectorBytes(route.stops);
+        stats.routes += Memory::VectorBytes(route.cumulativeTimes);
+        stats.hashTables += Memory::HashTableBytes(route.positions);
+        stats.strings += Memory::StringBytes(route.id) + Memory::StringBytes(route.name);
+    }
+
+    stats.lines += Memory::VectorBytes(m_lines);
+    for (const auto& line : m_lines)
+    {
+        stats.hashTables += Memory::HashTableBytes(line.routes);
+        stats.strings += Memory::StringBytes(line.name);
+        for (const auto& [id, _] : line.routes)
+        {
+            stats.strings += Memory::StringBytes(id);
+        }
+    }
+
+    m_stationIds.AddMemoryUsage(stats);
+    m_lineIds.AddMemoryUsage(stats);
+    stats.passengerCounters += m_passengerCounts.GetMemoryUsage();
+    stats.passengerStatistics += m_passengerStatistics.GetMemoryUsage();
+    stats.searchBuffers +=
+        ThreadPathSearchState().GetMemoryUsage() + ThreadJourneySearchState().GetMemoryUsage();
+
+    return stats;
+}
+
+bool TransportNetwork::FromJson(nlohmann::json&& src)
+{
+    // The document is ours: move its strings out instead of copying them.
+    auto take{[](nlohmann::json& value) { return std::move(value.get_ref<std::string&>()); }};
+
+    // Lines refer to stations, so stations go first whatever the order in the document.
+    bool ok{true};
+    for (auto& stationJson : src["stations"])
+    {
+        Station station{take(stationJson["station_id"]), take(stationJson["name"])};
+        ok &= AddStation(station);
+        if (!ok)
+        {
+            throw std::runtime_error("Could not add station " + station.id);
+        }
+    }
+
+    for (auto& lineJson : src["lines"])
+    {
+        Line line{take(lineJson["line_id"]), take(lineJson["name"]), {}};
+        for (auto& routeJson : lineJson["routes"])
+        {
+            Route route{};
+            route.id = take(routeJson["route_id"]);
+            route.lineId = take(routeJson["line_id"]);
+            route.startStationId = take(routeJson["start_station_id"]);
+            route.endStationId = take(routeJson["end_station_id"]);
+            for (auto& stop : routeJson["route_stops"])
+            {
+                route.stops.push_back(take(stop));
+            }
+            line.routes.push_back(std::move(route));
+        }
+
+        ok &= AddLine(line);
+        if (!ok)
+        {
+            throw std::runtime_error("Could not add line " + line.id);
+        }
+    }
+
+    for (auto& travelTimeJson : src["travel_times"])
+    {
+        ok &= SetTravelTime(travelTimeJson["start_station_id"].get_ref<const std::string&>(),
+                            travelTimeJson["end_station_id"].get_ref<const std::string&>(),
+                            travelTimeJson["travel_time"].get<unsigned int>());
+    }
+
+    return ok;
+}
+
+namespace
+{
+
+/*! \brief SAX handler building a TransportNetwork from a network layout document.
+ *
+ *  Objects are turned into stations, lines and travel times as soon as they end. The
+ *  handler tracks where it is in the document with a stack of scopes; anything it does
+ *  not know about is skipped.
+ */
+class LayoutSaxHandler : public nlohmann::json_sax<nlohmann::json>
+{
+public:
+    explicit LayoutSaxHandler(TransportNetwork& network) : m_network{network}
+    {
+    }
+
+    /*! \brief Add whatever is still held back. Call once the document was parsed.
+     */
+    bool Finish()
+    {
+        m_stationsDone = true;
+        m_linesDone = true;
+        flush();
+        return m_ok;
+    }
+
+    bool null() override
+    {
+        return true;
+    }
+
+    bool boolean(bool) override
+    {
+        return true;
+    }
+
+    bool number_integer(number_integer_t value) override
+    {
+        if (value < 0)
+        {
+            return !isTravelTime();
+        }
+        return number_unsigned(static_cast<number_unsigned_t>(value));
+    }
+
+    bool number_unsigned(number_unsigned_t value) override
+    {
+        if (isTravelTime())
+        {
+            m_travelTime.travelTime = static_cast<unsigned int>(value);
+        }
+        return true;
+    }
+
+    bool number_float(number_float_t, const string_t&) override
+    {
+        return !isTravelTime();
+    }
+
+    bool string(string_t& value) override
+    {
+        switch (top())
+        {
+        case Scope::Station:
+            assign(value, {{"station_id", &m_station.id}, {"name", &m_station.name}});
+            break;
+        case Scope::Line:
+            assign(value, {{"line_id", &m_line.id}, {"name", &m_line.name}});
+            break;
+        case Scope::Route:
+            assign(value,
+                   {{"route_id", &m_route.id},
+                    {"line_id", &m_route.lineId},
+                    {"start_station_id", &m_route.startStationId},
+                    {"end_station_id", &m_route.endStationId}});
+            break;
+        case Scope::Stops:
+            m_route.stops.push_back(std::move(value));
+            break;
+        case Scope::TravelTime:
+            assign(value,
+                   {{"start_station_id", &m_travelTime.stationA},
+                    {"end_station_id", &m_travelTime.stationB}});
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) override
+    {
+        return true;
+    }
+
+    bool start_object(std::size_t) override
+    {
+        switch (top())
+        {
+        case Scope::None:
+            m_scopes.push_back(Scope::Root);
+            break;
+        case Scope::Stations:
+            m_station = Station{};
+            m_scopes.push_back(Scope::Station);
+            break;
+        case Scope::Lines:
+            m_line = Line{};
+            m_scopes.push_back(Scope::Line);
+            break;
+        case Scope::Routes:
+            m_route = Route{};
+            m_scopes.push_back(Scope::Route);
+            break;
+        case Scope::TravelTimes:
+            m_travelTime = TravelTime{};
+            m_scopes.push_back(Scope::TravelTime);
+            break;
+        default:
+            m_scopes.push_back(Scope::Skip);
+            break;
+        }
+        return true;
+    }
+
+    bool end_object() override
+    {
+        const auto scope{top()};
+        m_scopes.pop_back();
+        switch (scope)
+        {
+        case Scope::Station:
+            addStation();
+            break;
+        case Scope::Line:
+            m_pendingLines.push_back(std::move(m_line));
+            flush();
+            break;
+        case Scope::Route:
+            m_line.routes.push_back(std::move(m_route));
+            break;
+        case Scope::TravelTime:
+            m_pendingTravelTimes.push_back(std::move(m_travelTime));
+            flush();
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        auto scope{Scope::Skip};
+        if (top() == Scope::Root && m_key == "stations")
+        {
+            scope = Scope::Stations;
+        }
+        else if (top() == Scope::Root && m_key == "lines")
+        {
+            scope = Scope::Lines;
+        }
+        else if (top() == Scope::Root && m_key == "travel_times")
+        {
+            scope = Scope::TravelTimes;
+        }
+        else if (top() == Scope::Line && m_key == "routes")
+        {
+            scope = Scope::Routes;
+        }
+        else if (top() == Scope::Route && m_key == "route_stops")
+        {
+            scope = Scope::Stops;
+        }
+        m_scopes.push_back(scope);
+        return true;
+    }
+
+    bool end_array() override
+    {
+        const auto scope{top()};
+        m_scopes.pop_back();
+        if (scope == Scope::Stations)
+        {
+            m_stationsDone = true;
+            flush();
+        }
+        else if (scope == Scope::Lines)
+        {
+            m_linesDone = true;
+            flush();
+        }
+        return true;
+    }
+
+    bool key(string_t& value) override
+    {
+        m_key.swap(value);
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override
+    {
+        return false;
+    }
+
+private:
+    enum class Scope
+    {
+        None,
+        Root,
+        Stations,
+        Station,
+        Lines,
+        Line,
+        Routes,
+        Route,
+        Stops,
+        TravelTimes,
+        TravelTime,
+        Skip,
+    };
+
+    struct Field
+    {
+        const char* key;
+        std::string* target;
+    };
+
+    Scope top() const
+    {
+        return m_scopes.empty() ? Scope::None : m_scopes.back();
+    }
+
+    bool isTravelTime() const
+    {
+        return top() == Scope::TravelTime && m_key == "travel_time";
+    }
+
+    void assign(string_t& value, std::initializer_list<Field> fields)
+    {
+        for (const auto& field : fields)
+        {
+            if (m_key == field.key)
+            {
+                *field.target = std::move(value);
+                return;
+            }
+        }
+    }
+
+    void addStation()
+    {
+        if (!m_network.AddStation(m_station))
+        {
+            throw std::runtime_error("Could not add station " + m_station.id);
+        }
+    }
+
+    // Lines need their stations, travel times need their lines.
+    void flush()
+    {
+        if (m_stationsDone)
+        {
+            for (const auto& line : m_pendingLines)
+            {
+                if (!m_network.AddLine(line))
+                {
+                    throw std::runtime_error("Could not add line " + line.id);
+                }
+            }
+            m_pendingLines.clear();
+        }
+        if (m_stationsDone && m_linesDone)
+        {
+            for (const auto& travelTime : m_pendingTravelTimes)
+            {
+                m_ok &= m_network.SetTravelTime(travelTime.stationA,
+                                                travelTime.stationB,
+                                                travelTime.travelTime);
+            }
+            m_pendingTravelTimes.clear();
+        }
+    }
+
+private:
+    TransportNetwork& m_network;
+    bool m_ok{true};
+
+    std::vector<Scope> m_scopes{};
+    std::string m_key{};
+    Station m_station{};
+    Line m_line{};
+    Route m_route{};
+    TravelTime m_travelTime{};
+
+    bool m_stationsDone{false};
+    bool m_linesDone{false};
+    std::vector<Line> m_pendingLines{};
+    std::vector<TravelTime> m_pendingTravelTimes{};
+};
+
+} // namespace
+
+bool TransportNetwork::FromJson(std::istream& src)
+{
+    LayoutSaxHandler handler{*this};
+    if (!nlohmann::json::sax_parse(src, &handler))
+    {
+        return false;
+    }
+    return handler.Finish();
+}
+
+namespace
+{
+
+// Binary snapshot format. All integers are in host byte order; snapshots are a cache
+// for the machine that wrote them, not an exchange format. The header is followed by
+// the payload, whose sections are 8-byte aligned arrays of the records below. Bump
+// kSnapshotVersion whenever any of these structures changes.
+constexpr char kSnapshotMagic[8]{'N', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::uint32_t kSnapshotVersion{2};
+constexpr std::uint32_t kSnapshotByteOrder{0x01020304};
+
+struct SnapshotSection
+{
+    std::uint64_t offset{0};
+    std::uint64_t count{0};
+};
+
+struct SnapshotHeader
+{
+    char magic[8]{};
+    std::uint32_t version{0};
+    std::uint32_t byteOrder{0};
+    std::uint64_t payloadSize{0};
+    std::uint64_t checksum{0};
+
+    // Size and modification time of the layout file the snapshot was taken from.
+    std::uint64_t layoutSize{0};
+    std::int64_t layoutTime{0};
+
+    std::uint64_t revision{0};
+
+    SnapshotSection stringOffsets{};
+    SnapshotSection strings{};
+    SnapshotSection stations{};
+    SnapshotSection stationRouteOffsets{};
+    SnapshotSection stationRoutes{};
+    SnapshotSection lines{};
+    SnapshotSection routes{};
+    SnapshotSection routeStops{};
+    SnapshotSection routeTimes{};
+    SnapshotSection edgeOffsets{};
+    SnapshotSection edges{};
+};
+
+// Removed objects are stored as tombstones, so that handles survive a round trip.
+constexpr std::uint32_t kSnapshotRemoved{1};
+
+// Stations and lines.
+struct SnapshotNamed
+{
+    std::uint32_t id{0};
+    std::uint32_t name{0};
+    std::uint32_t flags{0};
+};
+
+struct SnapshotRoute
+{
+    std::uint32_t id{0};
+    std::uint32_t name{0};
+    std::uint32_t line{0};
+    std::uint32_t firstStop{0};
+    std::uint32_t stopCount{0};
+    std::uint32_t flags{0};
+};
+
+constexpr std::size_t kSnapshotAlignment{8};
+static_assert(sizeof(SnapshotHeader) % kSnapshotAlignment == 0);
+
+// FNV-1a, 64-bit.
+std::uint64_t SnapshotChecksum(const std::byte* data, std::size_t size)
+{
+    std::uint64_t hash{14695981039346656037ull};
+    for (std::size_t idx{0}; idx < size; ++idx)
+    {
+        hash ^= static_cast<std::uint64_t>(data[idx]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool LayoutFingerprint(const std::filesystem::path& layout,
+                       std::uint64_t& size,
+                       std::int64_t& time)
+{
+    size = 0;
+    time = 0;
+    if (layout.empty())
+    {
+        return true;
+    }
+
+    std::error_code error{};
+    const auto fileSize{std::filesystem::file_size(layout, error)};
+    if (error)
+    {
+        return false;
+    }
+    const auto fileTime{std::filesystem::last_write_time(layout, error)};
+    if (error)
+    {
+        return false;
+    }
+    size = static_cast<std::uint64_t>(fileSize);
+    time = static_cast<std::int64_t>(fileTime.time_since_epoch().count());
+    return true;
+}
+
+class SnapshotWriter
+{
+public:
+    template <typename T> SnapshotSection Append(const T* data, std::size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_payload.resize((m_payload.size() + kSnapshotAlignment - 1) / kSnapshotAlignment *
+                         kSnapshotAlignment);
+        SnapshotSection section{m_payload.size(), count};
+        m_payload.resize(m_payload.size() + count * sizeof(T));
+        if (count > 0)
+        {
+            std::memcpy(m_payload.data() + section.offset, data, count * sizeof(T));
+        }
+        return section;
+    }
+
+    template <typename T, typename Allocator>
+    SnapshotSection Append(const std::vector<T, Allocator>& data)
+    {
+        return Append(data.data(), data.size());
+    }
+
+    const std::vector<std::byte>& Payload() const
+    {
+        return m_payload;
+    }
+
+private:
+    std::vector<std::byte> m_payload{};
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const std::byte* payload, std::size_t size) : m_payload{payload}, m_size{size}
+    {
+    }
+
+    /*! \brief Return the array stored in a section, or nullptr if it does not fit.
+     */
+    template <typename T> const T* View(const SnapshotSection& section) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (section.offset % alignof(T) != 0 || section.offset > m_size ||
+            section.count > (m_size - section.offset) / sizeof(T))
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<const T*>(m_payload + section.offset);
+    }
+
+private:
+    const std::byte* m_payload{nullptr};
+    std::size_t m_size{0};
+};
+
+} // namespace
+
+bool TransportNetwork::SaveSnapshot(const std::filesystem::path& snapshot,
+                                    const std::filesystem::path& layout) const
+{
+    static_assert(std::is_trivially_copyable_v<GraphEdge>);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.byteOrder = kSnapshotByteOrder;
+    header.revision = m_revision;
+    if (!LayoutFingerprint(layout, header.layoutSize, header.layoutTime))
+    {
+        return false;
+    }
+
+    // String table: ids and names of stations, lines and routes.
+    std::vector<std::uint64_t> stringOffsets{0};
+    std::string strings{};
+    auto addString{[&stringOffsets, &strings](const std::string& value) {
+        strings += value;
+        stringOffsets.push_back(strings.size());
+        return static_cast<std::uint32_t>(stringOffsets.size() - 2);
+    }};
+
+    std::vector<SnapshotNamed> stations{};
+    std::vector<Index> stationRouteOffsets{0};
+    std::vector<Index> stationRoutes{};
+    stations.reserve(m_stations.size());
+    for (std::size_t station{0}; station < m_stations.size(); ++station)
+    {
+        const auto id{addString(m_stationIds.Resolve(static_cast<Index>(station)))};
+        stations.push_back(SnapshotNamed{id,
+                                         addString(m_stations[station].name),
+                                         m_stations[station].removed ? kSnapshotRemoved : 0});
+        for (const auto& route : m_stations[station].routes)
+        {
+            stationRoutes.push_back(route.value);
+        }
+        stationRouteOffsets.push_back(static_cast<Index>(stationRoutes.size()));
+    }
+
+    std::vector<SnapshotNamed> lines{};
+    lines.reserve(m_lines.size());
+    for (std::size_t line{0}; line < m_lines.size(); ++line)
+    {
+        const auto id{addString(m_lineIds.Resolve(static_cast<Index>(line)))};
+        lines.push_back(SnapshotNamed{id,
+                                      addString(m_lines[line].name),
+                                      m_lines[line].removed ? kSnapshotRemoved : 0});
+    }
+
+    std::vector<SnapshotRoute> routes{};
+    std::vector<Index> routeStops{};
+    std::vector<unsigned int> routeTimes{};
+    routes.reserve(m_routes.size());
+    for (const auto& route : m_routes)
+    {
+        const auto id{addString(route.id)};
+        routes.push_back(SnapshotRoute{id,
+                                       addString(route.name),
+                                       route.line,
+                                       static_cast<std::uint32_t>(routeStops.size()),
+                                       static_cast<std::uint32_t>(route.stops.size()),
+                                       route.removed ? kSnapshotRemoved : 0});
+        routeStops.insert(routeStops.end(), route.stops.begin(), route.stops.end());
+        routeTimes.insert(routeTimes.end(),
+                          route.cumulativeTimes.begin(),
+                          route.cumulativeTimes.end());
+    }
+
+    SnapshotWriter writer{};
+    header.stringOffsets = writer.Append(stringOffsets);
+    header.strings = writer.Append(strings.data(), strings.size());
+    header.stations = writer.Append(stations);
+    header.stationRouteOffsets = writer.Append(stationRouteOffsets);
+    header.stationRoutes = writer.Append(stationRoutes);
+    header.lines = writer.Append(lines);
+    header.routes = writer.Append(routes);
+    header.routeStops = writer.Append(routeStops);
+    header.routeTimes = writer.Append(routeTimes);
+    // Rows are saved back to back, without the gaps and spare room they have in memory.
+    std::vector<Index> edgeOffsets{0};
+    std::vector<GraphEdge> edges{};
+    edgeOffsets.reserve(m_stations.size() + 1);
+    edges.reserve(m_edgeCount);
+    for (std::size_t station{0}; station < m_stations.size(); ++station)
+    {
+        const auto row{edgesOf(static_cast<Index>(station))};
+        edges.insert(edges.end(), row.begin(), row.end());
+        edgeOffsets.push_back(static_cast<Index>(edges.size()));
+    }
+    header.edgeOffsets = writer.Append(edgeOffsets);
+    header.edges = writer.Append(edges);
+
+    const auto& payload{writer.Payload()};
+    header.payloadSize = payload.size();
+    header.checksum = SnapshotChecksum(payload.data(), payload.size());
+
+    // Write next to the destination and rename, so readers never see a partial file.
+    auto temporary{snapshot};
+    temporary += ".tmp";
+    {
+        std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(payload.data()),
+                   static_cast<std::streamsize>(payload.size()));
+        if (!file.flush())
+        {
+            return false;
+        }
+    }
+    std::error_code error{};
+    std::filesystem::rename(temporary, snapshot, error);
+    return !error;
+}
+
+bool TransportNetwork::LoadSnapshot(const std::filesystem::path& snapshot,
+                                    const std::filesystem::path& layout)
+{
+    MappedFile file{};
+    if (!file.Open(snapshot) || file.Size() < sizeof(SnapshotHeader))
+    {
+        return false;
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 ||
+        header.version != kSnapshotVersion || header.byteOrder != kSnapshotByteOrder ||
+        header.payloadSize != file.Size() - sizeof(header))
+    {
+        return false;
+    }
+
+    std::uint64_t layoutSize{0};
+    std::int64_t layoutTime{0};
+    if (!LayoutFingerprint(layout, layoutSize, layoutTime) || layoutSize != header.layoutSize ||
+        layoutTime != header.layoutTime)
+    {
+        return false;
+    }
+
+    const auto* payload{file.Data() + sizeof(header)};
+    if (SnapshotChecksum(payload, header.payloadSize) != header.checksum)
+    {
+        return false;
+    }
+
+    const SnapshotReader reader{payload, header.payloadSize};
+    const auto* stringOffsets{reader.View<std::uint64_t>(header.stringOffsets)};
+    const auto* strings{reader.View<char>(header.strings)};
+    const auto* stations{reader.View<SnapshotNamed>(header.stations)};
+    const auto* stationRouteOffsets{reader.View<Index>(header.stationRouteOffsets)};
+    const auto* stationRoutes{reader.View<Index>(header.stationRoutes)};
+    const auto* lines{reader.View<SnapshotNamed>(header.lines)};
+    const auto* routes{reader.View<SnapshotRoute>(header.routes)};
+    const auto* routeStops{reader.View<Index>(header.routeStops)};
+    const auto* routeTimes{reader.View<unsigned int>(header.routeTimes)};
+    const auto* edgeOffsets{reader.View<Index>(header.edgeOffsets)};
+    const auto* edges{reader.View<GraphEdge>(header.edges)};
+    const auto stationCount{header.stations.count};
+    const auto stringCount{header.stringOffsets.count == 0 ? 0 : header.stringOffsets.count - 1};
+    if (!stringOffsets || !strings || !stations || !stationRouteOffsets || !stationRoutes ||
+        !lines || !routes || !routeStops || !routeTimes || !edgeOffsets || !edges ||
+        header.stationRouteOffsets.count != stationCount + 1 ||
+        header.edgeOffsets.count != stationCount + 1 ||
+        header.routeTimes.count != header.routeStops.count ||
+        edgeOffsets[stationCount] != header.edges.count ||
+        stationRouteOffsets[stationCount] != header.stationRoutes.count)
+    {
+        return false;
+    }
+
+    // The checksum catches corruption; these checks keep a well-formed but inconsistent
+    // file from making us index out of bounds.
+    auto getString{[&](std::uint32_t idx, std::string& value) {
+        if (idx >= stringCount || stringOffsets[idx] > stringOffsets[idx + 1] ||
+            stringOffsets[idx + 1] > header.strings.count)
+        {
+            return false;
+        }
+        value.assign(strings + stringOffsets[idx], strings + stringOffsets[idx + 1]);
+        return true;
+    }};
+
+    TransportNetwork network{GetMemoryResource()};
+    Id id{};
+
+    network.m_stations.resize(stationCount);
+    for (std::size_t station{0}; station < stationCount; ++station)
+    {
+        auto& node{network.m_stations[station]};
+        if (!getString(stations[station].id, id) || !getString(stations[station].name, node.name) ||
+            network.m_stationIds.Intern(id) != station ||
+            stationRouteOffsets[station] > stationRouteOffsets[station + 1] ||
+            edgeOffsets[station] > edgeOffsets[station + 1])
+        {
+            return false;
+        }
+        node.removed = (stations[station].flags & kSnapshotRemoved) != 0;
+        for (auto idx{stationRouteOffsets[station]}; idx < stationRouteOffsets[station + 1]; ++idx)
+        {
+            if (stationRoutes[idx] >= header.routes.count)
+            {
+                return false;
+            }
+            node.routes.push_back(RouteHandle{stationRoutes[idx]});
+        }
+    }
+
+    network.m_lines.resize(header.lines.count);
+    for (std::size_t line{0}; line < header.lines.count; ++line)
+    {
+        if (!getString(lines[line].id, id) ||
+            !getString(lines[line].name, network.m_lines[line].name) ||
+            network.m_lineIds.Intern(id) != line)
+        {
+            return false;
+        }
+        network.m_lines[line].removed = (lines[line].flags & kSnapshotRemoved) != 0;
+    }
+
+    network.m_routes.resize(header.routes.count);
+    for (std::size_t route{0}; route < header.routes.count; ++route)
+    {
+        const auto& record{routes[route]};
+        auto& routeInternal{network.m_routes[route]};
+        if (!getString(record.id, routeInternal.id) ||
+            !getString(record.name, routeInternal.name) || record.line >= header.lines.count ||
+            record.firstStop > header.routeStops.count ||
+            record.stopCount > header.routeStops.count - record.firstStop)
+        {
+            return false;
+        }
+
+        routeInternal.line = record.line;
+        const auto* stops{routeStops + record.firstStop};
+        const auto* times{routeTimes + record.firstStop};
+        routeInternal.stops.assign(stops, stops + record.stopCount);
+        routeInternal.cumulativeTimes.assign(times, times + record.stopCount);
+        for (Index position{0}; position < record.stopCount; ++position)
+        {
+            if (stops[position] >= stationCount)
+            {
+                return false;
+            }
+            routeInternal.positions.emplace(stops[position], position);
+        }
+        routeInternal.removed = (record.flags & kSnapshotRemoved) != 0;
+        if (!routeInternal.removed)
+        {
+            network.m_lines[record.line].routes.emplace(routeInternal.id,
+                                                        static_cast<Index>(route));
+        }
+    }
+
+    network.m_edgeRows.resize(stationCount);
+    for (std::size_t station{0}; station < stationCount; ++station)
+    {
+        const auto size{edgeOffsets[station + 1] - edgeOffsets[station]};
+        network.m_edgeRows[station] = EdgeRow{edgeOffsets[station], size, size};
+    }
+    network.m_edgeCount = header.edges.count;
+    network.m_edges.resize(header.edges.count);
+    if (header.edges.count > 0)
+    {
+        std::memcpy(network.m_edges.data(), edges, header.edges.count * sizeof(GraphEdge));
+    }
+    for (const auto& edge : network.m_edges)
+    {
+        if (edge.nextStop >= stationCount || edge.route >= header.routes.count)
+        {
+            return false;
+        }
+    }
+
+    // Passenger counts and statistics are not part of the snapshot: carry them over, by
+    // station id, to the stations that are still there.
+    network.m_passengerCounts.Resize(stationCount);
+    network.m_passengerStatistics = std::move(m_passengerStatistics);
+    std::vector<std::size_t> sources(stationCount, PassengerStatistics::kNoStation);
+    for (std::size_t station{0}; station < stationCount; ++station)
+    {
+        if (network.m_stations[station].removed)
+        {
+            continue;
+        }
+        const auto previous{getStation(network.m_stationIds.Resolve(static_cast<Index>(station)))};
+        if (previous != kInvalidIndex)
+        {
+            sources[station] = previous;
+            network.m_passengerCounts.Add(station, m_passengerCounts.Get(previous));
+        }
+    }
+    network.m_passengerStatistics.Remap(sources);
+
+    network.m_busiestStations.Resize(stationCount);
+    for (std::size_t station{0}; station < stationCount; ++station)
+    {
+        network.m_busiestStations.SetRanked(station, !network.m_stations[station].removed);
+        if (sources[station] != PassengerStatistics::kNoStation)
+        {
+            network.m_busiestStations.MarkChanged(station);
+        }
+    }
+    network.m_revision = header.revision;
+    *this = std::move(network);
+    return true;
+}
+
+bool TransportNetwork::LoadLayout(const std::filesystem::path& layout,
+                                  const std::filesystem::path& snapshot)
+{
+    if (LoadSnapshot(snapshot, layout))
+    {
+        return true;
+    }
+
+    std::ifstream file{layout};
+    if (!file)
+    {
+        return false;
+    }
+
+    TransportNetwork network{GetMemoryResource()};
+    if (!network.FromJson(file))
+    {
+        return false;
+    }
+    *this = std::move(network);
+
+    // A snapshot that cannot be written only costs the next start some time.
+    SaveSnapshot(snapshot, layout);
+    return true;
+}
+
+void TransportNetwork::queueMarkedRoutes(JourneySearchState& state) const
+{
+    state.m_queuedRoutes.clear();
+    for (const auto station : state.m_marked)
+    {
+        for (const auto route : m_stations[station].routes)
+        {
+            state.queueRoute(route.value, m_routes[route.value].positions.at(station));
+        }
+    }
+}
+
+void TransportNetwork::scanRoute(Index route,
+                                 std::size_t round,
+                                 Index target,
+                                 unsigned int penalty,
+                                 JourneySearchState& state) const
+{
+    // Scan the route from its first marked stop, boarding wherever that is faster than
+    // staying on board.
+    state.m_routeStamp[route] = 0;
+    const auto& routeInternal{m_routes[route]};
+    const auto& stops{routeInternal.stops};
+    const auto& cumulativeTimes{routeInternal.cumulativeTimes};
+    constexpr auto kUnreached{JourneySearchState::kUnreached};
+
+    Index boardPosition{kInvalidIndex};
+    unsigned int boardTime{kUnreached};
+    for (auto position{state.m_routeStart[route]}; position < stops.size(); ++position)
+    {
+        const auto station{stops[position]};
+        const auto onBoard{boardPosition == kInvalidIndex
+                               ? kUnreached
+                               : boardTime + cumulativeTimes[position] -
+                                     cumulativeTimes[boardPosition]};
+        if (onBoard < state.bestArrival(station) && onBoard < state.bestArrival(target))
+        {
+            state.label(round,
+                        station,
+                        onBoard,
+                        JourneySearchState::Leg{route, boardPosition, position});
+            state.mark(station);
+        }
+
+        const auto previous{state.arrivalUpTo(round - 1, station)};
+        if (previous != kUnreached && previous + penalty < onBoard)
+        {
+            boardPosition = position;
+            boardTime = previous + penalty;
+        }
+    }
+}
+
+JourneyOption TransportNetwork::walkJourney(Index source,
+                                            Index target,
+                                            std::size_t round,
+                                            const JourneySearchState& state) const
+{
+    // The target improved in this round: walk the legs back to the source.
+    JourneyOption journey{};
+    journey.transfers = static_cast<unsigned int>(round - 1);
+    journey.path.travelTime = state.m_rounds[round].arrival[target];
+    auto& steps{journey.path.steps};
+    auto station{target};
+    for (auto legRound{round}; legRound > 0; --legRound)
+    {
+        // A station may have been reached in an earlier round than the one we are
+        // walking back from: use the round that actually set its label.
+        while (!state.isLabelled(legRound, station))
+        {
+            --legRound;
+        }
+
+        const auto leg{state.m_rounds[legRound].leg[station]};
+        const auto& stops{m_routes[leg.route].stops};
+        for (auto position{leg.alightPosition}; position > leg.boardPosition; --position)
+        {
+            steps.push_back(PathStep{RouteHandle{leg.route}, StationHandle{stops[position]}});
+        }
+        station = stops[leg.boardPosition];
+        if (station == source)
+        {
+            break;
+        }
+    }
+    steps.push_back(PathStep{RouteHandle{}, StationHandle{source}});
+    std::reverse(std::begin(steps), std::end(steps));
+    return journey;
+}
+
+TransportNetwork::Index TransportNetwork::getStation(std::string_view id) const
+{
+    return getStation(StationHandle{m_stationIds.Find(id)});
+}
+
+TransportNetwork::Index TransportNetwork::getStation(StationHandle station) const
+{
+    return (station.value < m_stations.size() && !m_stations[station.value].removed
+                ? station.value
+                : kInvalidIndex);
+}
+
+TransportNetwork::Index TransportNetwork::getLine(std::string_view id) const
+{
+    const auto line{m_lineIds.Find(id)};
+    return (line != kInvalidIndex && !m_lines[line].removed ? line : kInvalidIndex);
+}
+
+TransportNetwork::Index TransportNetwork::getRoute(const Id& lineId, const Id& routeId) const
+{
+    const auto line{getLine(lineId)};
+    if (line == kInvalidIndex)
+    {
+        return kInvalidIndex;
+    }
+
+    const auto& routes{m_lines[line].routes};
+    auto routeIt = routes.find(routeId);
+    if (routeIt == routes.end())
+    {
+        return kInvalidIndex;
+    }
+
+    return routeIt->second;
+}
+
+bool TransportNetwork::recordPassengerEvent(
+    Index station,
+    PassengerEvent::Type type,
+    const std::optional<std::chrono::system_clock::time_point>& timestamp)
+{
+    if (station == kInvalidIndex)
+    {
+        return false;
+    }
+
+    bool isIn{false};
+    switch (type)
+    {
+    case PassengerEvent::Type::In:
+        m_passengerCounts.Add(station, 1);
+        isIn = true;
+        break;
+    case PassengerEvent::Type::Out:
+        m_passengerCounts.Add(station, -1);
+        break;
+    default:
+        return false;
+    };
+    m_busiestStations.MarkChanged(station);
+
+    // Only read the clock when statistics are kept.
+    if (m_passengerStatistics.IsEnabled())
+    {
+        m_passengerStatistics.Add(station,
+                                  timestamp ? *timestamp : std::chrono::system_clock::now(),
+                                  isIn ? 1 : 0,
+                                  isIn ? 0 : 1);
+    }
+
+    return true;
+}
+
+TransportNetwork::EdgeRange TransportNetwork::edgesOf(Index station) const
+{
+    const auto& row{m_edgeRows[station]};
+    const auto* first{m_edges.data() + row.first};
+    return EdgeRange{first, first + row.size};
+}
+
+bool TransportNetwork::search(Index source,
+                              Index target,
+                              PathSearchState& state,
+                              bool useBans) const
+{
+    // Dijkstra's algorithm. The heap may hold stale entries for stations whose distance
+    // was lowered after they were pushed: they are skipped when popped.
+    state.prepare(m_stations.size());
+    state.reach(source, 0, kInvalidIndex, kInvalidIndex);
+    state.m_heap.Push(0, source);
+    while (!state.m_heap.Empty())
+    {
+        const auto [distance, station] = state.m_heap.Top();
+        state.m_heap.Pop();
+        if (state.isSettled(station))
+        {
+            continue;
+        }
+
+        state.settle(station);
+        if (station == target)
+        {
+            return true;
+        }
+
+        const auto& row{m_edgeRows[station]};
+        for (auto idx{row.first}; idx < row.first + row.size; ++idx)
+        {
+            const auto& edge{m_edges[idx]};
+            const auto next{edge.nextStop};
+            if (useBans && (state.isEdgeBanned(idx) || state.isBanned(next)))
+            {
+                continue;
+            }
+
+            const auto nextDistance{distance + edge.travelTime};
+            if (!state.isReached(next) || nextDistance < state.m_distance[next])
+            {
+                state.reach(next, nextDistance, station, idx);
+                state.m_heap.Push(nextDistance, next);
+            }
+        }
+    }
+
+    return false;
+}
+
+bool TransportNetwork::addRouteToLine(const Route& route,
+                                      Index line,
+                                      std::vector<std::pair<Index, GraphEdge>>& newEdges)
+{
+    auto& lineInternal{m_lines[line]};
+    if (lineInternal.routes.find(route.id) != lineInternal.routes.end())
+    {
+        return false;
+    }
+
+    std::vector<Index> stops{};
+    stops.reserve(route.stops.size());
+    for (const auto& stop : route.stops)
+    {
+        const auto station{getStation(stop)};
+        if (station == kInvalidIndex)
+        {
+            return false;
+        }
+
+        stops.push_back(station);
+    }
+
+    const auto routeIndex{static_cast<Index>(m_routes.size())};
+    m_routes.emplace_back(route.id, route.name, line);
+    setRouteStops(routeIndex, stops, newEdges);
+    lineInternal.routes[route.id] = routeIndex;
+
+    return true;
+}
+
+void TransportNetwork::setRouteStops(Index route,
+                                     const std::vector<Index>& stops,
+                                     std::vector<std::pair<Index, GraphEdge>>& newEdges)
+{
+    auto& routeInternal{m_routes[route]};
+    routeInternal.positions.clear();
+    for (Index idx{0}; idx < stops.size(); ++idx)
+    {
+        routeInternal.positions.emplace(stops[idx], idx);
+        if (idx + 1 < stops.size())
+        {
+            newEdges.emplace_back(stops[idx], GraphEdge{route, stops[idx + 1], 0, idx});
+        }
+    }
+
+    // Keep the station-to-routes index up to date. A route that stops at a station more
+    // than once is only listed once: it is always the last one added to that station.
+    for (const auto stop : stops)
+    {
+        auto& routes{m_stations[stop].routes};
+        if (routes.empty() || routes.back().value != route)
+        {
+            routes.push_back(RouteHandle{route});
+        }
+    }
+
+    // All travel times start at zero, and so do the cumulative ones.
+    routeInternal.cumulativeTimes.assign(stops.size(), 0);
+    routeInternal.stops.assign(stops.begin(), stops.end());
+}
+
+void TransportNetwork::clearRouteStops(Index route)
+{
+    auto& routeInternal{m_routes[route]};
+    for (const auto stop : routeInternal.stops)
+    {
+        auto& routes{m_stations[stop].routes};
+        routes.erase(std::remove(routes.begin(), routes.end(), RouteHandle{route}), routes.end());
+    }
+    routeInternal.stops.clear();
+    routeInternal.cumulativeTimes.clear();
+    routeInternal.positions.clear();
+}
+
+void TransportNetwork::inheritTravelTimes(
+    Index route,
+    const std::vector<bool>& changedRoutes,
+    const std::unordered_map<std::uint64_t, unsigned int>& previousTimes)
+{
+    // Travel times belong to pairs of stations, in both directions: take them from the
+    // edges of the routes that did not change, or else from the edges that were just
+    // replaced. Forward edges win over backward ones.
+    auto unchangedTime{[this, &changedRoutes](Index from, Index to, unsigned int& travelTime) {
+        for (const auto& edge : edgesOf(from))
+        {
+            if (edge.nextStop == to && !changedRoutes[edge.route])
+            {
+                travelTime = edge.travelTime;
+                return true;
+            }
+        }
+        return false;
+    }};
+    auto previousTime{[&previousTimes](Index from, Index to, unsigned int& travelTime) {
+        const auto previous{previousTimes.find(EdgeKey(from, to))};
+        if (previous == previousTimes.end())
+        {
+            return false;
+        }
+        travelTime = previous->second;
+        return true;
+    }};
+
+    auto& routeInternal{m_routes[route]};
+    const auto& stops{routeInternal.stops};
+    for (Index idx{0}; idx + 1 < stops.size(); ++idx)
+    {
+        const auto from{stops[idx]};
+        const auto to{stops[idx + 1]};
+        unsigned int travelTime{0};
+        if (!unchangedTime(from, to, travelTime) && !unchangedTime(to, from, travelTime) &&
+            !previousTime(from, to, travelTime))
+        {
+            previousTime(to, from, travelTime);
+        }
+
+        // The route's own edge is found by its stop index.
+        const auto& row{m_edgeRows[from]};
+        for (auto edge{row.first}; edge < row.first + row.size; ++edge)
+        {
+            if (m_edges[edge].route == route && m_edges[edge].stopIndex == idx)
+            {
+                m_edges[edge].travelTime = travelTime;
+                break;
+            }
+        }
+        routeInternal.cumulativeTimes[idx + 1] = routeInternal.cumulativeTimes[idx] + travelTime;
+    }
+}
+
+void TransportNetwork::insertEdges(const std::vector<std::pair<Index, GraphEdge>>& newEdges)
+{
+    for (const auto& [from, edge] : newEdges)
+    {
+        auto& row{m_edgeRows[from]};
+        if (row.size == row.capacity)
+        {
+            // A full row moves to the end of the array with twice the room, unless it
+            // already is at the end and can grow where it is.
+            const auto capacity{std::max(2 * row.capacity, kMinEdgeRowCapacity)};
+            if (row.first + row.capacity == m_edges.size())
+            {
+                m_edges.resize(m_edges.size() + capacity - row.capacity);
+            }
+            else
+            {
+                const auto first{static_cast<Index>(m_edges.size())};
+                m_edges.resize(m_edges.size() + capacity);
+                std::copy_n(m_edges.begin() + row.first, row.size, m_edges.begin() + first);
+                row.first = first;
+            }
+            row.capacity = capacity;
+        }
+        m_edges[row.first + row.size++] = edge;
+    }
+    m_edgeCount += newEdges.size();
+
+    if (m_edges.size() - m_edgeCount > std::max(m_edgeCount, kMinSpareEdges))
+    {
+        compactEdges();
+    }
+}
+
+void TransportNetwork::removeEdges(const std::vector<Index>& stations,
+                                   const std::vector<bool>& droppedRoutes)
+{
+    auto isDropped{[&droppedRoutes](const GraphEdge& edge) {
+        return edge.route < droppedRoutes.size() && droppedRoutes[edge.route];
+    }};
+
+    for (const auto station : stations)
+    {
+        auto& row{m_edgeRows[station]};
+        const auto first{m_edges.begin() + row.first};
+        const auto last{std::remove_if(first, first + row.size, isDropped)};
+        const auto size{static_cast<Index>(last - first)};
+        m_edgeCount -= row.size - size;
+        row.size = size;
+    }
+}
+
+void TransportNetwork::compactEdges()
+{
+    std::pmr::vector<GraphEdge> edges(m_edgeCount, GetMemoryResource());
+    Index next{0};
+    for (auto& row : m_edgeRows)
+    {
+        std::copy_n(m_edges.begin() + row.first, row.size, edges.begin() + next);
+        row = EdgeRow{next, row.size, row.size};
+        next += row.size;
+    }
+    m_edges = std::move(edges);
 }
 
 } // namespace NetworkMonitor
@@ -0,0 +1,203 @@
+#include <network-monitor/contraction-hierarchy.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using NetworkMonitor::ContractionHierarchy;
+using NetworkMonitor::ContractionHierarchyIndex;
+using NetworkMonitor::Line;
+using NetworkMonitor::Route;
+using NetworkMonitor::Station;
+using NetworkMonitor::StationHandle;
+using NetworkMonitor::TransportNetwork;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_ContractionHierarchy);
+
+static std::string StationId(std::size_t idx)
+{
+    return "station_" + std::to_string(idx);
+}
+
+// Random network: every route runs through a random sequence of distinct stations, and comes
+// back the other way on a second route. Travel times are random.
+static TransportNetwork MakeRandomNetwork(std::size_t stationCount,
+                                          std::size_t routeCount,
+                                          std::mt19937& generator)
+{
+    TransportNetwork nw{};
+    for (std::size_t idx{0}; idx < stationCount; ++idx)
+    {
+        BOOST_REQUIRE(nw.AddStation(Station{StationId(idx), "Station Name"}));
+    }
+
+    std::uniform_int_distribution<std::size_t> station{0, stationCount - 1};
+    std::uniform_int_distribution<std::size_t> length{2, 12};
+    for (std::size_t idx{0}; idx < routeCount; ++idx)
+    {
+        std::vector<std::string> stops{};
+        const auto stopCount{length(generator)};
+        while (stops.size() < stopCount)
+        {
+            auto stop{StationId(station(generator))};
+            if (std::find(std::begin(stops), std::end(stops), stop) == std::end(stops))
+            {
+                stops.push_back(std::move(stop));
+            }
+        }
+        std::vector<std::string> reversed{stops.rbegin(), stops.rend()};
+
+        const auto lineId{"line_" + std::to_string(idx)};
+        Route outbound{"route_0", "Outbound", lineId, stops.front(), stops.back(), stops};
+        Route inbound{"route_1", "Inbound", lineId, stops.back(), stops.front(), reversed};
+        BOOST_REQUIRE(nw.AddLine(Line{lineId, "Line Name", {outbound, inbound}}));
+    }
+
+    std::uniform_int_distribution<unsigned int> travelTime{1, 20};
+    for (std::size_t from{0}; from < stationCount; ++from)
+    {
+        for (std::size_t to{from + 1}; to < stationCount; ++to)
+        {
+            nw.SetTravelTime(StationId(from), StationId(to), travelTime(generator));
+        }
+    }
+
+    return nw;
+}
+
+static void CheckAgainstDijkstra(const TransportNetwork& nw,
+                                 const ContractionHierarchy& hierarchy,
+                                 std::size_t stationCount,
+                                 std::mt19937& generator)
+{
+    std::uniform_int_distribution<std::size_t> station{0, stationCount - 1};
+    for (int query{0}; query < 300; ++query)
+    {
+        const auto from{nw.GetStationHandle(StationId(station(generator)))};
+        const auto to{nw.GetStationHandle(StationId(station(generator)))};
+        const auto expected{nw.GetFastestPath(from, to)};
+        const auto actual{hierarchy.GetFastestPath(from, to)};
+        BOOST_REQUIRE_EQUAL(expected.steps.empty(), actual.steps.empty());
+        if (expected.steps.empty())
+        {
+            continue;
+        }
+
+        BOOST_CHECK_EQUAL(expected.travelTime, actual.travelTime);
+
+        // The unpacked path must be a valid path of the network with that travel time.
+        BOOST_REQUIRE(actual.steps.front().station == from);
+        BOOST_REQUIRE(actual.steps.back().station == to);
+        unsigned int travelTime{0};
+        for (std::size_t idx{1}; idx < actual.steps.size(); ++idx)
+        {
+            const auto& step{actual.steps[idx]};
+            BOOST_REQUIRE(step.route.IsValid());
+            travelTime += nw.GetTravelTime(step.route, actual.steps[idx - 1].station, step.station);
+        }
+        BOOST_CHECK_EQUAL(travelTime, actual.travelTime);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(matches_dijkstra)
+{
+    std::mt19937 generator{7};
+    constexpr std::size_t kStations{150};
+    auto nw{MakeRandomNetwork(kStations, 40, generator)};
+
+    auto hierarchy{ContractionHierarchy::Build(ContractionHierarchy::ExtractGraph(nw))};
+    BOOST_CHECK_EQUAL(hierarchy.GetOrder().size(), kStations);
+    BOOST_CHECK_EQUAL(hierarchy.GetRevision(), nw.GetRevision());
+    CheckAgainstDijkstra(nw, hierarchy, kStations, generator);
+
+    // Unknown stations.
+    BOOST_CHECK(hierarchy.GetFastestPath(StationHandle{}, StationHandle{0}).steps.empty());
+}
+
+BOOST_AUTO_TEST_CASE(rebuild_with_order)
+{
+    std::mt19937 generator{11};
+    constexpr std::size_t kStations{100};
+    auto nw{MakeRandomNetwork(kStations, 30, generator)};
+    const auto first{ContractionHierarchy::Build(ContractionHierarchy::ExtractGraph(nw))};
+
+    // Change a lot of travel times and rebuild with the old order.
+    std::uniform_int_distribution<unsigned int> travelTime{1, 50};
+    for (std::size_t from{0}; from < kStations; from += 3)
+    {
+        for (std::size_t to{0}; to < kStations; to += 2)
+        {
+            nw.SetTravelTime(StationId(from), StationId(to), travelTime(generator));
+        }
+    }
+    const auto second{
+        ContractionHierarchy::Build(ContractionHierarchy::ExtractGraph(nw), first.GetOrder())};
+    BOOST_CHECK(second.GetOrder() == first.GetOrder());
+    CheckAgainstDijkstra(nw, second, kStations, generator);
+}
+
+BOOST_AUTO_TEST_CASE(shortcut_count)
+{
+    // 0 -> 1 -> 2 is faster than the direct arc 0 -> 2.
+    using Arc = ContractionHierarchy::Graph::Arc;
+    ContractionHierarchy::Graph graph{};
+    graph.stationCount = 3;
+    graph.arcs = {Arc{0, 1, 1, {}}, Arc{1, 2, 1, {}}, Arc{0, 2, 10, {}}};
+
+    // Contracting 1 first improves the direct arc in place, turning it into a shortcut.
+    const auto improved{ContractionHierarchy::Build(graph, {1, 0, 2})};
+    BOOST_CHECK_EQUAL(improved.GetShortcutCount(), 1);
+
+    // Without a direct arc, the shortcut is a new arc.
+    graph.arcs.pop_back();
+    const auto added{ContractionHierarchy::Build(graph, {1, 0, 2})};
+    BOOST_CHECK_EQUAL(added.GetShortcutCount(), 1);
+
+    // Contracting 1 last needs no shortcut.
+    const auto none{ContractionHierarchy::Build(graph, {0, 2, 1})};
+    BOOST_CHECK_EQUAL(none.GetShortcutCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(index_refresh)
+{
+    std::mt19937 generator{3};
+    constexpr std::size_t kStations{60};
+    auto nw{MakeRandomNetwork(kStations, 20, generator)};
+
+    ContractionHierarchyIndex index{};
+    BOOST_CHECK(index.Current() == nullptr);
+    index.Build(nw);
+    const auto first{index.Current()};
+    BOOST_REQUIRE(first != nullptr);
+
+    // Nothing changed: no rebuild.
+    BOOST_CHECK(!index.Refresh(nw));
+
+    // Make some connections much faster and rebuild in the background.
+    bool changed{false};
+    for (std::size_t from{0}; from < kStations; from += 4)
+    {
+        for (std::size_t to{0}; to < kStations; ++to)
+        {
+            changed |= nw.SetTravelTime(StationId(from), StationId(to), 0);
+        }
+    }
+    BOOST_REQUIRE(changed);
+    BOOST_CHECK(index.Refresh(nw));
+    index.Wait();
+
+    const auto second{index.Current()};
+    BOOST_REQUIRE(second != nullptr);
+    BOOST_CHECK(second != first);
+    BOOST_CHECK_EQUAL(second->GetRevision(), nw.GetRevision());
+    CheckAgainstDijkstra(nw, *second, kStations, generator);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_ContractionHierarchy
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
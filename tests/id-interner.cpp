@@ -0,0 +1,66 @@
+#include <network-monitor/id-interner.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <string_view>
+
+using NetworkMonitor::IdInterner;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_IdInterner);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    IdInterner interner{};
+    BOOST_CHECK_EQUAL(interner.Size(), 0);
+    BOOST_CHECK_EQUAL(interner.Find("station_000"), IdInterner::kInvalidHandle);
+
+    const auto handle0{interner.Intern("station_000")};
+    const auto handle1{interner.Intern("station_001")};
+    BOOST_CHECK_EQUAL(handle0, 0);
+    BOOST_CHECK_EQUAL(handle1, 1);
+    BOOST_CHECK_EQUAL(interner.Intern("station_000"), handle0);
+    BOOST_CHECK_EQUAL(interner.Size(), 2);
+
+    BOOST_CHECK_EQUAL(interner.Find("station_001"), handle1);
+    BOOST_CHECK_EQUAL(interner.Resolve(handle0), "station_000");
+    BOOST_CHECK_EQUAL(interner.Find(""), IdInterner::kInvalidHandle);
+}
+
+BOOST_AUTO_TEST_CASE(string_view_lookup)
+{
+    IdInterner interner{};
+    const auto handle{interner.Intern("station_042")};
+
+    // A view into a larger buffer must only match its own characters.
+    const std::string buffer{"/passengers/station_042/in"};
+    const std::string_view id{buffer.data() + 12, 11};
+    BOOST_CHECK_EQUAL(interner.Find(id), handle);
+    BOOST_CHECK_EQUAL(interner.Find(id.substr(0, 10)), IdInterner::kInvalidHandle);
+}
+
+BOOST_AUTO_TEST_CASE(growth)
+{
+    IdInterner interner{};
+    const unsigned int count{5000};
+    for (unsigned int idx{0}; idx < count; ++idx)
+    {
+        BOOST_REQUIRE_EQUAL(interner.Intern("id_" + std::to_string(idx)), idx);
+    }
+    BOOST_CHECK_EQUAL(interner.Size(), count);
+
+    // Every id is still found at its handle after the table was resized.
+    for (unsigned int idx{0}; idx < count; ++idx)
+    {
+        const auto id{"id_" + std::to_string(idx)};
+        BOOST_REQUIRE_EQUAL(interner.Find(id), idx);
+        BOOST_REQUIRE_EQUAL(interner.Resolve(idx), id);
+    }
+    BOOST_CHECK_EQUAL(interner.Find("id_" + std::to_string(count)), IdInterner::kInvalidHandle);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_IdInterner
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
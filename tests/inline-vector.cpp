@@ -0,0 +1,63 @@
+#include <network-monitor/inline-vector.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <numeric>
+#include <string>
+
+using NetworkMonitor::InlineVector;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_InlineVector);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    InlineVector<int, 2> vector{};
+    BOOST_CHECK(vector.Empty());
+    BOOST_CHECK(vector.begin() == vector.end());
+
+    vector.PushBack(1);
+    vector.PushBack(2);
+    BOOST_CHECK_EQUAL(vector.Size(), 2);
+    BOOST_CHECK(!vector.IsSpilled());
+    BOOST_CHECK_EQUAL(vector[1], 2);
+
+    // Past the inline capacity, every element moves to the heap.
+    vector.PushBack(3);
+    vector.PushBack(4);
+    BOOST_CHECK(vector.IsSpilled());
+    BOOST_CHECK_EQUAL(vector.Size(), 4);
+    BOOST_CHECK_EQUAL(vector[0], 1);
+    BOOST_CHECK_EQUAL(std::accumulate(vector.begin(), vector.end(), 0), 10);
+
+    vector.Clear();
+    BOOST_CHECK(vector.Empty());
+    BOOST_CHECK(!vector.IsSpilled());
+    vector.PushBack(5);
+    BOOST_CHECK_EQUAL(vector[0], 5);
+    BOOST_CHECK_EQUAL(vector.end() - vector.begin(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(copy_and_move)
+{
+    InlineVector<std::string, 1> vector{};
+    vector.PushBack("a");
+    auto inlineCopy{vector};
+    vector.PushBack("b");
+    BOOST_CHECK_EQUAL(inlineCopy.Size(), 1);
+    BOOST_CHECK_EQUAL(inlineCopy[0], "a");
+
+    // Copies and moves point at their own elements.
+    auto copy{vector};
+    auto moved{std::move(vector)};
+    BOOST_REQUIRE_EQUAL(copy.Size(), 2);
+    BOOST_CHECK(copy.begin() != moved.begin());
+    BOOST_CHECK_EQUAL(copy[1], "b");
+    BOOST_CHECK_EQUAL(moved[0], "a");
+    BOOST_CHECK_EQUAL(moved[1], "b");
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_InlineVector
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
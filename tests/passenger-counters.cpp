@@ -0,0 +1,106 @@
+#include <network-monitor/passenger-counters.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::PassengerCounters;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_PassengerCounters);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    PassengerCounters counters{4};
+    BOOST_CHECK_EQUAL(counters.ShardCount(), 4);
+    BOOST_CHECK_EQUAL(counters.Size(), 0);
+
+    counters.Resize(3);
+    BOOST_REQUIRE_EQUAL(counters.Size(), 3);
+    BOOST_CHECK_EQUAL(counters.Get(0), 0);
+
+    counters.Add(0, 1);
+    counters.Add(0, 1);
+    counters.Add(2, -1);
+    BOOST_CHECK_EQUAL(counters.Get(0), 2);
+    BOOST_CHECK_EQUAL(counters.Get(1), 0);
+    BOOST_CHECK_EQUAL(counters.Get(2), -1);
+
+    // The default number of shards stays small, whatever the machine.
+    BOOST_CHECK_GE(PassengerCounters::DefaultShardCount(), 1);
+    BOOST_CHECK_LE(PassengerCounters::DefaultShardCount(), PassengerCounters::kMaxDefaultShards);
+}
+
+BOOST_AUTO_TEST_CASE(resize_keeps_values)
+{
+    PassengerCounters counters{2};
+    counters.Resize(1);
+    counters.Add(0, 7);
+
+    // Grow well past the first cache line.
+    for (std::size_t size{2}; size < 1000; ++size)
+    {
+        counters.Resize(size);
+    }
+    counters.Add(999 - 1, 3);
+    BOOST_CHECK_EQUAL(counters.Get(0), 7);
+    BOOST_CHECK_EQUAL(counters.Get(998), 3);
+
+    // Counters dropped by a shrink start from zero again.
+    counters.Resize(1);
+    counters.Resize(1000);
+    BOOST_CHECK_EQUAL(counters.Get(0), 7);
+    BOOST_CHECK_EQUAL(counters.Get(998), 0);
+}
+
+BOOST_AUTO_TEST_CASE(copy_and_move)
+{
+    PassengerCounters counters{3};
+    counters.Resize(10);
+    counters.Add(5, 4);
+
+    PassengerCounters copy{counters};
+    copy.Add(5, 1);
+    BOOST_CHECK_EQUAL(counters.Get(5), 4);
+    BOOST_CHECK_EQUAL(copy.Get(5), 5);
+
+    PassengerCounters moved{std::move(copy)};
+    BOOST_CHECK_EQUAL(moved.Size(), 10);
+    BOOST_CHECK_EQUAL(moved.Get(5), 5);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_add)
+{
+    PassengerCounters counters{4};
+    counters.Resize(16);
+
+    constexpr int kThreads{8};
+    constexpr int kEventsPerThread{10000};
+    std::vector<std::thread> threads{};
+    for (int idx{0}; idx < kThreads; ++idx)
+    {
+        threads.emplace_back([&counters]() {
+            for (int event{0}; event < kEventsPerThread; ++event)
+            {
+                counters.Add(event % 16, 1);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    long long int total{0};
+    for (std::size_t counter{0}; counter < counters.Size(); ++counter)
+    {
+        total += counters.Get(counter);
+    }
+    BOOST_CHECK_EQUAL(total, kThreads * kEventsPerThread);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_PassengerCounters
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,217 @@
+#include <network-monitor/passenger-statistics.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::PassengerStatistics;
+using NetworkMonitor::PassengerStatisticsOptions;
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_PassengerStatistics);
+
+// Midnight, some day after the epoch.
+static const PassengerStatistics::TimePoint kMidnight{std::chrono::hours{24 * 20000}};
+
+BOOST_AUTO_TEST_CASE(disabled)
+{
+    PassengerStatistics statistics{};
+    BOOST_CHECK(!statistics.IsEnabled());
+    statistics.Resize(2);
+    statistics.Add(0, kMidnight, 1, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight, kMidnight + 1h).in, 0);
+    BOOST_CHECK(!statistics.GetBusiestWindow(0, 5min, kMidnight, kMidnight + 1h).has_value());
+    BOOST_CHECK_EQUAL(statistics.GetMemoryUsage(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(flow)
+{
+    PassengerStatistics statistics{PassengerStatisticsOptions{}};
+    BOOST_CHECK(statistics.IsEnabled());
+    statistics.Resize(2);
+
+    statistics.Add(0, kMidnight + 10min + 5s, 3, 1);
+    statistics.Add(0, kMidnight + 10min + 50s, 1, 0);
+    statistics.Add(0, kMidnight + 20min, 0, 2);
+    statistics.Add(1, kMidnight + 20min, 7, 0);
+
+    auto flow{statistics.GetFlow(0, kMidnight, kMidnight + 1h)};
+    BOOST_CHECK_EQUAL(flow.in, 4);
+    BOOST_CHECK_EQUAL(flow.out, 3);
+
+    // Ranges are rounded outward to whole minutes.
+    flow = statistics.GetFlow(0, kMidnight + 10min + 30s, kMidnight + 10min + 31s);
+    BOOST_CHECK_EQUAL(flow.in, 4);
+    BOOST_CHECK_EQUAL(flow.out, 1);
+
+    // The end of the range is excluded.
+    flow = statistics.GetFlow(0, kMidnight + 11min, kMidnight + 20min);
+    BOOST_CHECK_EQUAL(flow.in, 0);
+    BOOST_CHECK_EQUAL(flow.out, 0);
+
+    BOOST_CHECK_EQUAL(statistics.GetFlow(1, kMidnight, kMidnight + 1h).in, 7);
+}
+
+BOOST_AUTO_TEST_CASE(rings)
+{
+    PassengerStatisticsOptions options{};
+    options.minutes = 60;
+    options.hours = 24;
+    PassengerStatistics statistics{options};
+    statistics.Resize(1);
+
+    statistics.Add(0, kMidnight + 30min, 1, 0);
+    statistics.Add(0, kMidnight + 2h + 15min, 2, 0);
+
+    // Minute 30 has left the minute ring, so the hour ring answers, rounded to hours.
+    auto flow{statistics.GetFlow(0, kMidnight + 20min, kMidnight + 40min)};
+    BOOST_CHECK_EQUAL(flow.in, 1);
+    flow = statistics.GetFlow(0, kMidnight, kMidnight + 3h);
+    BOOST_CHECK_EQUAL(flow.in, 3);
+
+    // Minute 15 of the third hour is still in the minute ring.
+    flow = statistics.GetFlow(0, kMidnight + 2h + 10min, kMidnight + 2h + 20min);
+    BOOST_CHECK_EQUAL(flow.in, 2);
+
+    // Events older than the rings are not counted.
+    statistics.Add(0, kMidnight - 2h, 5, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight - 3h, kMidnight + 3h).in, 8);
+    statistics.Add(0, kMidnight - 1000h, 5, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight - 1001h, kMidnight + 3h).in, 8);
+
+    // A full lap later, the old buckets read as empty.
+    statistics.Add(0, kMidnight + 26h + 15min, 1, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight, kMidnight + 3h).in, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight + 26h, kMidnight + 27h).in, 1);
+}
+
+BOOST_AUTO_TEST_CASE(busiest_window)
+{
+    PassengerStatistics statistics{PassengerStatisticsOptions{}};
+    statistics.Resize(1);
+    for (int minute{0}; minute < 60; ++minute)
+    {
+        statistics.Add(0, kMidnight + std::chrono::minutes{minute}, 1, 0);
+    }
+    statistics.Add(0, kMidnight + 42min, 10, 0);
+    statistics.Add(0, kMidnight + 44min, 0, 10);
+
+    auto window{statistics.GetBusiestWindow(0, 5min, kMidnight, kMidnight + 24h)};
+    BOOST_REQUIRE(window.has_value());
+    BOOST_CHECK(window->start == kMidnight + 40min);
+    BOOST_CHECK_EQUAL(window->flow.in, 15);
+    BOOST_CHECK_EQUAL(window->flow.out, 10);
+
+    // Only windows inside the range are considered.
+    window = statistics.GetBusiestWindow(0, 5min, kMidnight, kMidnight + 30min);
+    BOOST_REQUIRE(window.has_value());
+    BOOST_CHECK(window->start == kMidnight);
+    BOOST_CHECK_EQUAL(window->flow.in, 5);
+
+    BOOST_CHECK(!statistics.GetBusiestWindow(0, 5min, kMidnight, kMidnight + 4min).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(resize_and_copy)
+{
+    PassengerStatistics statistics{PassengerStatisticsOptions{}};
+    statistics.Resize(1);
+    statistics.Add(0, kMidnight, 2, 0);
+    for (std::size_t size{2}; size < 100; ++size)
+    {
+        statistics.Resize(size);
+    }
+    statistics.Add(99 - 1, kMidnight, 3, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight, kMidnight + 1min).in, 2);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(98, kMidnight, kMidnight + 1min).in, 3);
+    BOOST_CHECK_GE(statistics.GetMemoryUsage(), 99 * (24 * 60 + 7 * 24) * sizeof(std::uint64_t));
+
+    PassengerStatistics copy{statistics};
+    statistics.Clear(0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight, kMidnight + 1min).in, 0);
+    BOOST_CHECK_EQUAL(copy.GetFlow(0, kMidnight, kMidnight + 1min).in, 2);
+
+    PassengerStatistics moved{std::move(copy)};
+    BOOST_CHECK_EQUAL(moved.Size(), 99);
+    BOOST_CHECK_EQUAL(moved.GetFlow(98, kMidnight, kMidnight + 1min).in, 3);
+}
+
+BOOST_AUTO_TEST_CASE(remap)
+{
+    PassengerStatistics statistics{PassengerStatisticsOptions{}};
+    statistics.Resize(3);
+    statistics.Add(0, kMidnight, 1, 0);
+    statistics.Add(2, kMidnight - 2h, 0, 3);
+
+    statistics.Remap({2, PassengerStatistics::kNoStation, 0, 42});
+    BOOST_CHECK_EQUAL(statistics.Size(), 4);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight - 2h, kMidnight - 1h).out, 3);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(1, kMidnight - 2h, kMidnight + 1min).in, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(2, kMidnight, kMidnight + 1min).in, 1);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(3, kMidnight, kMidnight + 1min).in, 0);
+
+    // The remapped statistics keep recording.
+    statistics.Add(3, kMidnight, 4, 0);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(3, kMidnight, kMidnight + 1min).in, 4);
+}
+
+BOOST_AUTO_TEST_CASE(saturation)
+{
+    PassengerStatistics statistics{PassengerStatisticsOptions{}};
+    statistics.Resize(1);
+    const long long int max{(1 << 24) - 1};
+
+    // Filling one direction past 24 bits must leave the other, and the lap, untouched.
+    statistics.Add(0, kMidnight, (1 << 24) - 2, 5);
+    statistics.Add(0, kMidnight, 3, 0);
+    auto flow{statistics.GetFlow(0, kMidnight, kMidnight + 1min)};
+    BOOST_CHECK_EQUAL(flow.in, max);
+    BOOST_CHECK_EQUAL(flow.out, 5);
+
+    statistics.Add(0, kMidnight, 1, std::numeric_limits<std::uint32_t>::max());
+    flow = statistics.GetFlow(0, kMidnight, kMidnight + 1min);
+    BOOST_CHECK_EQUAL(flow.in, max);
+    BOOST_CHECK_EQUAL(flow.out, max);
+
+    // Neighbouring minutes are not affected.
+    statistics.Add(0, kMidnight + 1min, 2, 2);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight + 1min, kMidnight + 2min).in, 2);
+    BOOST_CHECK_EQUAL(statistics.GetFlow(0, kMidnight, kMidnight + 2min).in, max + 2);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_add)
+{
+    PassengerStatistics statistics{PassengerStatisticsOptions{}};
+    statistics.Resize(1);
+
+    const int threadCount{4};
+    const int eventsPerThread{10000};
+    std::vector<std::thread> threads{};
+    for (int thread{0}; thread < threadCount; ++thread)
+    {
+        threads.emplace_back([&statistics]() {
+            for (int event{0}; event < eventsPerThread; ++event)
+            {
+                statistics.Add(0, kMidnight + std::chrono::seconds{event % 600}, 1, 1);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto flow{statistics.GetFlow(0, kMidnight, kMidnight + 10min)};
+    BOOST_CHECK_EQUAL(flow.in, threadCount * eventsPerThread);
+    BOOST_CHECK_EQUAL(flow.out, threadCount * eventsPerThread);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_PassengerStatistics
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,61 @@
+#include <network-monitor/path-search.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using NetworkMonitor::DaryHeap;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_DaryHeap);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    DaryHeap<unsigned int, int> heap{};
+    BOOST_CHECK(heap.Empty());
+
+    heap.Push(5, 50);
+    heap.Push(1, 10);
+    heap.Push(3, 30);
+    BOOST_REQUIRE_EQUAL(heap.Size(), 3);
+    BOOST_CHECK_EQUAL(heap.Top().first, 1);
+    BOOST_CHECK_EQUAL(heap.Top().second, 10);
+    heap.Pop();
+    BOOST_CHECK_EQUAL(heap.Top().first, 3);
+    heap.Pop();
+    BOOST_CHECK_EQUAL(heap.Top().first, 5);
+    heap.Pop();
+    BOOST_CHECK(heap.Empty());
+}
+
+BOOST_AUTO_TEST_CASE(sorted_output)
+{
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<unsigned int> distribution{0, 1000};
+    std::vector<unsigned int> keys(500);
+    std::generate(std::begin(keys), std::end(keys), [&]() { return distribution(generator); });
+
+    DaryHeap<unsigned int, std::size_t> heap{};
+    for (std::size_t idx{0}; idx < keys.size(); ++idx)
+    {
+        heap.Push(keys[idx], idx);
+    }
+
+    std::vector<unsigned int> popped{};
+    while (!heap.Empty())
+    {
+        popped.push_back(heap.Top().first);
+        heap.Pop();
+    }
+
+    std::sort(std::begin(keys), std::end(keys));
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        std::begin(popped), std::end(popped), std::begin(keys), std::end(keys));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_DaryHeap
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
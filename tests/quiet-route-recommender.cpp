@@ -0,0 +1,228 @@
+#include <network-monitor/quiet-route-recommender.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+using NetworkMonitor::Line;
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::QuietRouteOptions;
+using NetworkMonitor::QuietRouteRecommender;
+using NetworkMonitor::Route;
+using NetworkMonitor::Station;
+using NetworkMonitor::StationHandle;
+using NetworkMonitor::TransportNetwork;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_QuietRouteRecommender);
+
+static TransportNetwork MakeNetwork()
+{
+    // route0: 0 -1-> 1 -1-> 3
+    // route1: 0 -2-> 2 -2-> 3
+    TransportNetwork nw{};
+    bool ok{true};
+    for (int idx{0}; idx < 4; ++idx)
+    {
+        ok &= nw.AddStation(Station{
+            "station_00" + std::to_string(idx),
+            "Station Name " + std::to_string(idx),
+        });
+    }
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_003"},
+    };
+    Route route1{
+        "route_001",
+        "Route Name 1",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_002", "station_003"},
+    };
+    ok &= nw.AddLine(Line{"line_000", "Line Name", {route0, route1}});
+    ok &= nw.SetTravelTime("station_000", "station_001", 1);
+    ok &= nw.SetTravelTime("station_001", "station_003", 1);
+    ok &= nw.SetTravelTime("station_000", "station_002", 2);
+    ok &= nw.SetTravelTime("station_002", "station_003", 2);
+    BOOST_REQUIRE(ok);
+    return nw;
+}
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    auto nw{MakeNetwork()};
+    const auto station0{nw.GetStationHandle("station_000")};
+    const auto station1{nw.GetStationHandle("station_001")};
+    const auto station2{nw.GetStationHandle("station_002")};
+    const auto station3{nw.GetStationHandle("station_003")};
+
+    QuietRouteOptions options{};
+    options.crowdingWeight = 1.0;
+    QuietRouteRecommender recommender{options};
+
+    // With empty stations, the fastest path wins.
+    auto route{recommender.Recommend(nw, station0, station3)};
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->path.travelTime, 2);
+    BOOST_CHECK_EQUAL(route->crowding, 0);
+    BOOST_REQUIRE_EQUAL(route->path.steps.size(), 3);
+    BOOST_CHECK(route->path.steps[1].station == station1);
+
+    // The pair through 1 and 3 only is cached too.
+    BOOST_REQUIRE(recommender.Recommend(nw, station1, station3).has_value());
+    BOOST_CHECK_EQUAL(recommender.GetCachedPairCount(), 2);
+
+    // A crowd at station 1 makes the slower path quieter.
+    for (int idx{0}; idx < 5; ++idx)
+    {
+        BOOST_REQUIRE(nw.RecordPassengerEvent(station1, PassengerEvent::Type::In));
+    }
+    BOOST_CHECK_EQUAL(recommender.OnPassengerEvents(nw, {station1}), 2);
+    route = recommender.GetCached(station0, station3);
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->path.travelTime, 4);
+    BOOST_CHECK_EQUAL(route->crowding, 0);
+    BOOST_CHECK_EQUAL(route->score, 4.0);
+    BOOST_CHECK(route->path.steps[1].station == station2);
+
+    // Only the pairs going through station 2 are re-ranked.
+    for (int idx{0}; idx < 10; ++idx)
+    {
+        BOOST_REQUIRE(nw.RecordPassengerEvent(station2, PassengerEvent::Type::In));
+    }
+    BOOST_CHECK_EQUAL(recommender.OnPassengerEvents(nw, {station2}), 1);
+    route = recommender.GetCached(station0, station3);
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK(route->path.steps[1].station == station1);
+    BOOST_CHECK_EQUAL(route->crowding, 5);
+    BOOST_CHECK_EQUAL(route->score, 2.0 + 5.0);
+
+    // Unreachable and unknown pairs.
+    BOOST_CHECK(!recommender.Recommend(nw, station3, station0).has_value());
+    BOOST_CHECK(!recommender.Recommend(nw, station0, StationHandle{}).has_value());
+    BOOST_CHECK(!recommender.GetCached(station3, station0).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(layout_change)
+{
+    auto nw{MakeNetwork()};
+    const auto station0{nw.GetStationHandle("station_000")};
+    const auto station3{nw.GetStationHandle("station_003")};
+
+    QuietRouteRecommender recommender{};
+    auto route{recommender.Recommend(nw, station0, station3)};
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->path.travelTime, 2);
+
+    // New travel times drop the cached candidates.
+    BOOST_REQUIRE(nw.SetTravelTime("station_001", "station_003", 10));
+    BOOST_CHECK_EQUAL(recommender.OnPassengerEvents(nw, {station0}), 0);
+    BOOST_CHECK_EQUAL(recommender.GetCachedPairCount(), 0);
+    route = recommender.Recommend(nw, station0, station3);
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->path.travelTime, 4);
+}
+
+BOOST_AUTO_TEST_CASE(candidate_pool)
+{
+    // Five parallel routes from station_000 to station_009, through station_001 (2
+    // minutes) to station_005 (10 minutes).
+    TransportNetwork nw{};
+    bool ok{true};
+    ok &= nw.AddStation(Station{"station_000", ""});
+    ok &= nw.AddStation(Station{"station_009", ""});
+    std::vector<Route> routes{};
+    for (int idx{1}; idx <= 5; ++idx)
+    {
+        const auto station{"station_00" + std::to_string(idx)};
+        ok &= nw.AddStation(Station{station, ""});
+        routes.push_back(Route{"route_00" + std::to_string(idx),
+                               "",
+                               "line_000",
+                               "station_000",
+                               "station_009",
+                               {"station_000", station, "station_009"}});
+    }
+    ok &= nw.AddLine(Line{"line_000", "", routes});
+    for (unsigned int idx{1}; idx <= 5; ++idx)
+    {
+        const auto station{"station_00" + std::to_string(idx)};
+        ok &= nw.SetTravelTime("station_000", station, idx);
+        ok &= nw.SetTravelTime(station, "station_009", idx);
+    }
+    BOOST_REQUIRE(ok);
+    for (int idx{1}; idx <= 3; ++idx)
+    {
+        for (int passenger{0}; passenger < 100; ++passenger)
+        {
+            BOOST_REQUIRE(nw.RecordPassengerEvent(PassengerEvent{
+                "station_00" + std::to_string(idx), PassengerEvent::Type::In}));
+        }
+    }
+    const auto station0{nw.GetStationHandle("station_000")};
+    const auto station9{nw.GetStationHandle("station_009")};
+
+    // The three fastest paths are all crowded.
+    QuietRouteOptions options{};
+    options.candidateCount = 3;
+    QuietRouteRecommender narrow{options};
+    auto route{narrow.Recommend(nw, station0, station9)};
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->crowding, 100);
+
+    // The default pool reaches the quiet detour.
+    QuietRouteRecommender recommender{};
+    route = recommender.Recommend(nw, station0, station9);
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->crowding, 0);
+    BOOST_CHECK_EQUAL(route->path.travelTime, 8);
+}
+
+BOOST_AUTO_TEST_CASE(record_passenger_events)
+{
+    auto nw{MakeNetwork()};
+    const auto station0{nw.GetStationHandle("station_000")};
+    const auto station3{nw.GetStationHandle("station_003")};
+
+    QuietRouteRecommender recommender{};
+    BOOST_REQUIRE(recommender.Recommend(nw, station0, station3).has_value());
+
+    // Events recorded through the recommender re-rank the pairs they affect.
+    std::vector<PassengerEvent> events{};
+    for (int idx{0}; idx < 5; ++idx)
+    {
+        events.push_back(PassengerEvent{"station_001", PassengerEvent::Type::In});
+    }
+    events.push_back(PassengerEvent{"station_042", PassengerEvent::Type::In});
+    const auto failed{recommender.RecordPassengerEvents(nw, events)};
+    BOOST_REQUIRE_EQUAL(failed.size(), 1);
+    BOOST_CHECK_EQUAL(failed[0], 5);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_001"), 5);
+    auto route{recommender.GetCached(station0, station3)};
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->path.travelTime, 4);
+
+    // Events that cancel out change nothing.
+    const auto cancelled{recommender.RecordPassengerEvents(
+        nw,
+        {
+            {"station_002", PassengerEvent::Type::In},
+            {"station_002", PassengerEvent::Type::Out},
+        })};
+    BOOST_CHECK(cancelled.empty());
+    route = recommender.GetCached(station0, station3);
+    BOOST_REQUIRE(route.has_value());
+    BOOST_CHECK_EQUAL(route->path.travelTime, 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_QuietRouteRecommender
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
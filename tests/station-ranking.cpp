@@ -0,0 +1,196 @@
+#include <network-monitor/station-ranking.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::PassengerCounters;
+using NetworkMonitor::StationRanking;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_StationRanking);
+
+using Top = std::vector<std::pair<std::size_t, long long int>>;
+
+static void Add(PassengerCounters& counters,
+                StationRanking& ranking,
+                std::size_t station,
+                long long int delta)
+{
+    counters.Add(station, delta);
+    ranking.MarkChanged(station);
+}
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    PassengerCounters counters{2};
+    StationRanking ranking{};
+    counters.Resize(4);
+    ranking.Resize(4);
+    BOOST_CHECK_EQUAL(ranking.Size(), 4);
+
+    // Every station starts ranked, with a count of zero.
+    BOOST_CHECK(ranking.Top(2, counters) == (Top{{0, 0}, {1, 0}}));
+
+    Add(counters, ranking, 2, 5);
+    Add(counters, ranking, 1, 3);
+    Add(counters, ranking, 3, -1);
+    BOOST_CHECK(ranking.Top(10, counters) == (Top{{2, 5}, {1, 3}, {0, 0}, {3, -1}}));
+
+    // Only changed stations move.
+    Add(counters, ranking, 1, 4);
+    Add(counters, ranking, 1, -1);
+    BOOST_CHECK(ranking.Top(2, counters) == (Top{{1, 6}, {2, 5}}));
+
+    // Changes not marked are not seen.
+    counters.Add(0, 100);
+    BOOST_CHECK(ranking.Top(1, counters) == (Top{{1, 6}}));
+    ranking.MarkChanged(0);
+    BOOST_CHECK(ranking.Top(1, counters) == (Top{{0, 100}}));
+
+    BOOST_CHECK(ranking.Top(0, counters).empty());
+}
+
+BOOST_AUTO_TEST_CASE(ranked)
+{
+    PassengerCounters counters{1};
+    StationRanking ranking{};
+    counters.Resize(3);
+    ranking.Resize(3);
+    Add(counters, ranking, 0, 1);
+    Add(counters, ranking, 1, 2);
+    Add(counters, ranking, 2, 3);
+
+    ranking.SetRanked(2, false);
+    BOOST_CHECK(ranking.Top(3, counters) == (Top{{1, 2}, {0, 1}}));
+
+    // Changes to a station left out are ignored until it is put back.
+    Add(counters, ranking, 2, 1);
+    BOOST_CHECK(ranking.Top(3, counters) == (Top{{1, 2}, {0, 1}}));
+    ranking.SetRanked(2, true);
+    BOOST_CHECK(ranking.Top(1, counters) == (Top{{2, 4}}));
+
+    // Stations added later join the ranking.
+    counters.Resize(5);
+    ranking.Resize(5);
+    Add(counters, ranking, 4, 10);
+    BOOST_CHECK(ranking.Top(2, counters) == (Top{{4, 10}, {2, 4}}));
+}
+
+BOOST_AUTO_TEST_CASE(copy_and_move)
+{
+    PassengerCounters counters{1};
+    StationRanking ranking{};
+    counters.Resize(3);
+    ranking.Resize(3);
+    Add(counters, ranking, 1, 2);
+    BOOST_CHECK(ranking.Top(1, counters) == (Top{{1, 2}}));
+
+    // A change still pending is carried over.
+    Add(counters, ranking, 2, 5);
+    StationRanking copy{ranking};
+    BOOST_CHECK(copy.Top(1, counters) == (Top{{2, 5}}));
+    BOOST_CHECK(ranking.Top(1, counters) == (Top{{2, 5}}));
+
+    StationRanking moved{std::move(copy)};
+    Add(counters, moved, 0, 7);
+    BOOST_CHECK(moved.Top(3, counters) == (Top{{0, 7}, {2, 5}, {1, 2}}));
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_changes)
+{
+    PassengerCounters counters{4};
+    StationRanking ranking{};
+    const std::size_t stationCount{100};
+    counters.Resize(stationCount);
+    ranking.Resize(stationCount);
+
+    // Station i gets i events, while another thread keeps querying.
+    const int threadCount{4};
+    std::vector<std::thread> threads{};
+    for (int thread{0}; thread < threadCount; ++thread)
+    {
+        threads.emplace_back([&counters, &ranking, thread, stationCount]() {
+            for (std::size_t station{0}; station < stationCount; ++station)
+            {
+                for (std::size_t event{static_cast<std::size_t>(thread)}; event < station;
+                     event += threadCount)
+                {
+                    Add(counters, ranking, station, 1);
+                }
+            }
+        });
+    }
+    std::thread poller{[&ranking, &counters]() {
+        for (int poll{0}; poll < 100; ++poll)
+        {
+            ranking.Top(20, counters);
+        }
+    }};
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    poller.join();
+
+    const auto top{ranking.Top(3, counters)};
+    BOOST_CHECK(top == (Top{{99, 99}, {98, 98}, {97, 97}}));
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_add_and_top)
+{
+    // Writers race a reader that queries without pause, so flags are cleared while counts
+    // are being added. Once writers are done, a last query must see every count.
+    const std::size_t stationCount{8};
+    for (int round{0}; round < 50; ++round)
+    {
+        PassengerCounters counters{4};
+        StationRanking ranking{};
+        counters.Resize(stationCount);
+        ranking.Resize(stationCount);
+
+        std::atomic<bool> done{false};
+        std::thread reader{[&ranking, &counters, &done]() {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                ranking.Top(stationCount, counters);
+            }
+        }};
+
+        const int threadCount{4};
+        const int eventsPerThread{2000};
+        std::vector<std::thread> writers{};
+        for (int thread{0}; thread < threadCount; ++thread)
+        {
+            writers.emplace_back([&counters, &ranking, stationCount]() {
+                for (int event{0}; event < eventsPerThread; ++event)
+                {
+                    const auto station{static_cast<std::size_t>(event) % stationCount};
+                    Add(counters, ranking, station, static_cast<long long int>(station) + 1);
+                }
+            });
+        }
+        for (auto& writer : writers)
+        {
+            writer.join();
+        }
+        done.store(true, std::memory_order_relaxed);
+        reader.join();
+
+        Top expected{};
+        for (auto station{stationCount}; station-- > 0;)
+        {
+            const auto events{threadCount * eventsPerThread / static_cast<int>(stationCount)};
+            expected.emplace_back(station, events * static_cast<long long int>(station + 1));
+        }
+        BOOST_REQUIRE(ranking.Top(stationCount, counters) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StationRanking
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
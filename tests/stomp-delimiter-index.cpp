@@ -0,0 +1,109 @@
+#include <network-monitor/stomp-delimiter-index.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using NetworkMonitor::IsSupported;
+using NetworkMonitor::StompDelimiter;
+using NetworkMonitor::StompDelimiterIndex;
+using NetworkMonitor::StompScanKernel;
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_StompDelimiterIndex);
+
+static std::vector<StompScanKernel> SupportedKernels()
+{
+    std::vector<StompScanKernel> kernels{};
+    for (int idx{0}; idx < static_cast<int>(StompScanKernel::SIZE_OF_ENUM); ++idx)
+    {
+        if (const auto kernel{static_cast<StompScanKernel>(idx)}; IsSupported(kernel))
+        {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+static char ToChar(StompDelimiter delimiter)
+{
+    switch (delimiter)
+    {
+    case StompDelimiter::NEWLINE:
+        return '\n';
+    case StompDelimiter::COLON:
+        return ':';
+    default:
+        return '\0';
+    }
+}
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    const auto frame{"CONNECTED\nversion:1.2\n\n\0"s};
+    for (auto kernel : SupportedKernels())
+    {
+        BOOST_TEST_MESSAGE("Kernel " << kernel);
+        StompDelimiterIndex index{frame, kernel};
+        BOOST_CHECK_EQUAL(index.Size(), frame.size());
+        BOOST_CHECK_EQUAL(index.Find(StompDelimiter::NEWLINE, 0), 9);
+        BOOST_CHECK_EQUAL(index.Find(StompDelimiter::NEWLINE, 10), 21);
+        BOOST_CHECK_EQUAL(index.Find(StompDelimiter::COLON, 0), 17);
+        BOOST_CHECK_EQUAL(index.Find(StompDelimiter::NUL, 0), 23);
+        BOOST_CHECK_EQUAL(index.Find(StompDelimiter::COLON, 18), std::string::npos);
+        BOOST_CHECK_EQUAL(index.Find(StompDelimiter::NUL, 24), std::string::npos);
+        BOOST_CHECK_EQUAL(index.Count(StompDelimiter::NEWLINE, 0, frame.size()), 3);
+        BOOST_CHECK_EQUAL(index.Count(StompDelimiter::NEWLINE, 10, 23), 2);
+        BOOST_CHECK_EQUAL(index.Count(StompDelimiter::NEWLINE, 10, 10), 0);
+    }
+
+    StompDelimiterIndex empty{};
+    BOOST_CHECK_EQUAL(empty.Find(StompDelimiter::NUL, 0), std::string::npos);
+    BOOST_CHECK_EQUAL(empty.Count(StompDelimiter::NUL, 0, 10), 0);
+}
+
+BOOST_AUTO_TEST_CASE(kernels_agree)
+{
+    // Frames of every size around the block boundaries, made mostly of delimiters, must
+    // give the same answers as a plain search whatever the kernel.
+    std::mt19937 generator{42};
+    const std::string alphabet{"ab:\n\0"s};
+    std::uniform_int_distribution<std::size_t> pick{0, alphabet.size() - 1};
+    for (std::size_t size{0}; size < 700; size += (size < 140 ? 1 : 37))
+    {
+        std::string frame(size, ' ');
+        for (auto& ch : frame)
+        {
+            ch = alphabet[pick(generator)];
+        }
+
+        for (auto kernel : SupportedKernels())
+        {
+            StompDelimiterIndex index{frame, kernel};
+            for (int idx{0}; idx < static_cast<int>(StompDelimiter::SIZE_OF_ENUM); ++idx)
+            {
+                const auto delimiter{static_cast<StompDelimiter>(idx)};
+                std::size_t count{0};
+                for (std::size_t pos{0}; pos <= size; ++pos)
+                {
+                    BOOST_REQUIRE_EQUAL(index.Find(delimiter, pos),
+                                        frame.find(ToChar(delimiter), pos));
+                    BOOST_REQUIRE_EQUAL(index.Count(delimiter, 0, pos), count);
+                    if (pos < size && frame[pos] == ToChar(delimiter))
+                    {
+                        ++count;
+                    }
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompDelimiterIndex
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
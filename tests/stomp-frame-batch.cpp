@@ -0,0 +1,126 @@
+#include <network-monitor/stomp-frame-batch.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrameBatch;
+using NetworkMonitor::StompHeaders;
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_StompFrameBatch);
+
+BOOST_AUTO_TEST_CASE(several_frames)
+{
+    // Heart-beats before, between and after frames, and a body holding NUL octets.
+    const auto message{"RECEIPT\n"
+                       "receipt-id:1\n"
+                       "\n"
+                       "\0"
+                       "\n\n"
+                       "MESSAGE\n"
+                       "destination:/passengers\n"
+                       "content-length:3\n"
+                       "\n"
+                       "a\0b"
+                       "\0"
+                       "\n"
+                       "MESSAGE\n"
+                       "destination:/passengers\n"
+                       "\n"
+                       "{}\0\n"s};
+    StompError error;
+    StompFrameBatch batch{error, "\n"s + message};
+    BOOST_REQUIRE(error == StompError::OK);
+    BOOST_REQUIRE_EQUAL(batch.Size(), 3);
+
+    BOOST_CHECK(batch[0].GetCommand() == StompCommand::RECEIPT);
+    BOOST_CHECK_EQUAL(batch[0].GetHeaderValue(StompHeaders::RECEIPT_ID), "1");
+    BOOST_CHECK_EQUAL(batch[0].String(), "RECEIPT\nreceipt-id:1\n\n\0"s);
+    BOOST_CHECK(batch[1].GetCommand() == StompCommand::MESSAGE);
+    BOOST_CHECK_EQUAL(batch[1].GetBody(), "a\0b"s);
+    BOOST_CHECK_EQUAL(batch[2].GetHeaderValue(StompHeaders::DESTINATION), "/passengers");
+    BOOST_CHECK_EQUAL(batch[2].GetHeaderValue(StompHeaders::ID), "");
+    BOOST_CHECK_EQUAL(batch[2].GetBody(), "{}");
+
+    // Frames view into the shared buffer, which copies keep alive.
+    const auto& buffer{*batch.GetBuffer()};
+    for (const auto& frame : batch)
+    {
+        BOOST_CHECK(frame.GetBody().data() >= buffer.data());
+        BOOST_CHECK(frame.GetBody().data() < buffer.data() + buffer.size());
+    }
+    StompFrameBatch copy{batch};
+    batch = StompFrameBatch{};
+    BOOST_CHECK(batch.Empty());
+    BOOST_CHECK_EQUAL(copy[2].GetBody(), "{}");
+}
+
+BOOST_AUTO_TEST_CASE(shared_buffer)
+{
+    auto buffer{std::make_shared<const std::string>("ACK\nid:1\n\n\0NACK\nid:2\n\n\0"s)};
+    StompError error;
+    StompFrameBatch batch{error, buffer};
+    BOOST_REQUIRE(error == StompError::OK);
+    BOOST_REQUIRE_EQUAL(batch.Size(), 2);
+    BOOST_CHECK(batch.GetBuffer() == buffer);
+    BOOST_CHECK(batch[1].GetCommand() == StompCommand::NACK);
+    BOOST_CHECK_EQUAL(batch[1].GetHeaderValue(StompHeaders::ID), "2");
+
+    StompFrameBatch empty{error, "\n\n"s};
+    BOOST_CHECK(error == StompError::OK);
+    BOOST_CHECK(empty.Empty());
+}
+
+BOOST_AUTO_TEST_CASE(borrowed_buffer)
+{
+    // More frames than fit inline, viewing into a buffer the batch does not own.
+    std::string buffer{};
+    for (int idx{0}; idx < 5; ++idx)
+    {
+        buffer += "ACK\nid:" + std::to_string(idx) + "\n\n\0\n"s;
+    }
+    StompError error;
+    const StompFrameBatch batch{error, std::string_view{buffer}};
+    BOOST_REQUIRE(error == StompError::OK);
+    BOOST_REQUIRE_EQUAL(batch.Size(), 5);
+    BOOST_CHECK(batch.GetBuffer() == nullptr);
+    BOOST_CHECK_EQUAL(batch[4].GetHeaderValue(StompHeaders::ID), "4");
+    BOOST_CHECK_EQUAL(batch.end() - batch.begin(), 5);
+    for (const auto& frame : batch)
+    {
+        BOOST_CHECK(frame.String().data() >= buffer.data());
+        BOOST_CHECK(frame.String().data() < buffer.data() + buffer.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    auto check{[](std::string&& buffer, StompError expected, std::size_t frames) {
+        StompError error;
+        StompFrameBatch batch{error, std::move(buffer)};
+        BOOST_CHECK_EQUAL(error, expected);
+        BOOST_CHECK_EQUAL(batch.Size(), frames);
+    }};
+
+    // Frames before an invalid one are kept.
+    check("ACK\n\n\0NOPE\n\n\0"s, StompError::UNDEFINED_COMMAND, 1);
+    check("ACK\n\n\0ACK\n\n"s, StompError::UNTERMINATED_BODY, 1);
+    check("ACK\nid:1"s, StompError::MISSING_BODY_NEWLINE, 0);
+    check("ACK\nbad_header:1\n\n\0"s, StompError::BAD_HEADER, 0);
+    check("ACK\nid:\n\n\0"s, StompError::EMPTY_HEADER_VALUE, 0);
+    check("SEND\ncontent-length:4\n\nabc\0"s, StompError::WRONG_CONTENT_LENGTH, 0);
+    check("SEND\ncontent-length:2\n\nabc\0"s, StompError::WRONG_CONTENT_LENGTH, 0);
+    check("CONNECT\nhost:host.com\n\n\0"s, StompError::MISSING_ACCEPT_VERSION, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompFrameBatch
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
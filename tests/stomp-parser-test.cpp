@@ -1,12 +1,19 @@
 #include <boost/test/unit_test.hpp>
 
+#include <network-monitor/stomp-frame-batch.h>
 #include <network-monitor/stomp-frame.h>
 #include <network-monitor/stomp-parser.h>
 
+#include <memory>
+
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFrameBatch;
+using NetworkMonitor::StompFrameView;
+using NetworkMonitor::StompHeaders;
 using NetworkMonitor::StompParser;
+using NetworkMonitor::StompStreamParser;
 
 BOOST_AUTO_TEST_SUITE(network_monitor);
 
@@ -55,6 +62,44 @@ BOOST_AUTO_TEST_CASE(parse_invalid_command)
     BOOST_CHECK(StompError::UNDEFINED_COMMAND == ec);
 }
 
+BOOST_AUTO_TEST_CASE(parse_every_command)
+{
+    for (int idx{0}; idx < static_cast<int>(StompCommand::SIZE_OF_ENUM); ++idx)
+    {
+        const auto expected{static_cast<StompCommand>(idx)};
+        const auto name{ToString(expected)};
+        StompParser parser{name};
+        StompError ec;
+
+        auto cmd = parser.parseCommand(ec);
+        BOOST_CHECK(StompError::OK == ec);
+        BOOST_CHECK(expected == cmd);
+
+        // Same length, one character off.
+        auto misspelled{name};
+        misspelled.back() = 'X';
+        StompParser badParser{misspelled};
+        badParser.parseCommand(ec);
+        BOOST_CHECK(StompError::UNDEFINED_COMMAND == ec);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parse_every_header)
+{
+    for (int idx{0}; idx < static_cast<int>(StompHeaders::SIZE_OF_ENUM); ++idx)
+    {
+        const auto expected{static_cast<StompHeaders>(idx)};
+        const auto line{ToString(expected) + ":42\n"};
+        StompParser parser{line};
+        StompError ec;
+
+        auto header = parser.parseHeader(ec);
+        BOOST_CHECK(StompError::OK == ec);
+        BOOST_CHECK(expected == header.key);
+        BOOST_CHECK(header.value == "42");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(parse_two_valid_commands)
 {
     std::string_view command{"STOMP\nERROR\n"};
@@ -459,6 +504,25 @@ BOOST_AUTO_TEST_CASE(parse_newlines_after_body_content_length)
     // ...
 }
 
+BOOST_AUTO_TEST_CASE(parse_large_body)
+{
+    // Bodies spanning many scan blocks, full of colons and newlines.
+    std::string body{};
+    for (int idx{0}; idx < 200; ++idx)
+    {
+        body += "{\"station_id\":\"station_" + std::to_string(idx) + "\"}\n";
+    }
+    const auto plain{"MESSAGE\ndestination:/passengers\n\n"s + body + "\0\n\n"s};
+
+    StompError error;
+    StompFrame frame{error, std::string{plain}};
+    BOOST_REQUIRE(error == StompError::OK);
+    BOOST_CHECK(frame.GetBody() == body);
+
+    StompFrame junk{error, plain + "x"};
+    BOOST_CHECK(error == StompError::JUNK_AFTER_BODY);
+}
+
 BOOST_AUTO_TEST_CASE(parse_content_length_wrong_number)
 {
     std::string plain {
@@ -539,4 +603,299 @@ BOOST_AUTO_TEST_CASE(parse_required_headers)
 
 BOOST_AUTO_TEST_SUITE_END(); // class_StompParser
 
+BOOST_AUTO_TEST_SUITE(class_StompStreamParser);
+
+using namespace std::string_literals;
+
+static std::vector<StompFrame> ParseChunks(StompError& ec,
+                                           const std::string& input,
+                                           std::size_t chunkSize)
+{
+    StompStreamParser parser{};
+    std::vector<StompFrame> frames{};
+    for (std::size_t pos{0}; pos < input.size(); pos += chunkSize)
+    {
+        parser.Parse(ec, std::string_view{input}.substr(pos, chunkSize), [&frames](auto&& frame) {
+            frames.push_back(std::move(frame));
+        });
+        if (ec != StompError::OK)
+        {
+            break;
+        }
+    }
+    BOOST_CHECK(ec != StompError::OK || !parser.NeedsMoreData());
+    return frames;
+}
+
+BOOST_AUTO_TEST_CASE(single_frame)
+{
+    const auto plain{"CONNECT\n"
+                     "accept-version:42\n"
+                     "host:host.com\n"
+                     "\n"
+                     "Frame body\0"s};
+    StompStreamParser parser{};
+    StompError error;
+    std::vector<StompFrame> frames{};
+    auto count{parser.Parse(error, plain, [&frames](auto&& frame) {
+        frames.push_back(std::move(frame));
+    })};
+    BOOST_REQUIRE(error == StompError::OK);
+    BOOST_CHECK_EQUAL(count, 1);
+    BOOST_CHECK(!parser.NeedsMoreData());
+    BOOST_REQUIRE_EQUAL(frames.size(), 1);
+
+    auto& frame{frames.front()};
+    BOOST_CHECK(frame.GetCommand() == StompCommand::CONNECT);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeaders::ACCEPT_VERSION), "42");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeaders::HOST), "host.com");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "Frame body");
+    BOOST_CHECK_EQUAL(frame.String(), plain);
+}
+
+BOOST_AUTO_TEST_CASE(any_split)
+{
+    // Heart-beats between frames, a body holding NUL octets and a short frame.
+    const auto body{"a\0b\nc:d"s};
+    const auto input{"\n"
+                     "MESSAGE\n"
+                     "destination:/passengers\n"
+                     "content-length:"s +
+                     std::to_string(body.size()) +
+                     "\n\n" + body +
+                     "\0"
+                     "\n\n"
+                     "ACK\n"
+                     "id:1\n"
+                     "\n"
+                     "\0"
+                     "\n"s};
+    for (std::size_t chunkSize{1}; chunkSize <= input.size(); ++chunkSize)
+    {
+        StompError error;
+        auto frames{ParseChunks(error, input, chunkSize)};
+        BOOST_REQUIRE(error == StompError::OK);
+        BOOST_REQUIRE_EQUAL(frames.size(), 2);
+        BOOST_CHECK(frames[0].GetCommand() == StompCommand::MESSAGE);
+        BOOST_CHECK_EQUAL(frames[0].GetHeaderValue(StompHeaders::DESTINATION), "/passengers");
+        BOOST_CHECK_EQUAL(frames[0].GetBody(), body);
+        BOOST_CHECK(frames[1].GetCommand() == StompCommand::ACK);
+        BOOST_CHECK_EQUAL(frames[1].GetHeaderValue(StompHeaders::ID), "1");
+        BOOST_CHECK_EQUAL(frames[1].GetBody(), "");
+
+        // Copies of short frames must not view into the original.
+        auto copy{frames[1]};
+        frames.clear();
+        BOOST_CHECK_EQUAL(copy.GetHeaderValue(StompHeaders::ID), "1");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(needs_more_data)
+{
+    StompStreamParser parser{};
+    StompError error;
+    std::size_t frames{0};
+    auto onFrame{[&frames](auto&&) { ++frames; }};
+
+    BOOST_CHECK(!parser.NeedsMoreData());
+    parser.Parse(error, "\n\n", onFrame);
+    BOOST_CHECK(error == StompError::OK);
+    BOOST_CHECK(!parser.NeedsMoreData());
+
+    parser.Parse(error, "SEND\ndestination:/a\n\nbo", onFrame);
+    BOOST_CHECK(error == StompError::OK);
+    BOOST_CHECK(parser.NeedsMoreData());
+    BOOST_CHECK_EQUAL(frames, 0);
+
+    parser.Parse(error, "dy"s + "\0"s + "SEND\n"s, onFrame);
+    BOOST_CHECK(error == StompError::OK);
+    BOOST_CHECK(parser.NeedsMoreData());
+    BOOST_CHECK_EQUAL(frames, 1);
+
+    parser.Reset();
+    BOOST_CHECK(!parser.NeedsMoreData());
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    auto check{[](const std::string& input, StompError expected) {
+        for (std::size_t chunkSize : {std::size_t{1}, input.size()})
+        {
+            StompError error;
+            ParseChunks(error, input, chunkSize);
+            BOOST_CHECK_EQUAL(error, expected);
+        }
+    }};
+    check("CONNECTX\n", StompError::UNDEFINED_COMMAND);
+    check("SEND\ndestination\n", StompError::BAD_HEADER);
+    check("SEND\nbad_header:42\n", StompError::BAD_HEADER);
+    check("SEND\ndestination:\n", StompError::EMPTY_HEADER_VALUE);
+    check("SEND\ncontent-length:x\n", StompError::WRONG_CONTENT_LENGTH);
+    check("SEND\ncontent-length:2\n\nabc"s + "\0"s, StompError::WRONG_CONTENT_LENGTH);
+    check("CONNECT\nhost:host.com\n\n"s + "\0"s, StompError::MISSING_ACCEPT_VERSION);
+    check("CONNECT\naccept-version:42\n\n"s + "\0"s, StompError::MISSING_HOST);
+
+    // Errors stick until the parser is reset.
+    StompStreamParser parser{};
+    StompError error;
+    auto onFrame{[](auto&&) {}};
+    parser.Parse(error, "NOPE\n", onFrame);
+    BOOST_CHECK(error == StompError::UNDEFINED_COMMAND);
+    parser.Parse(error, "ACK\n\n"s + "\0"s, onFrame);
+    BOOST_CHECK(error == StompError::UNDEFINED_COMMAND);
+    parser.Reset();
+    BOOST_CHECK_EQUAL(parser.Parse(error, "ACK\n\n"s + "\0"s, onFrame), 1);
+    BOOST_CHECK(error == StompError::OK);
+}
+
+BOOST_AUTO_TEST_CASE(frame_too_large)
+{
+    auto onFrame{[](auto&&) {}};
+    StompError error;
+
+    // A content-length close to the largest size_t must not be trusted for allocation.
+    StompStreamParser parser{};
+    parser.Parse(error, "SEND\ncontent-length:18446744073709551000\n\n", onFrame);
+    BOOST_CHECK_EQUAL(error, StompError::FRAME_TOO_LARGE);
+
+    StompStreamParser small{64};
+    small.Parse(error, "SEND\ncontent-length:60\n\n", onFrame);
+    BOOST_CHECK_EQUAL(error, StompError::FRAME_TOO_LARGE);
+
+    // Frames without a content-length are bounded as they grow.
+    small.Reset();
+    small.Parse(error, "SEND\n\n" + std::string(100, 'x'), onFrame);
+    BOOST_CHECK_EQUAL(error, StompError::FRAME_TOO_LARGE);
+
+    // A large content-length within the limit is only reserved for in part, and frames
+    // still complete as bytes arrive.
+    StompStreamParser large{};
+    std::size_t frames{0};
+    const std::string body(1024 * 1024, 'x');
+    large.Parse(error,
+                "SEND\ncontent-length:" + std::to_string(body.size()) + "\n\n",
+                [&frames](auto&&) { ++frames; });
+    for (std::size_t pos{0}; pos < body.size(); pos += 4096)
+    {
+        large.Parse(error, std::string_view{body}.substr(pos, 4096), [&frames](auto&&) {
+            ++frames;
+        });
+    }
+    large.Parse(error, "\0"s, [&frames](auto&&) { ++frames; });
+    BOOST_CHECK_EQUAL(error, StompError::OK);
+    BOOST_CHECK_EQUAL(frames, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompStreamParser
+
+BOOST_AUTO_TEST_SUITE(class_StompFrameView);
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_CASE(borrow_buffer)
+{
+    const auto plain{"MESSAGE\n"
+                     "destination:/passengers\n"
+                     "receipt-id:42\n"
+                     "\n"
+                     "Frame body\0"
+                     "\n"s};
+    StompError error;
+    StompFrameView frame{error, plain};
+    BOOST_REQUIRE(error == StompError::OK);
+    BOOST_CHECK(frame.GetCommand() == StompCommand::MESSAGE);
+    BOOST_CHECK_EQUAL(frame.GetHeaders().Size(), 2);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeaders::RECEIPT_ID), "42");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "Frame body");
+    BOOST_CHECK_EQUAL(frame.String(), plain.substr(0, plain.size() - 1));
+
+    // Nothing is copied.
+    BOOST_CHECK(frame.GetBody().data() == plain.data() + plain.find("Frame body"));
+    BOOST_CHECK(frame.String().data() == plain.data());
+}
+
+BOOST_AUTO_TEST_CASE(to_owned)
+{
+    auto plain{std::make_unique<std::string>("ACK\nid:1\n\nok\0"s)};
+    StompError error;
+    StompFrameView view{error, *plain};
+    BOOST_REQUIRE(error == StompError::OK);
+
+    auto frame{view.ToOwned()};
+    plain.reset();
+    BOOST_CHECK(frame.GetCommand() == StompCommand::ACK);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeaders::ID), "1");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "ok");
+    BOOST_CHECK_EQUAL(frame.String(), "ACK\nid:1\n\nok\0"s);
+}
+
+BOOST_AUTO_TEST_CASE(many_headers)
+{
+    // More headers than the view keeps inline.
+    std::string plain{"MESSAGE\n"};
+    for (int idx{0}; idx < 10; ++idx)
+    {
+        plain += "id:" + std::to_string(idx) + "\n";
+    }
+    plain += "receipt-id:42\n\nbody\0"s;
+    StompError error;
+    StompFrameView view{error, plain};
+    BOOST_REQUIRE(error == StompError::OK);
+    BOOST_REQUIRE_EQUAL(view.GetHeaders().Size(), 11);
+    BOOST_CHECK_EQUAL(view.GetHeaders()[9].value, "9");
+    BOOST_CHECK_EQUAL(view.GetHeaderValue(StompHeaders::ID), "0");
+    BOOST_CHECK_EQUAL(view.GetHeaderValue(StompHeaders::RECEIPT_ID), "42");
+
+    auto frame{view.ToOwned()};
+    BOOST_CHECK_EQUAL(frame.GetHeaders().size(), 11);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeaders::RECEIPT_ID), "42");
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    StompError error;
+    StompFrameView junk{error, "ACK\n\n\0ACK\n\n\0"s};
+    BOOST_CHECK_EQUAL(error, StompError::JUNK_AFTER_BODY);
+    BOOST_CHECK(junk.GetCommand() == StompCommand::SIZE_OF_ENUM);
+
+    StompFrameView command{error, "ACKX\n\n\0"s};
+    BOOST_CHECK_EQUAL(error, StompError::UNDEFINED_COMMAND);
+
+    StompFrameView unterminated{error, "ACK\n\nbody"s};
+    BOOST_CHECK_EQUAL(error, StompError::UNTERMINATED_BODY);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompFrameView
+
+BOOST_AUTO_TEST_SUITE(all_parsers);
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_CASE(same_errors)
+{
+    // Every parser reports the same error for the same frame.
+    auto check{[](const std::string& input, StompError expected) {
+        StompError error;
+        StompFrame frame{error, std::string{input}};
+        BOOST_CHECK_EQUAL(error, expected);
+
+        StompParser parser{input};
+        parser.parseFrame(error);
+        BOOST_CHECK_EQUAL(error, expected);
+
+        StompStreamParser stream{};
+        stream.Parse(error, input, [](auto&&) {});
+        BOOST_CHECK_EQUAL(error, expected);
+
+        StompFrameBatch batch{error, std::string{input}};
+        BOOST_CHECK_EQUAL(error, expected);
+    }};
+    check("ACK\nid:1\n\n"s + "\0"s, StompError::OK);
+    check("ACK\nid\n\n"s + "\0"s, StompError::BAD_HEADER);
+    check("ACK\nbad_header:1\n\n"s + "\0"s, StompError::BAD_HEADER);
+    check("ACK\nid:\n\n"s + "\0"s, StompError::EMPTY_HEADER_VALUE);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // all_parsers
+
 BOOST_AUTO_TEST_SUITE_END(); // network_monitor
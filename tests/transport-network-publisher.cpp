@@ -0,0 +1,253 @@
+#include <network-monitor/transport-network-publisher.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::LayoutDiff;
+using NetworkMonitor::Line;
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::Route;
+using NetworkMonitor::Station;
+using NetworkMonitor::TransportNetwork;
+using NetworkMonitor::TransportNetworkPublisher;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_TransportNetworkPublisher);
+
+static TransportNetwork MakeNetwork()
+{
+    // route0: 0 ---> 1 ---> 2
+    TransportNetwork nw{};
+    bool ok{true};
+    ok &= nw.AddStation(Station{"station_000", "Station Name 0"});
+    ok &= nw.AddStation(Station{"station_001", "Station Name 1"});
+    ok &= nw.AddStation(Station{"station_002", "Station Name 2"});
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    ok &= nw.AddLine(Line{"line_000", "Line Name", {route0}});
+    ok &= nw.SetTravelTime("station_000", "station_001", 1);
+    ok &= nw.SetTravelTime("station_001", "station_002", 1);
+    BOOST_REQUIRE(ok);
+    return nw;
+}
+
+BOOST_AUTO_TEST_CASE(update)
+{
+    TransportNetworkPublisher publisher{MakeNetwork()};
+
+    auto before{publisher.Acquire()};
+    BOOST_REQUIRE(before != nullptr);
+    BOOST_CHECK_EQUAL(before->version, 0);
+    BOOST_CHECK_EQUAL(before->network.GetTravelTime("station_000", "station_001"), 1);
+
+    bool ok{publisher.Update(
+        [](auto& network) { return network.SetTravelTime("station_000", "station_001", 5); })};
+    BOOST_CHECK(ok);
+
+    // The snapshot held by a reader is immutable.
+    BOOST_CHECK_EQUAL(before->network.GetTravelTime("station_000", "station_001"), 1);
+
+    auto after{publisher.Acquire()};
+    BOOST_CHECK_EQUAL(after->version, 1);
+    BOOST_CHECK_EQUAL(after->network.GetTravelTime("station_000", "station_001"), 5);
+
+    // A failed mutation does not publish anything.
+    ok = publisher.Update(
+        [](auto& network) { return network.SetTravelTime("station_000", "station_002", 5); });
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(publisher.Acquire() == after);
+}
+
+BOOST_AUTO_TEST_CASE(publish)
+{
+    TransportNetworkPublisher publisher{};
+    BOOST_CHECK(!publisher.Acquire()->network.GetStationHandle("station_000").IsValid());
+
+    publisher.Publish(MakeNetwork());
+    auto snapshot{publisher.Acquire()};
+    BOOST_CHECK_EQUAL(snapshot->version, 1);
+    BOOST_CHECK(snapshot->network.GetStationHandle("station_000").IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_readers)
+{
+    TransportNetworkPublisher publisher{MakeNetwork()};
+
+    // Readers must always observe a consistent snapshot: the writer keeps both travel
+    // times of the route equal, so their difference is always zero.
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistencies{0};
+    std::vector<std::thread> readers{};
+    for (int idx{0}; idx < 4; ++idx)
+    {
+        readers.emplace_back([&publisher, &done, &inconsistencies]() {
+            while (!done.load())
+            {
+                auto snapshot{publisher.Acquire()};
+                const auto& network{snapshot->network};
+                if (network.GetTravelTime("station_000", "station_001") !=
+                    network.GetTravelTime("station_001", "station_002"))
+                {
+                    inconsistencies++;
+                }
+            }
+        });
+    }
+
+    for (unsigned int travelTime{2}; travelTime < 200; ++travelTime)
+    {
+        publisher.Update([travelTime](auto& network) {
+            bool ok{true};
+            ok &= network.SetTravelTime("station_000", "station_001", travelTime);
+            ok &= network.SetTravelTime("station_001", "station_002", travelTime);
+            return ok;
+        });
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    BOOST_CHECK_EQUAL(inconsistencies.load(), 0);
+    BOOST_CHECK_EQUAL(publisher.Acquire()->version, 198);
+}
+
+BOOST_AUTO_TEST_CASE(passenger_counts)
+{
+    TransportNetworkPublisher publisher{MakeNetwork()};
+    const auto station1{publisher.Acquire()->network.GetStationHandle("station_001")};
+
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount("station_001"), 0);
+    BOOST_CHECK(publisher.RecordPassengerEvent(station1, PassengerEvent::Type::In));
+    BOOST_CHECK(publisher.RecordPassengerEvent(PassengerEvent{"station_001",
+                                                              PassengerEvent::Type::In}));
+    BOOST_CHECK(publisher.RecordPassengerEvent(PassengerEvent{"station_002",
+                                                              PassengerEvent::Type::Out}));
+    BOOST_CHECK(!publisher.RecordPassengerEvent(PassengerEvent{"station_042",
+                                                               PassengerEvent::Type::In}));
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount(station1), 2);
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount("station_002"), -1);
+    BOOST_CHECK_THROW(publisher.GetPassengerCount("station_042"), std::runtime_error);
+
+    // Counts are not part of the snapshots.
+    BOOST_CHECK_EQUAL(publisher.Acquire()->network.GetPassengerCount(station1), 0);
+
+    // Updates keep the counts of the stations that stay, and reset the removed ones.
+    LayoutDiff diff{};
+    diff.addedStations.push_back(Station{"station_003", "Station Name 3"});
+    diff.removedLines.push_back("line_000");
+    diff.removedStations.push_back("station_002");
+    BOOST_REQUIRE(publisher.ApplyLayoutDiff(diff));
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount(station1), 2);
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount("station_003"), 0);
+    BOOST_CHECK(!publisher.RecordPassengerEvent(PassengerEvent{"station_002",
+                                                               PassengerEvent::Type::In}));
+    BOOST_CHECK(!publisher.ApplyLayoutDiff(diff));
+
+    // A station that comes back starts from zero.
+    LayoutDiff comeback{};
+    comeback.addedStations.push_back(Station{"station_002", "Station Name 2"});
+    BOOST_REQUIRE(publisher.ApplyLayoutDiff(comeback));
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount("station_002"), 0);
+
+    // Plain updates do not touch the counts.
+    BOOST_REQUIRE(publisher.Update([](auto& network) {
+        return network.AddStation(Station{"station_004", "Station Name 4"});
+    }));
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount(station1), 2);
+
+    // A new network starts over from its own counts.
+    auto network{MakeNetwork()};
+    network.RecordPassengerEvent(PassengerEvent{"station_000", PassengerEvent::Type::In});
+    publisher.Publish(std::move(network));
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount(station1), 0);
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount("station_000"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_passenger_counts)
+{
+    TransportNetworkPublisher publisher{MakeNetwork()};
+    const auto before{publisher.Acquire()};
+    BOOST_CHECK(before->RecordPassengerEvent(PassengerEvent{"station_001",
+                                                            PassengerEvent::Type::In}));
+
+    // Snapshots share their counts, even across a block that grew with the network.
+    BOOST_REQUIRE(publisher.Update([](auto& network) {
+        bool ok{true};
+        for (int idx{0}; idx < 200; ++idx)
+        {
+            ok &= network.AddStation(Station{"station_" + std::to_string(100 + idx), ""});
+        }
+        return ok;
+    }));
+    const auto after{publisher.Acquire()};
+    BOOST_CHECK(after->passengerCounts != before->passengerCounts);
+    BOOST_CHECK(before->RecordPassengerEvent(PassengerEvent{"station_001",
+                                                            PassengerEvent::Type::In}));
+    BOOST_CHECK(after->RecordPassengerEvent(PassengerEvent{"station_001",
+                                                           PassengerEvent::Type::In}));
+    BOOST_CHECK(after->RecordPassengerEvent(PassengerEvent{"station_299",
+                                                           PassengerEvent::Type::In}));
+    BOOST_CHECK_EQUAL(after->GetPassengerCount("station_001"), 3);
+    BOOST_CHECK_EQUAL(after->GetPassengerCount("station_299"), 1);
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount("station_001"), 3);
+
+    // An old snapshot only knows about its own stations.
+    BOOST_CHECK(!before->RecordPassengerEvent(PassengerEvent{"station_299",
+                                                             PassengerEvent::Type::In}));
+    BOOST_CHECK_THROW(before->GetPassengerCount("station_299"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_passenger_events)
+{
+    TransportNetworkPublisher publisher{MakeNetwork()};
+
+    // Events recorded while writers publish new snapshots, and while new stations are
+    // added, are never lost.
+    constexpr int kRecorders{4};
+    constexpr int kEvents{5000};
+    std::vector<std::thread> recorders{};
+    for (int idx{0}; idx < kRecorders; ++idx)
+    {
+        recorders.emplace_back([&publisher]() {
+            for (int event{0}; event < kEvents; ++event)
+            {
+                publisher.RecordPassengerEvent(
+                    PassengerEvent{"station_001", PassengerEvent::Type::In});
+                publisher.RecordPassengerEvent(
+                    PassengerEvent{"station_100", PassengerEvent::Type::In});
+            }
+        });
+    }
+
+    for (int idx{0}; idx < 100; ++idx)
+    {
+        publisher.Update([idx](auto& network) {
+            return network.AddStation(Station{"station_" + std::to_string(100 + idx), ""});
+        });
+    }
+    for (auto& recorder : recorders)
+    {
+        recorder.join();
+    }
+
+    BOOST_CHECK_EQUAL(publisher.GetPassengerCount("station_001"), kRecorders * kEvents);
+    BOOST_CHECK_LE(publisher.GetPassengerCount("station_100"), kRecorders * kEvents);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_TransportNetworkPublisher
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
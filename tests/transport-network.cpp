@@ -2,14 +2,25 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <memory_resource>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 using NetworkMonitor::Id;
+using NetworkMonitor::JourneyPlannerOptions;
 using NetworkMonitor::Line;
 using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerStatisticsOptions;
 using NetworkMonitor::Route;
 using NetworkMonitor::Station;
 using NetworkMonitor::TransportNetwork;
@@ -206,6 +217,176 @@ BOOST_AUTO_TEST_CASE(duplicate)
     BOOST_CHECK(!ok);
 }
 
+BOOST_AUTO_TEST_CASE(missing_station)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    // A line is rejected as a whole if any of its routes references an unknown station.
+    // route0: 0 ---> 1
+    // route1: 1 ---> 2 (station 2 is not in the network)
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    };
+    Route route1{
+        "route_001",
+        "Route Name 1",
+        "line_000",
+        "station_001",
+        "station_002",
+        {"station_001", "station_002"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route0, route1},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_CHECK(!ok);
+
+    // No edge of the rejected line was left behind.
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation(station0.id).size(), 0);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation(station1.id).size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(batch)
+{
+    TransportNetwork nw{};
+    bool ok{true};
+
+    // line0: 0 ---> 1 ---> 2
+    // line1: 2 ---> 1
+    // line2: 2 ---> 3 (station 3 is not in the network)
+    for (int idx{0}; idx < 3; ++idx)
+    {
+        ok &= nw.AddStation(Station{
+            "station_00" + std::to_string(idx),
+            "Station Name " + std::to_string(idx),
+        });
+    }
+    BOOST_REQUIRE(ok);
+    const std::vector<Line> lines{
+        Line{"line_000",
+             "Line Name 0",
+             {Route{"route_000",
+                    "Route Name 0",
+                    "line_000",
+                    "station_000",
+                    "station_002",
+                    {"station_000", "station_001", "station_002"}}}},
+        Line{"line_001",
+             "Line Name 1",
+             {Route{"route_001",
+                    "Route Name 1",
+                    "line_001",
+                    "station_002",
+                    "station_001",
+                    {"station_002", "station_001"}}}},
+        Line{"line_002",
+             "Line Name 2",
+             {Route{"route_002",
+                    "Route Name 2",
+                    "line_002",
+                    "station_002",
+                    "station_003",
+                    {"station_002", "station_003"}}}},
+    };
+
+    // The lines before the bad one are added, with all their edges.
+    const auto revision{nw.GetRevision()};
+    BOOST_CHECK_EQUAL(nw.AddLines(lines), 2);
+    BOOST_CHECK_GT(nw.GetRevision(), revision);
+    BOOST_CHECK(!nw.GetLineHandle("line_002").IsValid());
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_001").size(), 2);
+    BOOST_CHECK(nw.SetTravelTime("station_000", "station_001", 1));
+    BOOST_CHECK(nw.SetTravelTime("station_001", "station_002", 2));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_001", "route_001", "station_002", "station_001"),
+                      2);
+    BOOST_CHECK_EQUAL(nw.GetFastestPath("station_000", "station_002").travelTime, 3);
+
+    // Nothing to add leaves the network as it is.
+    const auto unchanged{nw.GetRevision()};
+    BOOST_CHECK_EQUAL(nw.AddLines({}), 0);
+    BOOST_CHECK_EQUAL(nw.AddLines({lines[0]}), 0);
+    BOOST_CHECK_EQUAL(nw.GetRevision(), unchanged);
+}
+
+BOOST_AUTO_TEST_CASE(one_at_a_time)
+{
+    TransportNetwork nw{};
+    bool ok{true};
+
+    // line i, route i: i ---> hub ---> i + 1
+    // The rows of the hub and of the other stations grow one line at a time.
+    constexpr int kLines{1500};
+    ok &= nw.AddStation(Station{"station_hub", "Hub"});
+    for (int idx{0}; idx <= kLines; ++idx)
+    {
+        ok &= nw.AddStation(Station{"station_" + std::to_string(idx), ""});
+    }
+    for (int idx{0}; idx < kLines; ++idx)
+    {
+        const auto id{std::to_string(idx)};
+        ok &= nw.AddLine(Line{"line_" + id,
+                              "",
+                              {Route{"route_" + id,
+                                     "",
+                                     "line_" + id,
+                                     "station_" + id,
+                                     "station_" + std::to_string(idx + 1),
+                                     {"station_" + id,
+                                      "station_hub",
+                                      "station_" + std::to_string(idx + 1)}}}});
+    }
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_hub").size(), kLines);
+    BOOST_CHECK(nw.SetTravelTime("station_0", "station_hub", 1));
+    BOOST_CHECK(nw.SetTravelTime("station_hub", "station_5", 2));
+    BOOST_CHECK(nw.SetTravelTime("station_hub", "station_1000", 7));
+    BOOST_CHECK_EQUAL(nw.GetFastestPath("station_0", "station_5").travelTime, 3);
+    BOOST_CHECK_EQUAL(nw.GetFastestPath("station_0", "station_1000").travelTime, 8);
+
+    // Dropping most of the lines squeezes the edge array.
+    const auto edges{nw.GetMemoryStats().edges};
+    NetworkMonitor::LayoutDiff diff{};
+    for (int idx{10}; idx < kLines; ++idx)
+    {
+        diff.removedLines.push_back("line_" + std::to_string(idx));
+    }
+    diff.addedRoutes.push_back(Route{
+        "route_extra",
+        "",
+        "line_0",
+        "station_hub",
+        "station_0",
+        {"station_hub", "station_0"},
+    });
+    BOOST_REQUIRE(nw.ApplyLayoutDiff(diff));
+    BOOST_CHECK_LT(nw.GetMemoryStats().edges, edges);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_hub").size(), 11);
+    BOOST_CHECK_EQUAL(nw.GetFastestPath("station_0", "station_5").travelTime, 3);
+    BOOST_CHECK(nw.GetFastestPath("station_0", "station_1000").steps.empty());
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_0", "route_extra", "station_hub", "station_0"),
+                      1);
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // AddLine
 
 BOOST_AUTO_TEST_SUITE(PassengerEvents);
@@ -287,6 +468,199 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(nw.GetPassengerCount(station2.id), -1);
 }
 
+BOOST_AUTO_TEST_CASE(batch)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    BOOST_REQUIRE(ok);
+
+    // Unknown stations fail individually without stopping the batch.
+    using EventType = PassengerEvent::Type;
+    std::vector<PassengerEvent> events{
+        {station0.id, EventType::In},
+        {station0.id, EventType::In},
+        {"station_42", EventType::In},
+        {station1.id, EventType::Out},
+        {station0.id, EventType::Out},
+        {station0.id, EventType::In},
+        {"station_43", EventType::Out},
+        {station1.id, EventType::Out},
+    };
+    auto failed{nw.RecordPassengerEvents(events)};
+    BOOST_REQUIRE_EQUAL(failed.size(), 2);
+    BOOST_CHECK_EQUAL(failed[0], 2);
+    BOOST_CHECK_EQUAL(failed[1], 6);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station0.id), 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1.id), -2);
+
+    // An empty batch is a no-op.
+    failed = nw.RecordPassengerEvents({});
+    BOOST_CHECK(failed.empty());
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station0.id), 2);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    BOOST_REQUIRE(ok);
+
+    // Several threads record events at the same time.
+    using EventType = PassengerEvent::Type;
+    constexpr int kThreads{4};
+    constexpr int kEventsPerThread{5000};
+    std::vector<std::thread> threads{};
+    for (int idx{0}; idx < kThreads; ++idx)
+    {
+        threads.emplace_back([&nw, &station0, &station1]() {
+            for (int event{0}; event < kEventsPerThread; ++event)
+            {
+                nw.RecordPassengerEvent({station0.id, EventType::In});
+                nw.RecordPassengerEvent({station1.id, EventType::Out});
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station0.id), kThreads * kEventsPerThread);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1.id), -kThreads * kEventsPerThread);
+}
+
+BOOST_AUTO_TEST_CASE(statistics)
+{
+    TransportNetwork nw{};
+    BOOST_REQUIRE(nw.AddStation(Station{"station_000", "Station Name 0"}));
+    BOOST_REQUIRE(nw.AddStation(Station{"station_001", "Station Name 1"}));
+    const auto station0{nw.GetStationHandle("station_000")};
+    const auto station1{nw.GetStationHandle("station_001")};
+
+    using EventType = PassengerEvent::Type;
+    const std::chrono::system_clock::time_point midnight{std::chrono::hours{24 * 20000}};
+    const auto day{midnight + std::chrono::hours{24}};
+
+    // Statistics are off until enabled.
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station0, EventType::In, midnight));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station0, midnight, day).in, 0);
+    BOOST_CHECK_EQUAL(nw.GetMemoryStats().passengerStatistics, 0);
+
+    nw.EnablePassengerStatistics();
+    BOOST_CHECK_GT(nw.GetMemoryStats().passengerStatistics, 0);
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station0, EventType::In, midnight));
+    BOOST_REQUIRE(nw.RecordPassengerEvent(
+        PassengerEvent{"station_000", EventType::Out, midnight + std::chrono::minutes{3}}));
+
+    // Batches keep the ins and outs apart, even when they cancel out.
+    const auto failed{nw.RecordPassengerEvents({
+        {"station_001", EventType::In, midnight + std::chrono::minutes{10}},
+        {"station_042", EventType::In, midnight},
+        {"station_001", EventType::Out, midnight + std::chrono::minutes{11}},
+    })};
+    BOOST_CHECK_EQUAL(failed.size(), 1);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1), 0);
+
+    auto flow{nw.GetPassengerFlow(station0, midnight, day)};
+    BOOST_CHECK_EQUAL(flow.in, 1);
+    BOOST_CHECK_EQUAL(flow.out, 1);
+    flow = nw.GetPassengerFlow(station1, midnight, day);
+    BOOST_CHECK_EQUAL(flow.in, 1);
+    BOOST_CHECK_EQUAL(flow.out, 1);
+
+    const auto window{nw.GetBusiestWindow(station1, std::chrono::minutes{5}, midnight, day)};
+    BOOST_REQUIRE(window.has_value());
+    BOOST_CHECK(window->start == midnight + std::chrono::minutes{7});
+    BOOST_CHECK_EQUAL(window->flow.in + window->flow.out, 2);
+
+    // Stations added later get their history too.
+    BOOST_REQUIRE(nw.AddStation(Station{"station_002", "Station Name 2"}));
+    const auto station2{nw.GetStationHandle("station_002")};
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station2, EventType::In, midnight));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station2, midnight, day).in, 1);
+
+    BOOST_CHECK_THROW(nw.GetPassengerFlow(NetworkMonitor::StationHandle{}, midnight, day),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(busiest_stations)
+{
+    TransportNetwork nw{};
+    for (int idx{0}; idx < 4; ++idx)
+    {
+        BOOST_REQUIRE(nw.AddStation(Station{
+            "station_00" + std::to_string(idx),
+            "Station Name " + std::to_string(idx),
+        }));
+    }
+    const auto station0{nw.GetStationHandle("station_000")};
+    const auto station1{nw.GetStationHandle("station_001")};
+    const auto station2{nw.GetStationHandle("station_002")};
+
+    using EventType = PassengerEvent::Type;
+    for (int idx{0}; idx < 3; ++idx)
+    {
+        BOOST_REQUIRE(nw.RecordPassengerEvent(station1, EventType::In));
+    }
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station2, EventType::In));
+    BOOST_REQUIRE(nw.RecordPassengerEvents({
+                                               {"station_000", EventType::In},
+                                               {"station_000", EventType::In},
+                                               {"station_002", EventType::Out},
+                                           })
+                      .empty());
+
+    auto busiest{nw.GetBusiestStations(2)};
+    BOOST_REQUIRE_EQUAL(busiest.size(), 2);
+    BOOST_CHECK(busiest[0].station == station1);
+    BOOST_CHECK_EQUAL(busiest[0].passengerCount, 3);
+    BOOST_CHECK(busiest[1].station == station0);
+    BOOST_CHECK_EQUAL(busiest[1].passengerCount, 2);
+
+    // Station 2 is back to zero, and ties go to the lowest handle.
+    busiest = nw.GetBusiestStations(10);
+    BOOST_REQUIRE_EQUAL(busiest.size(), 4);
+    BOOST_CHECK(busiest[2].station == station2);
+    BOOST_CHECK_EQUAL(busiest[2].passengerCount, 0);
+
+    // A copy keeps the ranking.
+    const auto copy{nw};
+    BOOST_CHECK(copy.GetBusiestStations(1)[0].station == station1);
+
+    // Removed stations drop out of the ranking.
+    NetworkMonitor::LayoutDiff diff{};
+    diff.removedStations.push_back("station_001");
+    BOOST_REQUIRE(nw.ApplyLayoutDiff(diff));
+    BOOST_CHECK_EQUAL(nw.GetBusiestStations(10).size(), 3);
+    busiest = nw.GetBusiestStations(1);
+    BOOST_REQUIRE_EQUAL(busiest.size(), 1);
+    BOOST_CHECK(busiest[0].station == station0);
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // PassengerEvents
 
 BOOST_AUTO_TEST_SUITE(GetRoutesServingStation);
@@ -352,6 +726,83 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(routes.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(shared_stations)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    // Add a line with 2 routes, one of them visiting a station twice.
+    // route0: 0 ---> 1 ---> 2
+    // route1: 2 ---> 1 ---> 3 ---> 1
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    Station station2{
+        "station_002",
+        "Station Name 2",
+    };
+    Station station3{
+        "station_003",
+        "Station Name 3",
+    };
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    Route route1{
+        "route_001",
+        "Route Name 1",
+        "line_000",
+        "station_002",
+        "station_001",
+        {"station_002", "station_001", "station_003", "station_001"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route0, route1},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    ok &= nw.AddStation(station3);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_REQUIRE(ok);
+
+    std::vector<Id> routes{};
+    routes = nw.GetRoutesServingStation(station0.id);
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK(routes[0] == route0.id);
+    routes = nw.GetRoutesServingStation(station1.id);
+    BOOST_REQUIRE_EQUAL(routes.size(), 2);
+    BOOST_CHECK(routes[0] == route0.id);
+    BOOST_CHECK(routes[1] == route1.id);
+    routes = nw.GetRoutesServingStation(station2.id);
+    BOOST_REQUIRE_EQUAL(routes.size(), 2);
+    BOOST_CHECK(routes[0] == route0.id);
+    BOOST_CHECK(routes[1] == route1.id);
+    routes = nw.GetRoutesServingStation(station3.id);
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK(routes[0] == route1.id);
+
+    // The handle-based query returns the cached list itself.
+    const auto handle1{nw.GetStationHandle(station1.id)};
+    const auto& cached{nw.GetRoutesServingStation(handle1)};
+    BOOST_CHECK_EQUAL(&cached, &nw.GetRoutesServingStation(handle1));
+    BOOST_CHECK(cached[1] == nw.GetRouteHandle(line.id, route1.id));
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // GetRoutesServingStation
 
 BOOST_AUTO_TEST_SUITE(TravelTime);
@@ -509,7 +960,1260 @@ BOOST_AUTO_TEST_CASE(over_route)
     BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station1.id, station1.id), 0);
 }
 
-BOOST_AUTO_TEST_SUITE_END(); // TravelTime
+BOOST_AUTO_TEST_CASE(over_route_updates)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    // Add a line with 1 route that visits a station twice.
+    // route0: 0 ---> 1 ---> 2 ---> 1 ---> 3
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    Station station2{
+        "station_002",
+        "Station Name 2",
+    };
+    Station station3{
+        "station_003",
+        "Station Name 3",
+    };
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_001", "station_003"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route0},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    ok &= nw.AddStation(station3);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_REQUIRE(ok);
+
+    // Set all travel times. 1 <-> 2 covers two edges of the route.
+    ok = true;
+    ok &= nw.SetTravelTime(station0.id, station1.id, 1);
+    ok &= nw.SetTravelTime(station1.id, station2.id, 2);
+    ok &= nw.SetTravelTime(station1.id, station3.id, 4);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station0.id, station2.id), 1 + 2);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station0.id, station3.id),
+                      1 + 2 + 2 + 4);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station2.id, station3.id), 2 + 4);
+
+    // Lower and raise travel times: the cumulative times follow.
+    ok = nw.SetTravelTime(station1.id, station2.id, 1);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station0.id, station3.id),
+                      1 + 1 + 1 + 4);
+    ok = nw.SetTravelTime(station0.id, station1.id, 10);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station0.id, station3.id),
+                      10 + 1 + 1 + 4);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station1.id, station3.id), 1 + 1 + 4);
+
+    // Stations must appear in order along the route.
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station3.id, station0.id), 0);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(line.id, route0.id, station2.id, station2.id), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // TravelTime
+
+BOOST_AUTO_TEST_SUITE(Copy);
+
+BOOST_AUTO_TEST_CASE(independent)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    // route0: 0 ---> 1
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route0},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_REQUIRE(ok);
+    ok = nw.SetTravelTime(station0.id, station1.id, 1);
+    BOOST_REQUIRE(ok);
+
+    // Changes to a copy are not visible in the original, and vice versa.
+    TransportNetwork copy{nw};
+    ok = copy.SetTravelTime(station0.id, station1.id, 2);
+    BOOST_REQUIRE(ok);
+    ok = copy.RecordPassengerEvent({station0.id, PassengerEvent::Type::In});
+    BOOST_REQUIRE(ok);
+    ok = nw.RecordPassengerEvent({station1.id, PassengerEvent::Type::In});
+    BOOST_REQUIRE(ok);
+
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(station0.id, station1.id), 1);
+    BOOST_CHECK_EQUAL(copy.GetTravelTime(station0.id, station1.id), 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station0.id), 0);
+    BOOST_CHECK_EQUAL(copy.GetPassengerCount(station0.id), 1);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1.id), 1);
+    BOOST_CHECK_EQUAL(copy.GetPassengerCount(station1.id), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Copy
+
+BOOST_AUTO_TEST_SUITE(FastestPath);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    // Add two lines. The fastest path from 0 to 3 changes from route0 to route1 at 1.
+    // route0: 0 ---> 1 ---> 2 ---> 3
+    // route1: 4 ---> 1 ---> 3
+    // route2: 3 ---> 4
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    Station station2{
+        "station_002",
+        "Station Name 2",
+    };
+    Station station3{
+        "station_003",
+        "Station Name 3",
+    };
+    Station station4{
+        "station_004",
+        "Station Name 4",
+    };
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_003"},
+    };
+    Route route1{
+        "route_001",
+        "Route Name 1",
+        "line_001",
+        "station_004",
+        "station_003",
+        {"station_004", "station_001", "station_003"},
+    };
+    Route route2{
+        "route_002",
+        "Route Name 2",
+        "line_001",
+        "station_003",
+        "station_004",
+        {"station_003", "station_004"},
+    };
+    Line line0{
+        "line_000",
+        "Line Name 0",
+        {route0},
+    };
+    Line line1{
+        "line_001",
+        "Line Name 1",
+        {route1, route2},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    ok &= nw.AddStation(station3);
+    ok &= nw.AddStation(station4);
+    BOOST_REQUIRE(ok);
+    ok = true;
+    ok &= nw.AddLine(line0);
+    ok &= nw.AddLine(line1);
+    BOOST_REQUIRE(ok);
+    ok = true;
+    ok &= nw.SetTravelTime(station0.id, station1.id, 1);
+    ok &= nw.SetTravelTime(station1.id, station2.id, 5);
+    ok &= nw.SetTravelTime(station2.id, station3.id, 5);
+    ok &= nw.SetTravelTime(station4.id, station1.id, 1);
+    ok &= nw.SetTravelTime(station1.id, station3.id, 3);
+    ok &= nw.SetTravelTime(station3.id, station4.id, 2);
+    BOOST_REQUIRE(ok);
+
+    auto path{nw.GetFastestPath(station0.id, station3.id)};
+    BOOST_REQUIRE_EQUAL(path.steps.size(), 3);
+    BOOST_CHECK_EQUAL(path.travelTime, 1 + 3);
+    BOOST_CHECK(!path.steps[0].route.IsValid());
+    BOOST_CHECK_EQUAL(nw.GetId(path.steps[0].station), station0.id);
+    BOOST_CHECK_EQUAL(nw.GetId(path.steps[1].route), route0.id);
+    BOOST_CHECK_EQUAL(nw.GetId(path.steps[1].station), station1.id);
+    BOOST_CHECK_EQUAL(nw.GetId(path.steps[2].route), route1.id);
+    BOOST_CHECK_EQUAL(nw.GetId(path.steps[2].station), station3.id);
+
+    // Routes are directed: 0 can't be reached from anywhere.
+    path = nw.GetFastestPath(station3.id, station0.id);
+    BOOST_CHECK(path.steps.empty());
+
+    // Same station.
+    path = nw.GetFastestPath(station2.id, station2.id);
+    BOOST_REQUIRE_EQUAL(path.steps.size(), 1);
+    BOOST_CHECK_EQUAL(path.travelTime, 0);
+
+    // Unknown station.
+    path = nw.GetFastestPath(station0.id, "station_42");
+    BOOST_CHECK(path.steps.empty());
+
+    // Caller-owned buffers give the same results and can be reused.
+    NetworkMonitor::PathSearchState state{};
+    NetworkMonitor::Path reused{};
+    const auto handle0{nw.GetStationHandle(station0.id)};
+    const auto handle3{nw.GetStationHandle(station3.id)};
+    const auto handle4{nw.GetStationHandle(station4.id)};
+    ok = nw.GetFastestPath(handle0, handle3, state, reused);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(reused.travelTime, 1 + 3);
+    ok = nw.GetFastestPath(handle0, handle4, state, reused);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(reused.steps.size(), 4);
+    BOOST_CHECK_EQUAL(reused.travelTime, 1 + 3 + 2);
+    ok = nw.GetFastestPath(handle3, handle0, state, reused);
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(reused.steps.empty());
+}
+
+BOOST_AUTO_TEST_CASE(alternatives)
+{
+    TransportNetwork nw{};
+    bool ok{true};
+
+    // Each edge is its own route; 0 -> 1 is served by two routes.
+    //   0 -1-> 1 -1-> 2 -1-> 3
+    //   0 -3-> 2
+    //   1 -4-> 3
+    for (int idx{0}; idx < 4; ++idx)
+    {
+        ok &= nw.AddStation(Station{
+            "station_00" + std::to_string(idx),
+            "Station Name " + std::to_string(idx),
+        });
+    }
+    const std::vector<std::tuple<int, int, unsigned int>> edges{
+        {0, 1, 1}, {1, 2, 1}, {2, 3, 1}, {0, 2, 3}, {1, 3, 4}, {0, 1, 1},
+    };
+    Line line{"line_000", "Line Name", {}};
+    for (std::size_t idx{0}; idx < edges.size(); ++idx)
+    {
+        const auto from{"station_00" + std::to_string(std::get<0>(edges[idx]))};
+        const auto to{"station_00" + std::to_string(std::get<1>(edges[idx]))};
+        line.routes.push_back(Route{
+            "route_00" + std::to_string(idx),
+            "Route Name " + std::to_string(idx),
+            line.id,
+            from,
+            to,
+            {from, to},
+        });
+    }
+    ok &= nw.AddLine(line);
+    for (std::size_t idx{0}; idx < edges.size(); ++idx)
+    {
+        const auto route{nw.GetRouteHandle(line.id, line.routes[idx].id)};
+        const auto from{nw.GetStationHandle(line.routes[idx].stops[0])};
+        const auto to{nw.GetStationHandle(line.routes[idx].stops[1])};
+        BOOST_REQUIRE(route.IsValid());
+        ok &= nw.SetTravelTime(from, to, std::get<2>(edges[idx]));
+    }
+    BOOST_REQUIRE(ok);
+
+    // 0-1-2-3 (3), 0-2-3 (4), 0-1-3 (5). The second 0 -> 1 route does not make the
+    // station sequences any different, so it gives no extra path.
+    auto paths{nw.GetAlternativePaths("station_000", "station_003", 5)};
+    BOOST_REQUIRE_EQUAL(paths.size(), 3);
+    const std::vector<std::vector<std::string>> expected{
+        {"station_000", "station_001", "station_002", "station_003"},
+        {"station_000", "station_002", "station_003"},
+        {"station_000", "station_001", "station_003"},
+    };
+    const std::vector<unsigned int> expectedTimes{3, 4, 5};
+    for (std::size_t idx{0}; idx < paths.size(); ++idx)
+    {
+        BOOST_CHECK_EQUAL(paths[idx].travelTime, expectedTimes[idx]);
+        BOOST_REQUIRE_EQUAL(paths[idx].steps.size(), expected[idx].size());
+        for (std::size_t step{0}; step < expected[idx].size(); ++step)
+        {
+            BOOST_CHECK_EQUAL(nw.GetId(paths[idx].steps[step].station), expected[idx][step]);
+        }
+    }
+    BOOST_CHECK(paths[0].steps[1].route == nw.GetRouteHandle(line.id, "route_000") ||
+                paths[0].steps[1].route == nw.GetRouteHandle(line.id, "route_005"));
+
+    // The first alternative is the fastest path.
+    const auto fastest{nw.GetFastestPath("station_000", "station_003")};
+    BOOST_CHECK_EQUAL(fastest.travelTime, paths[0].travelTime);
+    BOOST_CHECK_EQUAL(fastest.steps.size(), paths[0].steps.size());
+
+    // Fewer paths when asked, none when unreachable.
+    BOOST_CHECK_EQUAL(nw.GetAlternativePaths("station_000", "station_003", 2).size(), 2);
+    BOOST_CHECK(nw.GetAlternativePaths("station_000", "station_003", 0).empty());
+    BOOST_CHECK(nw.GetAlternativePaths("station_003", "station_000", 3).empty());
+    BOOST_CHECK(nw.GetAlternativePaths("station_000", "station_042", 3).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // FastestPath
+
+BOOST_AUTO_TEST_SUITE(JourneyOptions);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    // route0 (line0): 0 ---> 1 ---> 2 ---> 3
+    // route1 (line1): 0 ---> 4
+    // route2 (line1): 4 ---> 3
+    std::vector<Station> stations{};
+    for (int idx{0}; idx < 5; ++idx)
+    {
+        stations.push_back(Station{
+            "station_00" + std::to_string(idx),
+            "Station Name " + std::to_string(idx),
+        });
+    }
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_003"},
+    };
+    Route route1{
+        "route_001",
+        "Route Name 1",
+        "line_001",
+        "station_000",
+        "station_004",
+        {"station_000", "station_004"},
+    };
+    Route route2{
+        "route_002",
+        "Route Name 2",
+        "line_001",
+        "station_004",
+        "station_003",
+        {"station_004", "station_003"},
+    };
+    Line line0{
+        "line_000",
+        "Line Name 0",
+        {route0},
+    };
+    Line line1{
+        "line_001",
+        "Line Name 1",
+        {route1, route2},
+    };
+    ok = true;
+    for (const auto& station : stations)
+    {
+        ok &= nw.AddStation(station);
+    }
+    ok &= nw.AddLine(line0);
+    ok &= nw.AddLine(line1);
+    ok &= nw.SetTravelTime("station_000", "station_001", 5);
+    ok &= nw.SetTravelTime("station_001", "station_002", 5);
+    ok &= nw.SetTravelTime("station_002", "station_003", 5);
+    ok &= nw.SetTravelTime("station_000", "station_004", 2);
+    ok &= nw.SetTravelTime("station_004", "station_003", 3);
+    BOOST_REQUIRE(ok);
+
+    // Without a penalty, changing is faster.
+    auto journeys{nw.GetJourneyOptions("station_000", "station_003")};
+    BOOST_REQUIRE_EQUAL(journeys.size(), 2);
+    BOOST_CHECK_EQUAL(journeys[0].transfers, 0);
+    BOOST_CHECK_EQUAL(journeys[0].path.travelTime, 15);
+    BOOST_REQUIRE_EQUAL(journeys[0].path.steps.size(), 4);
+    BOOST_CHECK_EQUAL(nw.GetId(journeys[0].path.steps[0].station), "station_000");
+    BOOST_CHECK(!journeys[0].path.steps[0].route.IsValid());
+    for (std::size_t idx{1}; idx < 4; ++idx)
+    {
+        const auto& step{journeys[0].path.steps[idx]};
+        BOOST_CHECK_EQUAL(nw.GetId(step.station), stations[idx].id);
+        BOOST_CHECK(step.route == nw.GetRouteHandle(line0.id, route0.id));
+    }
+    BOOST_CHECK_EQUAL(journeys[1].transfers, 1);
+    BOOST_CHECK_EQUAL(journeys[1].path.travelTime, 5);
+    BOOST_REQUIRE_EQUAL(journeys[1].path.steps.size(), 3);
+    BOOST_CHECK_EQUAL(nw.GetId(journeys[1].path.steps[1].station), "station_004");
+    BOOST_CHECK(journeys[1].path.steps[1].route == nw.GetRouteHandle(line1.id, route1.id));
+    BOOST_CHECK_EQUAL(nw.GetId(journeys[1].path.steps[2].station), "station_003");
+    BOOST_CHECK(journeys[1].path.steps[2].route == nw.GetRouteHandle(line1.id, route2.id));
+
+    // The penalty is added to the travel time of the journey that changes.
+    JourneyPlannerOptions options{};
+    options.interchangePenalty = 5;
+    journeys = nw.GetJourneyOptions("station_000", "station_003", options);
+    BOOST_REQUIRE_EQUAL(journeys.size(), 2);
+    BOOST_CHECK_EQUAL(journeys[1].path.travelTime, 10);
+
+    // A large penalty makes the direct journey dominate.
+    options.interchangePenalty = 20;
+    journeys = nw.GetJourneyOptions("station_000", "station_003", options);
+    BOOST_REQUIRE_EQUAL(journeys.size(), 1);
+    BOOST_CHECK_EQUAL(journeys[0].transfers, 0);
+
+    // Changes can be forbidden.
+    options.interchangePenalty = 0;
+    options.maxTransfers = 0;
+    journeys = nw.GetJourneyOptions("station_000", "station_003", options);
+    BOOST_REQUIRE_EQUAL(journeys.size(), 1);
+    BOOST_CHECK_EQUAL(journeys[0].path.travelTime, 15);
+
+    // Unreachable, trivial and unknown journeys.
+    BOOST_CHECK(nw.GetJourneyOptions("station_003", "station_000").empty());
+    journeys = nw.GetJourneyOptions("station_002", "station_002");
+    BOOST_REQUIRE_EQUAL(journeys.size(), 1);
+    BOOST_CHECK_EQUAL(journeys[0].path.travelTime, 0);
+    BOOST_CHECK_EQUAL(journeys[0].path.steps.size(), 1);
+    BOOST_CHECK(nw.GetJourneyOptions("station_000", "station_042").empty());
+}
+
+BOOST_AUTO_TEST_CASE(search_state)
+{
+    // One route through many stations.
+    constexpr std::size_t kStations{5000};
+    TransportNetwork large{};
+    Route longRoute{"route_000", "", "line_000", "station_0", "", {}};
+    for (std::size_t idx{0}; idx < kStations; ++idx)
+    {
+        longRoute.stops.push_back("station_" + std::to_string(idx));
+        BOOST_REQUIRE(large.AddStation(Station{longRoute.stops.back(), ""}));
+    }
+    longRoute.endStationId = longRoute.stops.back();
+    BOOST_REQUIRE(large.AddLine(Line{"line_000", "", {longRoute}}));
+    for (std::size_t idx{1}; idx < kStations; ++idx)
+    {
+        BOOST_REQUIRE(large.SetTravelTime(longRoute.stops[idx - 1], longRoute.stops[idx], 1));
+    }
+
+    TransportNetwork small{};
+    BOOST_REQUIRE(small.AddStation(Station{"station_000", "Station Name 0"}));
+    BOOST_REQUIRE(small.AddStation(Station{"station_001", "Station Name 1"}));
+    Route route{"route_000", "", "line_000", "station_000", "station_001",
+                {"station_000", "station_001"}};
+    BOOST_REQUIRE(small.AddLine(Line{"line_000", "", {route}}));
+    BOOST_REQUIRE(small.SetTravelTime("station_000", "station_001", 3));
+
+    // Caller-owned buffers give the same journeys as the per-thread ones.
+    NetworkMonitor::JourneySearchState state{};
+    const auto source{large.GetStationHandle("station_0")};
+    const auto target{large.GetStationHandle("station_4999")};
+    const auto journeys{large.GetJourneyOptions(source, target, {}, state)};
+    const auto expected{large.GetJourneyOptions(source, target)};
+    BOOST_REQUIRE_EQUAL(journeys.size(), expected.size());
+    for (std::size_t idx{0}; idx < journeys.size(); ++idx)
+    {
+        BOOST_CHECK_EQUAL(journeys[idx].path.travelTime, expected[idx].path.travelTime);
+        BOOST_CHECK_EQUAL(journeys[idx].transfers, expected[idx].transfers);
+    }
+    const auto largeUsage{state.GetMemoryUsage()};
+    BOOST_CHECK_EQUAL(journeys[0].path.travelTime, kStations - 1);
+    BOOST_CHECK_GE(largeUsage, kStations * sizeof(std::uint32_t));
+
+    // The per-thread buffers show up in the memory stats.
+    BOOST_CHECK_GE(large.GetMemoryStats().searchBuffers, largeUsage);
+
+    // Buffers sized for a much larger network are released.
+    auto options{JourneyPlannerOptions{}};
+    options.maxTransfers = 0;
+    const auto smallJourneys{small.GetJourneyOptions(small.GetStationHandle("station_000"),
+                                                     small.GetStationHandle("station_001"),
+                                                     options,
+                                                     state)};
+    BOOST_REQUIRE_EQUAL(smallJourneys.size(), 1);
+    BOOST_CHECK_EQUAL(smallJourneys[0].path.travelTime, 3);
+    BOOST_CHECK_LT(state.GetMemoryUsage(), largeUsage);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // JourneyOptions
+
+BOOST_AUTO_TEST_SUITE(FromJson);
+
+// The layout sets some station pairs more than once, in either direction: the last
+// travel time set for a pair wins.
+static std::map<std::pair<Id, Id>, unsigned int> ExpectedTravelTimes(const nlohmann::json& layout)
+{
+    std::map<std::pair<Id, Id>, unsigned int> travelTimes{};
+    for (const auto& travelTimeJson : layout["travel_times"])
+    {
+        Id stationA{travelTimeJson["start_station_id"]};
+        Id stationB{travelTimeJson["end_station_id"]};
+        if (stationB < stationA)
+        {
+            std::swap(stationA, stationB);
+        }
+        travelTimes[{stationA, stationB}] = travelTimeJson["travel_time"];
+    }
+    return travelTimes;
+}
+
+BOOST_AUTO_TEST_CASE(layout_file)
+{
+    std::ifstream file{TESTS_NETWORK_LAYOUT_JSON};
+    BOOST_REQUIRE(file);
+    auto layout = nlohmann::json::parse(file);
+
+    // Braces would wrap the document in a JSON array: copy with '=' instead.
+    auto document = layout;
+    TransportNetwork nw{};
+    BOOST_REQUIRE(nw.FromJson(std::move(document)));
+
+    for (const auto& stationJson : layout["stations"])
+    {
+        BOOST_CHECK(nw.GetStationHandle(stationJson.at("station_id").get<std::string>()).IsValid());
+    }
+    for (const auto& lineJson : layout["lines"])
+    {
+        for (const auto& routeJson : lineJson["routes"])
+        {
+            BOOST_CHECK(nw.GetRouteHandle(lineJson["line_id"], routeJson["route_id"]).IsValid());
+        }
+    }
+    for (const auto& [stations, travelTime] : ExpectedTravelTimes(layout))
+    {
+        BOOST_CHECK_EQUAL(nw.GetTravelTime(stations.first, stations.second), travelTime);
+    }
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_000").size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(layout_stream)
+{
+    std::ifstream file{TESTS_NETWORK_LAYOUT_JSON};
+    BOOST_REQUIRE(file);
+    auto layout = nlohmann::json::parse(file);
+    auto document = layout;
+    TransportNetwork fromDocument{};
+    BOOST_REQUIRE(fromDocument.FromJson(std::move(document)));
+
+    file.clear();
+    file.seekg(0);
+    TransportNetwork fromStream{};
+    BOOST_REQUIRE(fromStream.FromJson(file));
+
+    // Both loaders give the same network.
+    for (const auto& stationJson : layout["stations"])
+    {
+        const auto& id{stationJson["station_id"].get_ref<const std::string&>()};
+        BOOST_REQUIRE(fromStream.GetStationHandle(id).IsValid());
+        BOOST_CHECK(fromStream.GetStationHandle(id) == fromDocument.GetStationHandle(id));
+        auto routes{fromStream.GetRoutesServingStation(id)};
+        auto expected{fromDocument.GetRoutesServingStation(id)};
+        std::sort(routes.begin(), routes.end());
+        std::sort(expected.begin(), expected.end());
+        BOOST_CHECK(routes == expected);
+    }
+    for (const auto& lineJson : layout["lines"])
+    {
+        for (const auto& routeJson : lineJson["routes"])
+        {
+            BOOST_CHECK(
+                fromStream.GetRouteHandle(lineJson["line_id"], routeJson["route_id"]).IsValid());
+        }
+    }
+    for (const auto& [stations, travelTime] : ExpectedTravelTimes(layout))
+    {
+        BOOST_CHECK_EQUAL(fromStream.GetTravelTime(stations.first, stations.second), travelTime);
+    }
+    BOOST_CHECK_EQUAL(fromStream.GetFastestPath("station_000", "station_024").travelTime,
+                      fromDocument.GetFastestPath("station_000", "station_024").travelTime);
+}
+
+BOOST_AUTO_TEST_CASE(stream_any_order)
+{
+    // Travel times first, then lines, then stations; unknown fields are skipped.
+    std::istringstream layout{R"({
+        "travel_times": [
+            {"start_station_id": "station_000", "end_station_id": "station_001",
+             "line_id": "line_000", "route_id": "route_000", "travel_time": 3}
+        ],
+        "lines": [
+            {"line_id": "line_000", "name": "Line Name", "colour": [1, 2, 3],
+             "routes": [
+                {"line_id": "line_000", "route_id": "route_000", "direction": "inbound",
+                 "start_station_id": "station_000", "end_station_id": "station_001",
+                 "route_stops": ["station_000", "station_001"]}
+             ]}
+        ],
+        "stations": [
+            {"station_id": "station_000", "name": "Station Name 0", "zone": {"id": 1}},
+            {"station_id": "station_001", "name": "Station Name 1"}
+        ]
+    })"};
+    TransportNetwork nw{};
+    BOOST_REQUIRE(nw.FromJson(layout));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_000", "station_001"), 3);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_001").size(), 1);
+
+    // Malformed documents are rejected.
+    std::istringstream malformed{R"({"stations": [{"station_id": "station_000",)"};
+    TransportNetwork other{};
+    BOOST_CHECK(!other.FromJson(malformed));
+
+    // So are lines with unknown stations.
+    std::istringstream unknownStation{R"({
+        "stations": [],
+        "lines": [{"line_id": "line_000", "name": "Line Name", "routes": [
+            {"line_id": "line_000", "route_id": "route_000",
+             "start_station_id": "station_000", "end_station_id": "station_001",
+             "route_stops": ["station_000", "station_001"]}]}]
+    })"};
+    BOOST_CHECK_THROW(other.FromJson(unknownStation), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // FromJson
+
+BOOST_AUTO_TEST_SUITE(Snapshot);
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    const std::filesystem::path layout{TESTS_NETWORK_LAYOUT_JSON};
+    const auto snapshot{std::filesystem::temp_directory_path() / "nm-round-trip.snapshot"};
+    std::filesystem::remove(snapshot);
+
+    std::ifstream file{layout};
+    TransportNetwork original{};
+    BOOST_REQUIRE(original.FromJson(file));
+    BOOST_REQUIRE(original.SaveSnapshot(snapshot, layout));
+
+    TransportNetwork loaded{};
+    BOOST_REQUIRE(loaded.LoadSnapshot(snapshot, layout));
+    BOOST_CHECK_EQUAL(loaded.GetRevision(), original.GetRevision());
+
+    file.clear();
+    file.seekg(0);
+    auto json = nlohmann::json::parse(file);
+    for (const auto& stationJson : json["stations"])
+    {
+        const auto& id{stationJson["station_id"].get_ref<const std::string&>()};
+        BOOST_REQUIRE(loaded.GetStationHandle(id) == original.GetStationHandle(id));
+        BOOST_CHECK(loaded.GetRoutesServingStation(id) == original.GetRoutesServingStation(id));
+        BOOST_CHECK_EQUAL(loaded.GetPassengerCount(id), 0);
+    }
+    for (const auto& lineJson : json["lines"])
+    {
+        for (const auto& routeJson : lineJson["routes"])
+        {
+            const auto route{loaded.GetRouteHandle(lineJson["line_id"], routeJson["route_id"])};
+            BOOST_REQUIRE(route.IsValid());
+            BOOST_CHECK_EQUAL(loaded.GetId(route), routeJson["route_id"].get<std::string>());
+            const auto& stops{routeJson["route_stops"]};
+            BOOST_CHECK_EQUAL(
+                loaded.GetTravelTime(lineJson["line_id"], routeJson["route_id"], stops.front(),
+                                     stops.back()),
+                original.GetTravelTime(lineJson["line_id"], routeJson["route_id"], stops.front(),
+                                       stops.back()));
+        }
+    }
+    for (const auto& travelTimeJson : json["travel_times"])
+    {
+        BOOST_CHECK_EQUAL(
+            loaded.GetTravelTime(travelTimeJson.at("start_station_id").get<std::string>(),
+                                 travelTimeJson.at("end_station_id").get<std::string>()),
+            original.GetTravelTime(travelTimeJson.at("start_station_id").get<std::string>(),
+                                   travelTimeJson.at("end_station_id").get<std::string>()));
+    }
+    BOOST_CHECK_EQUAL(loaded.GetFastestPath("station_000", "station_100").travelTime,
+                      original.GetFastestPath("station_000", "station_100").travelTime);
+
+    // The loaded network is a regular network.
+    BOOST_CHECK(loaded.RecordPassengerEvent({"station_000", PassengerEvent::Type::In}));
+    BOOST_CHECK(loaded.SetTravelTime("station_000", "station_001", 42));
+    BOOST_CHECK_EQUAL(loaded.GetTravelTime("station_000", "station_001"), 42);
+
+    std::filesystem::remove(snapshot);
+}
+
+BOOST_AUTO_TEST_CASE(live_state)
+{
+    const auto snapshot{std::filesystem::temp_directory_path() / "nm-live-state.snapshot"};
+    std::filesystem::remove(snapshot);
+
+    // The snapshot numbers its stations differently from the network that loads it.
+    TransportNetwork saved{};
+    BOOST_REQUIRE(saved.AddStation(Station{"station_002", "Station Name 2"}));
+    BOOST_REQUIRE(saved.AddStation(Station{"station_000", "Station Name 0"}));
+    BOOST_REQUIRE(saved.SaveSnapshot(snapshot));
+
+    using EventType = PassengerEvent::Type;
+    const std::chrono::system_clock::time_point midnight{std::chrono::hours{24 * 20000}};
+    const auto day{midnight + std::chrono::hours{24}};
+    TransportNetwork nw{};
+    BOOST_REQUIRE(nw.AddStation(Station{"station_000", "Station Name 0"}));
+    BOOST_REQUIRE(nw.AddStation(Station{"station_001", "Station Name 1"}));
+    nw.EnablePassengerStatistics(PassengerStatisticsOptions{60, 0});
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_000", EventType::In, midnight}));
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_000", EventType::In, midnight}));
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_001", EventType::In, midnight}));
+
+    BOOST_REQUIRE(nw.LoadSnapshot(snapshot));
+    const auto station0{nw.GetStationHandle("station_000")};
+    const auto station2{nw.GetStationHandle("station_002")};
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station0), 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station2), 0);
+    BOOST_CHECK(!nw.GetStationHandle("station_001").IsValid());
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station0, midnight, day).in, 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station2, midnight, day).in, 0);
+    BOOST_CHECK(nw.GetBusiestStations(1)[0].station == station0);
+
+    // Statistics stay enabled, with the same options.
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_002", EventType::Out, midnight}));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station2, midnight, day).out, 1);
+    BOOST_CHECK_EQUAL(nw.GetMemoryStats().passengerStatistics, 2 * 60 * sizeof(std::uint64_t));
+
+    std::filesystem::remove(snapshot);
+}
+
+BOOST_AUTO_TEST_CASE(rejected)
+{
+    const std::filesystem::path layout{TESTS_NETWORK_LAYOUT_JSON};
+    const auto snapshot{std::filesystem::temp_directory_path() / "nm-rejected.snapshot"};
+    std::filesystem::remove(snapshot);
+
+    TransportNetwork nw{};
+    BOOST_REQUIRE(nw.AddStation(Station{"station_000", "Station Name 0"}));
+    BOOST_CHECK(!nw.LoadSnapshot(snapshot));
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshot));
+    BOOST_CHECK(nw.LoadSnapshot(snapshot));
+
+    // A snapshot that was not taken from the layout is stale.
+    BOOST_CHECK(!nw.LoadSnapshot(snapshot, layout));
+
+    // Corrupt a byte of the payload: the checksum fails and the network is untouched.
+    {
+        std::fstream file{snapshot, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(-1, std::ios::end);
+        file.put('#');
+    }
+    TransportNetwork other{};
+    BOOST_REQUIRE(other.AddStation(Station{"station_042", "Station Name 42"}));
+    BOOST_CHECK(!other.LoadSnapshot(snapshot));
+    BOOST_CHECK(other.GetStationHandle("station_042").IsValid());
+    BOOST_CHECK(!other.GetStationHandle("station_000").IsValid());
+
+    std::filesystem::remove(snapshot);
+}
+
+BOOST_AUTO_TEST_CASE(load_layout)
+{
+    const auto directory{std::filesystem::temp_directory_path()};
+    const auto layout{directory / "nm-load-layout.json"};
+    const auto snapshot{directory / "nm-load-layout.snapshot"};
+    std::filesystem::remove(snapshot);
+    std::filesystem::copy_file(TESTS_NETWORK_LAYOUT_JSON,
+                               layout,
+                               std::filesystem::copy_options::overwrite_existing);
+
+    // No snapshot yet: the layout is parsed and a snapshot is written.
+    TransportNetwork first{};
+    BOOST_REQUIRE(first.LoadLayout(layout, snapshot));
+    BOOST_REQUIRE(std::filesystem::exists(snapshot));
+    TransportNetwork fromSnapshot{};
+    BOOST_CHECK(fromSnapshot.LoadSnapshot(snapshot, layout));
+
+    // A newer layout makes the snapshot stale: it is rebuilt.
+    std::filesystem::last_write_time(layout,
+                                     std::filesystem::last_write_time(layout) +
+                                         std::chrono::seconds{10});
+    BOOST_CHECK(!fromSnapshot.LoadSnapshot(snapshot, layout));
+    TransportNetwork second{};
+    BOOST_REQUIRE(second.LoadLayout(layout, snapshot));
+    BOOST_CHECK(fromSnapshot.LoadSnapshot(snapshot, layout));
+    BOOST_CHECK_EQUAL(second.GetFastestPath("station_000", "station_100").travelTime,
+                      first.GetFastestPath("station_000", "station_100").travelTime);
+
+    // Missing layout and snapshot.
+    TransportNetwork missing{};
+    BOOST_CHECK(!missing.LoadLayout(directory / "nm-missing.json", directory / "nm-missing"));
+
+    std::filesystem::remove(snapshot);
+    std::filesystem::remove(layout);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Snapshot
+
+BOOST_AUTO_TEST_SUITE(LayoutDiff);
+
+static TransportNetwork MakeDiffNetwork()
+{
+    // line0, route0: 0 -1-> 1 -2-> 2
+    TransportNetwork nw{};
+    bool ok{true};
+    for (int idx{0}; idx < 3; ++idx)
+    {
+        ok &= nw.AddStation(Station{
+            "station_00" + std::to_string(idx),
+            "Station Name " + std::to_string(idx),
+        });
+    }
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    ok &= nw.AddLine(Line{"line_000", "Line Name 0", {route0}});
+    ok &= nw.SetTravelTime("station_000", "station_001", 1);
+    ok &= nw.SetTravelTime("station_001", "station_002", 2);
+    BOOST_REQUIRE(ok);
+    return nw;
+}
+
+BOOST_AUTO_TEST_CASE(routes_and_stations)
+{
+    auto nw{MakeDiffNetwork()};
+    const auto station1{nw.GetStationHandle("station_001")};
+    const auto route0{nw.GetRouteHandle("line_000", "route_000")};
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station1, PassengerEvent::Type::In));
+    const auto revision{nw.GetRevision()};
+
+    // Reroute route0 to a new station 3 and add a route back from 3 to 0.
+    NetworkMonitor::LayoutDiff diff{};
+    diff.addedStations.push_back(Station{"station_003", "Station Name 3"});
+    diff.modifiedRoutes.push_back(Route{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_003"},
+    });
+    diff.addedRoutes.push_back(Route{
+        "route_001",
+        "Route Name 1",
+        "line_000",
+        "station_003",
+        "station_000",
+        {"station_003", "station_000"},
+    });
+    diff.travelTimes.push_back({"station_001", "station_003", 5});
+    diff.travelTimes.push_back({"station_003", "station_000", 7});
+    BOOST_REQUIRE(nw.ApplyLayoutDiff(diff));
+    BOOST_CHECK_GT(nw.GetRevision(), revision);
+
+    // Handles and passenger counts are kept; travel times of unchanged pairs too.
+    BOOST_CHECK(nw.GetStationHandle("station_001") == station1);
+    BOOST_CHECK(nw.GetRouteHandle("line_000", "route_000") == route0);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_000", "route_000", "station_000", "station_001"),
+                      1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_000", "route_000", "station_000", "station_003"),
+                      1 + 5);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_000", "route_001", "station_003", "station_000"),
+                      7);
+
+    // Station 2 is not served any more: no edges lead there.
+    BOOST_CHECK(nw.GetRoutesServingStation("station_002").empty());
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_001", "station_002"), 0);
+    BOOST_CHECK_EQUAL(nw.GetFastestPath("station_000", "station_003").travelTime, 6);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_000").size(), 2);
+
+    // Now it can go, and its handle goes invalid.
+    const auto station2{nw.GetStationHandle("station_002")};
+    NetworkMonitor::LayoutDiff removal{};
+    removal.removedStations.push_back("station_002");
+    BOOST_REQUIRE(nw.ApplyLayoutDiff(removal));
+    BOOST_CHECK(!nw.GetStationHandle("station_002").IsValid());
+    BOOST_CHECK_THROW(nw.GetPassengerCount(station2), std::runtime_error);
+    BOOST_CHECK(!nw.RecordPassengerEvent({"station_002", PassengerEvent::Type::In}));
+
+    // Adding it back revives its old handle.
+    BOOST_REQUIRE(nw.AddStation(Station{"station_002", "Station Name 2"}));
+    BOOST_CHECK(nw.GetStationHandle("station_002") == station2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station2), 0);
+}
+
+BOOST_AUTO_TEST_CASE(remove_lines)
+{
+    auto nw{MakeDiffNetwork()};
+    const auto station0{nw.GetStationHandle("station_000")};
+
+    NetworkMonitor::LayoutDiff diff{};
+    diff.removedLines.push_back("line_000");
+    diff.removedStations.push_back("station_002");
+    diff.addedLines.push_back(Line{
+        "line_001",
+        "Line Name 1",
+        {Route{
+            "route_000",
+            "Route Name 0",
+            "line_001",
+            "station_001",
+            "station_000",
+            {"station_001", "station_000"},
+        }},
+    });
+    BOOST_REQUIRE(nw.ApplyLayoutDiff(diff));
+    BOOST_CHECK(!nw.GetLineHandle("line_000").IsValid());
+    BOOST_CHECK(!nw.GetRouteHandle("line_000", "route_000").IsValid());
+    BOOST_CHECK(!nw.GetStationHandle("station_002").IsValid());
+    BOOST_CHECK(nw.GetStationHandle("station_000") == station0);
+
+    // The new route inherits the travel time of the pair it serves.
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_001", "route_000", "station_001", "station_000"),
+                      1);
+    BOOST_CHECK_EQUAL(nw.GetFastestPath("station_001", "station_000").travelTime, 1);
+    BOOST_CHECK(nw.GetFastestPath("station_000", "station_001").steps.empty());
+
+    // Snapshots keep tombstones.
+    const auto snapshot{std::filesystem::temp_directory_path() / "nm-diff.snapshot"};
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshot));
+    TransportNetwork loaded{};
+    BOOST_REQUIRE(loaded.LoadSnapshot(snapshot));
+    BOOST_CHECK(!loaded.GetStationHandle("station_002").IsValid());
+    BOOST_CHECK(!loaded.GetLineHandle("line_000").IsValid());
+    BOOST_CHECK(loaded.GetRouteHandle("line_001", "route_000") ==
+                nw.GetRouteHandle("line_001", "route_000"));
+    std::filesystem::remove(snapshot);
+}
+
+BOOST_AUTO_TEST_CASE(shared_stations)
+{
+    auto nw{MakeDiffNetwork()};
+
+    // route1 shares every station of route0. Rerouting route0 twice must leave the
+    // edges of route1 in the rows of those stations as they were.
+    Route route1{
+        "route_001",
+        "Route Name 1",
+        "line_001",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    BOOST_REQUIRE(nw.AddLine(Line{"line_001", "Line Name 1", {route1}}));
+    BOOST_REQUIRE(nw.SetTravelTime("station_000", "station_001", 1));
+    BOOST_REQUIRE(nw.SetTravelTime("station_001", "station_002", 4));
+    for (const auto& stops : {std::vector<Id>{"station_002", "station_001", "station_000"},
+                              std::vector<Id>{"station_000", "station_002"}})
+    {
+        NetworkMonitor::LayoutDiff diff{};
+        diff.modifiedRoutes.push_back(Route{
+            "route_000",
+            "Route Name 0",
+            "line_000",
+            stops.front(),
+            stops.back(),
+            stops,
+        });
+        BOOST_REQUIRE(nw.ApplyLayoutDiff(diff));
+        BOOST_CHECK_EQUAL(
+            nw.GetTravelTime("line_001", "route_001", "station_000", "station_002"), 1 + 4);
+    }
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+                      0);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_001").size(), 1);
+    BOOST_CHECK_EQUAL(nw.GetFastestPath("station_000", "station_002").travelTime, 0);
+}
+
+BOOST_AUTO_TEST_CASE(rejected)
+{
+    auto nw{MakeDiffNetwork()};
+    const auto revision{nw.GetRevision()};
+
+    // Each of these diffs is invalid as a whole and must leave the network untouched.
+    std::vector<NetworkMonitor::LayoutDiff> diffs(6);
+    // A station still served by a route.
+    diffs[0].addedStations.push_back(Station{"station_003", "Station Name 3"});
+    diffs[0].removedStations.push_back("station_002");
+    // A route stopping at a station that is removed by the same diff.
+    diffs[1].removedStations.push_back("station_002");
+    diffs[1].modifiedRoutes.push_back(Route{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_002"},
+    });
+    // An existing station.
+    diffs[2].addedStations.push_back(Station{"station_000", "Station Name 0"});
+    // An unknown route.
+    diffs[3].removedRoutes.push_back({"line_000", "route_042"});
+    // A new route on an unknown line.
+    diffs[4].addedRoutes.push_back(Route{
+        "route_001",
+        "Route Name 1",
+        "line_042",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    });
+    // A new route with the id of a route modified by the same diff.
+    const Route shortRoute{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    };
+    diffs[5].modifiedRoutes.push_back(shortRoute);
+    diffs[5].addedRoutes.push_back(shortRoute);
+    for (const auto& diff : diffs)
+    {
+        BOOST_CHECK(!nw.ApplyLayoutDiff(diff));
+    }
+    BOOST_CHECK_EQUAL(nw.GetRevision(), revision);
+    BOOST_CHECK(!nw.GetStationHandle("station_003").IsValid());
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+                      3);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // LayoutDiff
+
+BOOST_AUTO_TEST_SUITE(MemoryStats);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TransportNetwork nw{};
+    const auto empty{nw.GetMemoryStats()};
+
+    std::ifstream file{TESTS_NETWORK_LAYOUT_JSON};
+    BOOST_REQUIRE(nw.FromJson(file));
+    const auto stats{nw.GetMemoryStats()};
+    BOOST_CHECK_GT(stats.stations, empty.stations);
+    BOOST_CHECK_GT(stats.edges, empty.edges);
+    BOOST_CHECK_GT(stats.routes, empty.routes);
+    BOOST_CHECK_GT(stats.lines, empty.lines);
+    BOOST_CHECK_GT(stats.hashTables, empty.hashTables);
+    BOOST_CHECK_GT(stats.strings, empty.strings);
+    BOOST_CHECK_GT(stats.passengerCounters, 0);
+    BOOST_CHECK_EQUAL(stats.sharedPointerControlBlocks, 0);
+    BOOST_CHECK_EQUAL(stats.Total(),
+                      stats.stations + stats.edges + stats.routes + stats.lines +
+                          stats.hashTables + stats.strings + stats.passengerCounters +
+                          stats.passengerStatistics + stats.searchBuffers);
+
+    // At least the arrays themselves are accounted for.
+    BOOST_CHECK_GE(stats.edges, 534 * sizeof(std::uint32_t));
+    BOOST_CHECK_GE(stats.stations, 426 * sizeof(std::string));
+
+    // Long names land in the string figure.
+    BOOST_REQUIRE(nw.AddStation(Station{"station_999", std::string(1000, 'x')}));
+    BOOST_CHECK_GE(nw.GetMemoryStats().strings, stats.strings + 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // MemoryStats
+
+BOOST_AUTO_TEST_SUITE(MemoryResource);
+
+// Forwards to the default resource, keeping track of the bytes it hands out.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::size_t allocated{0};
+    std::size_t outstanding{0};
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        allocated += bytes;
+        outstanding += bytes;
+        return std::pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+    {
+        outstanding -= bytes;
+        std::pmr::get_default_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(graph_allocations)
+{
+    TransportNetwork reference{};
+    std::ifstream referenceFile{TESTS_NETWORK_LAYOUT_JSON};
+    BOOST_REQUIRE(reference.FromJson(referenceFile));
+    BOOST_CHECK(reference.GetMemoryResource() == std::pmr::get_default_resource());
+
+    CountingResource resource{};
+    {
+        TransportNetwork nw{&resource};
+        BOOST_CHECK(nw.GetMemoryResource() == &resource);
+        std::ifstream file{TESTS_NETWORK_LAYOUT_JSON};
+        BOOST_REQUIRE(nw.FromJson(file));
+
+        // The graph arrays and the lists they own are all on the resource.
+        const auto stats{nw.GetMemoryStats()};
+        BOOST_CHECK_GE(resource.outstanding, stats.stations + stats.edges + stats.routes);
+        BOOST_CHECK_EQUAL(nw.GetFastestPath("station_000", "station_024").travelTime,
+                          reference.GetFastestPath("station_000", "station_024").travelTime);
+
+        // Copies do not touch the resource.
+        const auto allocated{resource.allocated};
+        TransportNetwork copy{nw};
+        BOOST_CHECK(copy.GetMemoryResource() == std::pmr::get_default_resource());
+        BOOST_CHECK_EQUAL(resource.allocated, allocated);
+        BOOST_CHECK_EQUAL(copy.GetFastestPath("station_000", "station_024").travelTime,
+                          reference.GetFastestPath("station_000", "station_024").travelTime);
+
+        // A network assigned to one on the resource is copied onto it.
+        TransportNetwork assigned{&resource};
+        assigned = std::move(copy);
+        BOOST_CHECK(assigned.GetMemoryResource() == &resource);
+        BOOST_CHECK_GT(resource.allocated, allocated);
+        BOOST_CHECK_EQUAL(assigned.GetTravelTime("station_000", "station_024"),
+                          reference.GetTravelTime("station_000", "station_024"));
+    }
+    BOOST_CHECK_EQUAL(resource.outstanding, 0);
+}
+
+BOOST_AUTO_TEST_CASE(monotonic)
+{
+    CountingResource upstream{};
+    std::pmr::monotonic_buffer_resource arena{&upstream};
+    {
+        TransportNetwork nw{&arena};
+        std::ifstream file{TESTS_NETWORK_LAYOUT_JSON};
+        BOOST_REQUIRE(nw.FromJson(file));
+        BOOST_CHECK_GT(nw.GetFastestPath("station_000", "station_024").travelTime, 0);
+    }
+
+    // The arena keeps the memory until it is released, all at once.
+    BOOST_CHECK_GT(upstream.outstanding, 0);
+    arena.release();
+    BOOST_CHECK_EQUAL(upstream.outstanding, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // MemoryResource
+
+BOOST_AUTO_TEST_SUITE(Handles);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TransportNetwork nw{};
+    bool ok{false};
+
+    // Add a line with 1 route.
+    // route0: 0 ---> 1 ---> 2
+    Station station0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1{
+        "station_001",
+        "Station Name 1",
+    };
+    Station station2{
+        "station_002",
+        "Station Name 2",
+    };
+    Route route0{
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route0},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_REQUIRE(ok);
+
+    // Resolve the ids once.
+    const auto handle0{nw.GetStationHandle(station0.id)};
+    const auto handle1{nw.GetStationHandle(station1.id)};
+    const auto handle2{nw.GetStationHandle(station2.id)};
+    const auto lineHandle{nw.GetLineHandle(line.id)};
+    const auto routeHandle{nw.GetRouteHandle(line.id, route0.id)};
+    BOOST_REQUIRE(handle0.IsValid() && handle1.IsValid() && handle2.IsValid());
+    BOOST_REQUIRE(lineHandle.IsValid() && routeHandle.IsValid());
+    BOOST_CHECK(handle0 != handle1);
+    BOOST_CHECK(nw.GetStationHandle(station0.id) == handle0);
+    BOOST_CHECK_EQUAL(nw.GetId(handle1), station1.id);
+    BOOST_CHECK_EQUAL(nw.GetId(lineHandle), line.id);
+    BOOST_CHECK_EQUAL(nw.GetId(routeHandle), route0.id);
+
+    // Unknown ids resolve to invalid handles.
+    BOOST_CHECK(!nw.GetStationHandle("station_42").IsValid());
+    BOOST_CHECK(!nw.GetLineHandle("line_42").IsValid());
+    BOOST_CHECK(!nw.GetRouteHandle(line.id, "route_42").IsValid());
+    BOOST_CHECK(!nw.GetRouteHandle("line_42", route0.id).IsValid());
+
+    // Handle-based queries and mutations are visible through the id-based API.
+    using EventType = PassengerEvent::Type;
+    BOOST_CHECK(nw.RecordPassengerEvent(handle1, EventType::In));
+    BOOST_CHECK(nw.RecordPassengerEvent(handle1, EventType::In));
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1.id), 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(handle1), 2);
+    BOOST_CHECK(!nw.RecordPassengerEvent(NetworkMonitor::StationHandle{}, EventType::In));
+    BOOST_CHECK_THROW(nw.GetPassengerCount(NetworkMonitor::StationHandle{}), std::runtime_error);
+
+    BOOST_CHECK(nw.SetTravelTime(handle0, handle1, 3));
+    BOOST_CHECK(nw.SetTravelTime(handle1, handle2, 4));
+    BOOST_CHECK(!nw.SetTravelTime(handle0, handle2, 1));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(station0.id, station1.id), 3);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(handle1, handle0), 3);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(routeHandle, handle0, handle2), 3 + 4);
+
+    const auto routes{nw.GetRoutesServingStation(handle2)};
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK(routes[0] == routeHandle);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Handles
 
 BOOST_AUTO_TEST_SUITE_END(); // class_TransportNetwork
 